@@ -6,8 +6,12 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "Logging.h"
+#include "elevationProvider.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/wire_format_lite.cc"
 #include "google/protobuf/wire_format_lite.h"
@@ -39,6 +43,9 @@ static uint zoomMaxDetailedForCoastlines = 16;
 std::vector<BinaryMapFile*> openFiles;
 OsmAnd::OBF::OsmAndStoredIndex* cache = NULL;
 bool cacheHasChanged = false;
+// index of cache entries by file name (invalidated when cache is changed)
+static UNORDERED(map)<std::string, int> cacheFileIndexes;
+static bool cacheFileIndexesValid = false;
 static const int CACHE_VERSION = 5;// synchronize with CachedOsmandIndexes.java VERSION
 
 #ifdef MALLOC_H
@@ -50,7 +57,12 @@ void print_dump(const char* msg1, const char* msg2) {
 }
 #endif
 
+// Rules of routing index are shared by all contexts and searched by several threads
+// (chunked GPX approximation, chunked prepareResult), decoding rules are built lazily
+static std::mutex routeEncodingRulesMutex;
+
 uint32_t RoutingIndex::findOrCreateRouteType(const std::string& tag, const std::string& value) {
+	std::lock_guard<std::mutex> lock(routeEncodingRulesMutex);
 	uint32_t i = 0;
 	for (; i < routeEncodingRules.size(); i++) {
 		RouteTypeRule& rtr = routeEncodingRules[i];
@@ -60,10 +72,13 @@ uint32_t RoutingIndex::findOrCreateRouteType(const std::string& tag, const std::
 	}
 	RouteTypeRule rtr(tag, value);
 	routeEncodingRules.push_back(rtr);
+	if (!decodingRules.empty()) {
+		decodingRules[tag + "#" + value] = i;
+	}
 	return i;
 }
 
-uint32_t RoutingIndex::searchRouteEncodingRule(const std::string& tag, const std::string& value) {
+void RoutingIndex::buildDecodingRules() {
 	if (decodingRules.empty()) {
 		for (uint32_t i = 1; i < routeEncodingRules.size(); i++) {
 			RouteTypeRule& rt = routeEncodingRules[i];
@@ -71,9 +86,19 @@ uint32_t RoutingIndex::searchRouteEncodingRule(const std::string& tag, const std
 			decodingRules[ks] = i;
 		}
 	}
-	string k = tag + "#" + value;
-	if (decodingRules.count(k) == 1) {
-		return decodingRules[k];
+}
+
+void RoutingIndex::initDecodingRules() {
+	std::lock_guard<std::mutex> lock(routeEncodingRulesMutex);
+	buildDecodingRules();
+}
+
+uint32_t RoutingIndex::searchRouteEncodingRule(const std::string& tag, const std::string& value) {
+	std::lock_guard<std::mutex> lock(routeEncodingRulesMutex);
+	buildDecodingRules();
+	auto it = decodingRules.find(tag + "#" + value);
+	if (it != decodingRules.end()) {
+		return it->second;
 	}
 	return -1;
 }
@@ -190,6 +215,22 @@ void RouteDataObject::processConditionalTags(const tm& time) {
 	}
 }
 
+bool RouteDataObject::hasConditionalTags() {
+	for (uint32_t t : types) {
+		if (region->quickGetEncodingRule(t).conditional()) {
+			return true;
+		}
+	}
+	for (auto& ptypes : pointTypes) {
+		for (uint32_t t : ptypes) {
+			if (region->quickGetEncodingRule(t).conditional()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 bool RouteDataObject::tunnel() {
 	auto sz = types.size();
 	for (int i = 0; i < sz; i++) {
@@ -277,7 +318,7 @@ std::vector<double> RouteDataObject::calculateHeightArray() {
 	string strStart = getValue("osmand_ele_start");
 
 	if (strStart == "") {
-		return heightDistanceArray;
+		return calculateProvidedHeightArray();
 	}
 	string strEnd = getValue("osmand_ele_end");
 	int startHeight = (int) atof(strStart.c_str());
@@ -340,6 +381,36 @@ std::vector<double> RouteDataObject::calculateHeightArray() {
 	return heightDistanceArray;
 }
 
+std::vector<double> RouteDataObject::calculateProvidedHeightArray() {
+	// heights are requested once from provider, road without data keeps empty array
+	// (road loaded before provider is set requests heights again)
+	if (heightsProvided || getPointsLength() == 0) {
+		return heightDistanceArray;
+	}
+	SHARED_PTR<ElevationProvider> provider = ElevationProvider::getInstance();
+	if (!provider) {
+		return heightDistanceArray;
+	}
+	heightsProvided = true;
+	vector<double> heights;
+	if (!provider->getHeights(pointsX, pointsY, heights) || heights.size() != getPointsLength()) {
+		return heightDistanceArray;
+	}
+	heightDistanceArray.resize(2 * getPointsLength(), 0);
+	double plon = get31LongitudeX(pointsX[0]);
+	double plat = get31LatitudeY(pointsY[0]);
+	heightDistanceArray[1] = heights[0];
+	for (uint k = 1; k < getPointsLength(); k++) {
+		double lon = get31LongitudeX(pointsX[k]);
+		double lat = get31LatitudeY(pointsY[k]);
+		heightDistanceArray[2 * k] = getDistance(plat, plon, lat, lon);
+		heightDistanceArray[2 * k + 1] = heights[k];
+		plat = lat;
+		plon = lon;
+	}
+	return heightDistanceArray;
+}
+
 string RouteDataObject::getHighway() {
 	auto sz = types.size();
 	for (int i = 0; i < sz; i++) {
@@ -1173,91 +1244,98 @@ void setSegments(CodedInputStream * input, HHRoutingContext * ctx, std::vector<i
 	input->PopLimit(oldLimit);
 }
 
-int loadNetworkSegmentPoint(CodedInputStream * input, HHRoutingContext * ctx, SHARED_PTR<HHRouteRegionPointsCtx> regCtx, HHRouteBlockSegments * block, int searchInd) {
-	if (block->sublist.size() > 0) {
-		for (auto * s : block->sublist) {
-			if (HHRoutingContext::checkId(searchInd, s)) {
-				return loadNetworkSegmentPoint(input, ctx, regCtx, s, searchInd);
-			}
-		}
-		return 0;
-	}
-	if (input->TotalBytesRead() != block->filePointer) {
-		input->Seek(block->filePointer);
-	}
-	int oldLimit = input->PushLimit(block->length);
+void readHHSegmentsDirectory(CodedInputStream * input, HHSegmentsBlockInfo info, std::vector<HHSegmentsBlockInfo> & blocks) {
+	int oldLimit = input->PushLimit(info.length);
+	bool leaf = false;
 	uint32_t tag;
-	int loaded = 0;
-	int ind = 0;
+	uint32_t size;
 	while (true) {
 		tag = input->ReadTag();
 		switch (WireFormatLite::GetTagFieldNumber(tag)) {
 			case 0:
 				input->PopLimit(oldLimit);
-				return loaded;
+				if (leaf) {
+					blocks.push_back(info);
+				}
+				return;
 			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kIdRangeLengthFieldNumber:
-				WireFormatLite::ReadPrimitive<int32_t, WireFormatLite::TYPE_INT32>(input, &block->idRangeLength);
+				WireFormatLite::ReadPrimitive<int32_t, WireFormatLite::TYPE_INT32>(input, &info.idRangeLength);
 				break;
 			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kIdRangeStartFieldNumber:
-				WireFormatLite::ReadPrimitive<int32_t, WireFormatLite::TYPE_INT32>(input, &block->idRangeStart);
+				WireFormatLite::ReadPrimitive<int32_t, WireFormatLite::TYPE_INT32>(input, &info.idRangeStart);
 				break;
-			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kProfileIdFieldNumber:
-				WireFormatLite::ReadPrimitive<int32_t, WireFormatLite::TYPE_INT32>(input, &block->profileId);
-				break;
-			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kInnerBlocksFieldNumber:
-				if (!HHRoutingContext::checkId(searchInd, block)) {
-					input->Skip(input->BytesUntilLimit());
-				} else {
-					// read all sublist
-					HHRouteBlockSegments * child = regCtx->fileRegion->createHHRouteBlockSegments();
-					readInt(input, &child->length);
-					child->filePointer = input->TotalBytesRead();
-					int olLimit = input->PushLimit(child->length);
-//                    OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
-//                                      "BLOCK I:%d %d/%d - %d - %d %d",
-//                                      block->filePointer, block->idRangeStart, block->idRangeLength, block->sublist.size(), child->length, child->filePointer);
-					loaded += loadNetworkSegmentPoint(input, ctx, regCtx, child, searchInd);
-					input->PopLimit(olLimit);
-					block->sublist.push_back(child);
-				}
+			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kInnerBlocksFieldNumber: {
+				HHSegmentsBlockInfo child = {0, 0, 0, 0};
+				readInt(input, &child.length);
+				child.filePointer = input->TotalBytesRead();
+				readHHSegmentsDirectory(input, child, blocks);
 				break;
+			}
 			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kPointSegmentsFieldNumber:
-				if (!HHRoutingContext::checkId(searchInd, block)) {
-					input->Skip(input->BytesUntilLimit());
-				} else {
-					int pntFileId = (ind++) + block->idRangeStart;
-					NetworkDBPoint * point = regCtx->getPoint(pntFileId);
-					std::vector<int32_t> segmentsIn;
-					std::vector<int32_t> segmentsOut;
-					setSegments(input, ctx, segmentsIn, segmentsOut);
-					if (point != nullptr) {
-						// not used from this file
-						point->connectedSet(true, parseSegments(ctx, segmentsIn, ctx->getIncomingPoints(point), point, false));
-						point->connectedSet(false, parseSegments(ctx, segmentsOut, ctx->getOutgoingPoints(point), point, true));
-						loaded += point->conn(true).size() + point->conn(false).size();
-					}
-				}
+				leaf = true;
+				input->ReadVarint32(&size);
+				input->Skip(size);
 				break;
 			default:
 				skipUnknownFields(input, tag);
 				break;
 		}
 	}
-	input->PopLimit(oldLimit);
-	return 0;
 }
 
-int loadNetworkSegmentPoint(HHRoutingContext * ctx, SHARED_PTR<HHRouteRegionPointsCtx> regCtx, HHRouteBlockSegments * block, int searchInd) {
-	auto & file = regCtx->file;
-	auto & reg = regCtx->fileRegion;
-	
+void readHHSegmentsDirectory(BinaryMapFile* file, HHRouteBlockSegments * root, std::vector<HHSegmentsBlockInfo> & blocks) {
 	lseek(file->getHhFD(), 0, SEEK_SET);
 	FileInputStream stream(file->getHhFD());
 	stream.SetCloseOnDelete(false);
-	CodedInputStream * input = new CodedInputStream(&stream);
-	input->SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
-	input->Seek(reg->filePointer);
-	return loadNetworkSegmentPoint(input, ctx, regCtx, block, searchInd);
+	CodedInputStream input(&stream);
+	input.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
+	input.Seek(root->filePointer);
+	HHSegmentsBlockInfo info = {root->idRangeStart, root->idRangeLength, root->length, root->filePointer};
+	readHHSegmentsDirectory(&input, info, blocks);
+}
+
+bool readHHSegmentsBlock(BinaryMapFile* file, const HHSegmentsBlockInfo & info, HHSegmentsBlock & block) {
+	lseek(file->getHhFD(), 0, SEEK_SET);
+	FileInputStream stream(file->getHhFD());
+	stream.SetCloseOnDelete(false);
+	CodedInputStream input(&stream);
+	input.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
+	input.Seek(info.filePointer);
+	int oldLimit = input.PushLimit(info.length);
+	block.idRangeStart = info.idRangeStart;
+	block.values.clear();
+	block.offsets = {0};
+	std::vector<int32_t> segmentsIn;
+	std::vector<int32_t> segmentsOut;
+	uint32_t tag;
+	while (true) {
+		tag = input.ReadTag();
+		switch (WireFormatLite::GetTagFieldNumber(tag)) {
+			case 0:
+				input.PopLimit(oldLimit);
+				block.values.shrink_to_fit();
+				return true;
+			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kInnerBlocksFieldNumber:
+				// leaf block doesn't have inner blocks
+				skipFixed32(&input);
+				break;
+			case OsmAnd::OBF::OsmAndHHRoutingIndex_HHRouteBlockSegments::kPointSegmentsFieldNumber:
+				segmentsIn.clear();
+				segmentsOut.clear();
+				setSegments(&input, nullptr, segmentsIn, segmentsOut);
+				block.values.insert(block.values.end(), segmentsIn.begin(), segmentsIn.end());
+				block.offsets.push_back(block.values.size());
+				block.values.insert(block.values.end(), segmentsOut.begin(), segmentsOut.end());
+				block.offsets.push_back(block.values.size());
+				break;
+			default:
+				if (!skipUnknownFields(&input, tag)) {
+					input.PopLimit(oldLimit);
+					return false;
+				}
+				break;
+		}
+	}
 }
 
 bool readTransportBounds(CodedInputStream* input, TransportIndex* ind) {
@@ -1812,12 +1890,26 @@ void readIncompleteRoutesList(CodedInputStream* input, UNORDERED(map) < uint64_t
 	}
 }
 
+static thread_local int transportReadScopes = 0;
+
+TransportReadScope::TransportReadScope() {
+	transportReadScopes++;
+}
+
+TransportReadScope::~TransportReadScope() {
+	transportReadScopes--;
+}
+
+static int getTransportReadFD(BinaryMapFile* file) {
+	return transportReadScopes > 0 ? file->getTransportFD() : file->getRouteFD();
+}
+
 void getIncompleteTransportRoutes(BinaryMapFile* file) {
 	if (!file->incompleteLoaded) {
 		for (auto& ti : file->transportIndexes) {
 			if (ti->incompleteRoutesLength > 0) {
-				lseek(file->getRouteFD(), 0, SEEK_SET);
-				FileInputStream stream(file->getRouteFD());
+				lseek(getTransportReadFD(file), 0, SEEK_SET);
+				FileInputStream stream(getTransportReadFD(file));
 				stream.SetCloseOnDelete(false);
 				CodedInputStream* input = new CodedInputStream(&stream);
 				input->SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
@@ -2183,8 +2275,8 @@ bool readTransportRouteStop(CodedInputStream* input, SHARED_PTR<TransportStop>&
 
 bool readTransportRoute(BinaryMapFile* file, SHARED_PTR<TransportRoute>& transportRoute, int32_t filePointer,
 						UNORDERED(map) < int32_t, string > &stringTable, bool onlyDescription) {
-	lseek(file->getRouteFD(), 0, SEEK_SET);
-	FileInputStream stream(file->getRouteFD());
+	lseek(getTransportReadFD(file), 0, SEEK_SET);
+	FileInputStream stream(getTransportReadFD(file));
 	stream.SetCloseOnDelete(false);
 	CodedInputStream* input = new CodedInputStream(&stream);
 	input->SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
@@ -2426,8 +2518,8 @@ void searchTransportIndex(const SHARED_PTR<TransportIndex>& index, SearchQuery*
 }
 
 void searchTransportIndex(SearchQuery* q, BinaryMapFile* file) {
-	lseek(file->getRouteFD(), 0, SEEK_SET);
-	FileInputStream input(file->getRouteFD());
+	lseek(getTransportReadFD(file), 0, SEEK_SET);
+	FileInputStream input(getTransportReadFD(file));
 	input.SetCloseOnDelete(false);
 	CodedInputStream cis(&input);
 	cis.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
@@ -2480,8 +2572,8 @@ void loadTransportRoutes(BinaryMapFile* file, vector<int32_t> filePointers, UNOR
 				finishInit.push_back(transportRoute);
 			}
 		}
-		lseek(file->getRouteFD(), 0, SEEK_SET);
-		FileInputStream input(file->getRouteFD());
+		lseek(getTransportReadFD(file), 0, SEEK_SET);
+		FileInputStream input(getTransportReadFD(file));
 		input.SetCloseOnDelete(false);
 		CodedInputStream cis(&input);
 		cis.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
@@ -3575,7 +3667,11 @@ bool readRouteTreeData(CodedInputStream* input, RouteSubregion* s, std::vector<R
 void searchRouteSubRegion(int fileInd, std::vector<RouteDataObject*>& list, const SHARED_PTR<RoutingIndex>& routingIndex,
 						  RouteSubregion* sub) {
 	checkAndInitRouteRegionRules(fileInd, routingIndex);
+	readRouteSubRegionData(fileInd, list, routingIndex, sub);
+}
 
+void readRouteSubRegionData(int fileInd, std::vector<RouteDataObject*>& list,
+							const SHARED_PTR<RoutingIndex>& routingIndex, RouteSubregion* sub) {
 	// could be simplified but it will be concurrency with init block
 	lseek(fileInd, 0, SEEK_SET);
 	FileInputStream input(fileInd);
@@ -3610,6 +3706,21 @@ void searchRouteDataForSubRegion(SearchQuery* q, std::vector<RouteDataObject*>&
 	}
 }
 
+BinaryMapFile* findRouteSubRegionFile(RouteSubregion* sub, SHARED_PTR<RoutingIndex>& routingIndex) {
+	const auto& rs = sub->routingIndex;
+	for (BinaryMapFile* file : openFiles) {
+		for (const auto& ind : file->routingIndexes) {
+			if (rs && (rs->name != ind->name || rs->filePointer != ind->filePointer)) {
+				continue;
+			}
+			checkAndInitRouteRegionRules(file->getRouteFD(), ind);
+			routingIndex = ind;
+			return file;
+		}
+	}
+	return NULL;
+}
+
 bool closeBinaryMapFile(std::string inputName) {
 	std::vector<BinaryMapFile*>::iterator iterator = openFiles.begin();
 	for (; iterator != openFiles.end(); iterator++) {
@@ -3645,6 +3756,7 @@ bool initMapFilesFromCache(std::string inputName) {
 						  (int)timer.GetElapsedMs());
 		cache = c->version() == CACHE_VERSION ? c : NULL;
 		cacheHasChanged = false;
+		cacheFileIndexesValid = false;
 		return true;
 	}
 	return false;
@@ -3658,176 +3770,253 @@ bool hasEnding(std::string const& fullString, std::string const& ending) {
 	}
 }
 
-BinaryMapFile* initBinaryMapFile(std::string inputName, bool useLive, bool routingOnly) {
-	GOOGLE_PROTOBUF_VERIFY_VERSION;
-	OsmAnd::ElapsedTimer timer;
-	timer.Start();
-	std::map<std::string, BinaryMapFile*>::iterator iterator;
-	closeBinaryMapFile(inputName);
-
+static BinaryMapFile* createBinaryMapFile(const std::string& inputName) {
 	BinaryMapFile* mapFile = new BinaryMapFile();
 	mapFile->liveMap = inputName.find("live/") != string::npos;
 	mapFile->inputName = inputName;
 	mapFile->roadOnly = inputName.find(".road") != string::npos;
-	OsmAnd::OBF::FileIndex* fo = NULL;
-	if (cache != NULL) {
-		struct stat stats;
-		stat(inputName.c_str(), &stats);
+	return mapFile;
+}
+
+// Returns cache entry of file if file wasn't changed (looked up by file name in index of cache entries)
+static const OsmAnd::OBF::FileIndex* findCachedFileIndex(const std::string& inputName) {
+	if (cache == NULL) {
+		return NULL;
+	}
+	if (!cacheFileIndexesValid) {
+		cacheFileIndexes.clear();
 		for (int i = 0; i < cache->fileindex_size(); i++) {
-			OsmAnd::OBF::FileIndex fi = cache->fileindex(i);
-			if (hasEnding(inputName, fi.filename())) {
-				if (fi.size() == stats.st_size) {
-					fo = cache->mutable_fileindex(i);
-					break;
-				} else {
-					OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Native file and cache %s have different sizes %u != %u",
-						  inputName.c_str(), (unsigned int)fi.size(), (unsigned int)stats.st_size);
-				}
-			}
+			cacheFileIndexes.insert(std::make_pair(cache->fileindex(i).filename(), i));
 		}
+		cacheFileIndexesValid = true;
 	}
-	if (fo != NULL) {
-		mapFile->version = fo->version();
-		mapFile->dateCreated = fo->datemodified();
-		if (!routingOnly) {
-			for (int i = 0; i < fo->mapindex_size(); i++) {
-				auto mi = std::make_shared<MapIndex>();
-				OsmAnd::OBF::MapPart mp = fo->mapindex(i);
-				mi->filePointer = mp.offset();
-				mi->length = mp.size();
-				mi->name = mp.name();
-				for (int j = 0; j < mp.levels_size(); j++) {
-					OsmAnd::OBF::MapLevel ml = mp.levels(j);
-					MapRoot mr;
-					mr.bottom = ml.bottom();
-					mr.left = ml.left();
-					mr.right = ml.right();
-					mr.top = ml.top();
-					mr.maxZoom = ml.maxzoom();
-					mr.minZoom = ml.minzoom();
-					mr.filePointer = ml.offset();
-					mr.length = ml.size();
-					mi->levels.push_back(mr);
-				}
-				mapFile->basemap = mapFile->basemap || mi->name.find("basemap") != string::npos;
-				mapFile->mapIndexes.push_back(mi);
-				mapFile->indexes.push_back(mapFile->mapIndexes.back());
-			}
-		}
-
-		for (int i = 0; i < fo->transportindex_size(); i++) {
-			auto ti = std::make_shared<TransportIndex>();
-			OsmAnd::OBF::TransportPart tp = fo->transportindex(i);
-			ti->filePointer = tp.offset();
-			ti->length = tp.size();
-			ti->name = tp.name();
-			ti->left = tp.left();
-			ti->right = tp.right();
-			ti->top = tp.top();
-			ti->bottom = tp.bottom();
-			IndexStringTable* st = new IndexStringTable();
-			st->fileOffset = tp.stringtableoffset();
-			st->length = tp.stringtablelength();
-			ti->stringTable = st;
-			ti->stopsFileOffset = tp.stopstableoffset();
-			ti->stopsFileLength = tp.stopstablelength();
-			ti->incompleteRoutesOffset = tp.incompleteroutesoffset();
-			ti->incompleteRoutesLength = tp.incompleterouteslength();
-			mapFile->transportIndexes.push_back(ti);
-			mapFile->indexes.push_back(mapFile->transportIndexes.back());
-		}
-
-		for (int i = 0; i < fo->routingindex_size() && (!mapFile->liveMap || useLive); i++) {
-			auto mi = std::make_shared<RoutingIndex>();
-			OsmAnd::OBF::RoutingPart mp = fo->routingindex(i);
+	auto it = cacheFileIndexes.find(getFileName(inputName));
+	if (it == cacheFileIndexes.end()) {
+		return NULL;
+	}
+	const OsmAnd::OBF::FileIndex& fi = cache->fileindex(it->second);
+	struct stat stats;
+	stat(inputName.c_str(), &stats);
+	if (fi.size() != stats.st_size) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Native file and cache %s have different sizes %u != %u",
+						  inputName.c_str(), (unsigned int)fi.size(), (unsigned int)stats.st_size);
+		return NULL;
+	}
+	return &fi;
+}
+
+static void initMapFileFromCache(BinaryMapFile* mapFile, const OsmAnd::OBF::FileIndex& fo, bool useLive,
+								 bool routingOnly) {
+	mapFile->version = fo.version();
+	mapFile->dateCreated = fo.datemodified();
+	if (!routingOnly) {
+		for (int i = 0; i < fo.mapindex_size(); i++) {
+			auto mi = std::make_shared<MapIndex>();
+			const OsmAnd::OBF::MapPart& mp = fo.mapindex(i);
 			mi->filePointer = mp.offset();
 			mi->length = mp.size();
 			mi->name = mp.name();
-			for (int j = 0; j < mp.subregions_size(); j++) {
-				OsmAnd::OBF::RoutingSubregion ml = mp.subregions(j);
-				RouteSubregion mr(mi);
+			for (int j = 0; j < mp.levels_size(); j++) {
+				const OsmAnd::OBF::MapLevel& ml = mp.levels(j);
+				MapRoot mr;
 				mr.bottom = ml.bottom();
 				mr.left = ml.left();
 				mr.right = ml.right();
 				mr.top = ml.top();
-				mr.mapDataBlock = ml.shiftodata();
+				mr.maxZoom = ml.maxzoom();
+				mr.minZoom = ml.minzoom();
 				mr.filePointer = ml.offset();
 				mr.length = ml.size();
-				if (ml.basemap()) {
-					mi->basesubregions.push_back(mr);
-				} else {
-					mi->subregions.push_back(mr);
-				}
+				mi->levels.push_back(mr);
 			}
-			mapFile->routingIndexes.push_back(mi);
-			mapFile->indexes.push_back(mapFile->routingIndexes.back());
+			mapFile->basemap = mapFile->basemap || mi->name.find("basemap") != string::npos;
+			mapFile->mapIndexes.push_back(mi);
+			mapFile->indexes.push_back(mapFile->mapIndexes.back());
 		}
-		
-		for (int i = 0; i < fo->hhroutingindex_size() && !mapFile->liveMap; i++) {
-			auto mi = std::make_shared<HHRouteIndex>();
-			OsmAnd::OBF::HHRoutingPart mp = fo->hhroutingindex(i);
-			mi->filePointer = mp.offset();
-			mi->length = mp.size();
-			mi->edition = mp.edition();
-			mi->profile = mp.profile();
-			for (int j = 0; j < mp.profileparams_size(); j++) {
-				mi->profileParams.push_back(mp.profileparams(j));
-			}
-			mi->top = std::make_shared<HHRoutePointsBox>();
-			mi->top->bottom = mp.bottom();
-			mi->top->right = mp.right();
-			mi->top->left = mp.left();
-			mi->top->top = mp.top();
-			mapFile->hhIndexes.push_back(mi);
-			mapFile->indexes.push_back(mapFile->hhIndexes.back());
+	}
+
+	for (int i = 0; i < fo.transportindex_size(); i++) {
+		auto ti = std::make_shared<TransportIndex>();
+		const OsmAnd::OBF::TransportPart& tp = fo.transportindex(i);
+		ti->filePointer = tp.offset();
+		ti->length = tp.size();
+		ti->name = tp.name();
+		ti->left = tp.left();
+		ti->right = tp.right();
+		ti->top = tp.top();
+		ti->bottom = tp.bottom();
+		IndexStringTable* st = new IndexStringTable();
+		st->fileOffset = tp.stringtableoffset();
+		st->length = tp.stringtablelength();
+		ti->stringTable = st;
+		ti->stopsFileOffset = tp.stopstableoffset();
+		ti->stopsFileLength = tp.stopstablelength();
+		ti->incompleteRoutesOffset = tp.incompleteroutesoffset();
+		ti->incompleteRoutesLength = tp.incompleterouteslength();
+		mapFile->transportIndexes.push_back(ti);
+		mapFile->indexes.push_back(mapFile->transportIndexes.back());
+	}
+
+	for (int i = 0; i < fo.routingindex_size() && (!mapFile->liveMap || useLive); i++) {
+		auto mi = std::make_shared<RoutingIndex>();
+		const OsmAnd::OBF::RoutingPart& mp = fo.routingindex(i);
+		mi->filePointer = mp.offset();
+		mi->length = mp.size();
+		mi->name = mp.name();
+		for (int j = 0; j < mp.subregions_size(); j++) {
+			const OsmAnd::OBF::RoutingSubregion& ml = mp.subregions(j);
+			RouteSubregion mr(mi);
+			mr.bottom = ml.bottom();
+			mr.left = ml.left();
+			mr.right = ml.right();
+			mr.top = ml.top();
+			mr.mapDataBlock = ml.shiftodata();
+			mr.filePointer = ml.offset();
+			mr.length = ml.size();
+			if (ml.basemap()) {
+				mi->basesubregions.push_back(mr);
+			} else {
+				mi->subregions.push_back(mr);
+			}
 		}
+		mapFile->routingIndexes.push_back(mi);
+		mapFile->indexes.push_back(mapFile->routingIndexes.back());
+	}
+	
+	for (int i = 0; i < fo.hhroutingindex_size() && !mapFile->liveMap; i++) {
+		auto mi = std::make_shared<HHRouteIndex>();
+		const OsmAnd::OBF::HHRoutingPart& mp = fo.hhroutingindex(i);
+		mi->filePointer = mp.offset();
+		mi->length = mp.size();
+		mi->edition = mp.edition();
+		mi->profile = mp.profile();
+		for (int j = 0; j < mp.profileparams_size(); j++) {
+			mi->profileParams.push_back(mp.profileparams(j));
+		}
+		mi->top = std::make_shared<HHRoutePointsBox>();
+		mi->top->bottom = mp.bottom();
+		mi->top->right = mp.right();
+		mi->top->left = mp.left();
+		mi->top->top = mp.top();
+		mapFile->hhIndexes.push_back(mi);
+		mapFile->indexes.push_back(mapFile->hhIndexes.back());
+	}
+}
+
+static bool parseMapFile(BinaryMapFile* mapFile, bool useLive, bool routingOnly) {
+	FileInputStream input(mapFile->getFD());
+	input.SetCloseOnDelete(false);
+	CodedInputStream cis(&input);
+	cis.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
+	return initMapStructure(&cis, mapFile, useLive, routingOnly);
+}
+
+BinaryMapFile* initBinaryMapFile(std::string inputName, bool useLive, bool routingOnly) {
+	GOOGLE_PROTOBUF_VERIFY_VERSION;
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+	closeBinaryMapFile(inputName);
+
+	BinaryMapFile* mapFile = createBinaryMapFile(inputName);
+	const OsmAnd::OBF::FileIndex* fo = findCachedFileIndex(inputName);
+	if (fo != NULL) {
+		initMapFileFromCache(mapFile, *fo, useLive, routingOnly);
 		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Native file initialized from cache: %s %d ms",
 						  inputName.c_str(), (int)timer.GetElapsedMs());
+	} else if (!parseMapFile(mapFile, useLive, routingOnly)) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Native File not initialised : %s %d ms",
+				inputName.c_str(), (int)timer.GetElapsedMs());
+		delete mapFile;
+		return NULL;
 	} else {
-		FileInputStream input(mapFile->getFD());
-		input.SetCloseOnDelete(false);
-		CodedInputStream cis(&input);
-		cis.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
-		if (!initMapStructure(&cis, mapFile, useLive, routingOnly)) {
-			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Native File not initialised : %s %d ms",
-					inputName.c_str(), (int)timer.GetElapsedMs());
-			delete mapFile;
-			return NULL;
-		} else {
-			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Warning, "Native File not initialized from cache: %s %d ms",
-					inputName.c_str(), (int)timer.GetElapsedMs());
-		}
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Warning, "Native File not initialized from cache: %s %d ms",
+				inputName.c_str(), (int)timer.GetElapsedMs());
 	}
 
 	openFiles.push_back(mapFile);
 	return mapFile;
 }
 
-bool cacheBinaryMapFileIfNeeded(const std::string& inputName, bool routingOnly) {
+std::vector<BinaryMapFile*> initBinaryMapFiles(const std::vector<std::string>& inputNames, bool useLive,
+											   bool routingOnly, int threads) {
 	GOOGLE_PROTOBUF_VERIFY_VERSION;
 	OsmAnd::ElapsedTimer timer;
 	timer.Start();
+	UNORDERED(set)<std::string> names;
+	std::vector<BinaryMapFile*> files;
+	std::vector<const OsmAnd::OBF::FileIndex*> cachedIndexes;
+	int cachedFiles = 0;
+	// cache is looked up only by this thread, workers just read found entries
+	for (const std::string& inputName : inputNames) {
+		if (names.insert(inputName).second) {
+			files.push_back(createBinaryMapFile(inputName));
+			cachedIndexes.push_back(findCachedFileIndex(inputName));
+			cachedFiles += cachedIndexes.back() != NULL ? 1 : 0;
+		}
+	}
+	const int size = (int)files.size();
+	int lookupTime = (int)timer.GetElapsedMs();
 
-	if (cache != NULL) {
-		struct stat stats;
-		stat(inputName.c_str(), &stats);
-		for (int i = 0; i < cache->fileindex_size(); i++) {
-			OsmAnd::OBF::FileIndex fi = cache->fileindex(i);
-			if (hasEnding(inputName, fi.filename()) && fi.size() == stats.st_size) {
-				return false;
+	std::atomic<int> nextFile(0);
+	auto worker = [&]() {
+		for (int i = nextFile++; i < size; i = nextFile++) {
+			if (cachedIndexes[i] != NULL) {
+				initMapFileFromCache(files[i], *cachedIndexes[i], useLive, routingOnly);
+			} else if (!parseMapFile(files[i], useLive, routingOnly)) {
+				OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Native File not initialised : %s",
+								  files[i]->inputName.c_str());
+				delete files[i];
+				files[i] = NULL;
 			}
 		}
+	};
+	threads = std::max(1, std::min(threads, size - cachedFiles));
+	std::vector<std::thread> workers;
+	for (int t = 1; t < threads; t++) {
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread& w : workers) {
+		w.join();
+	}
+	int initTime = (int)timer.GetElapsedMs() - lookupTime;
+
+	// previously opened files with the same names are replaced, open files are swapped at once
+	std::vector<BinaryMapFile*> published;
+	std::vector<BinaryMapFile*> replaced;
+	for (BinaryMapFile* file : openFiles) {
+		(names.find(file->inputName) != names.end() ? replaced : published).push_back(file);
+	}
+	std::vector<BinaryMapFile*> result;
+	for (BinaryMapFile* file : files) {
+		if (file != NULL) {
+			published.push_back(file);
+			result.push_back(file);
+		}
+	}
+	openFiles.swap(published);
+	for (BinaryMapFile* file : replaced) {
+		delete file;
 	}
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
+					  "Native files initialized: %d of %d (%d from cache, %d parsed) in %d ms "
+					  "(cache lookup %d ms, init %d ms, %d threads)",
+					  (int)result.size(), size, cachedFiles, size - cachedFiles, (int)timer.GetElapsedMs(),
+					  lookupTime, initTime, threads);
+	return result;
+}
 
-	BinaryMapFile* mapFile = new BinaryMapFile();
-	mapFile->liveMap = inputName.find("live/") != string::npos;
-	mapFile->inputName = inputName;
-	mapFile->roadOnly = inputName.find(".road") != string::npos;
-	FileInputStream input(mapFile->getFD());
-	input.SetCloseOnDelete(false);
-	CodedInputStream cis(&input);
-	cis.SetTotalBytesLimit(INT_MAXIMUM, INT_MAX_THRESHOLD);
-	if (!initMapStructure(&cis, mapFile, true, routingOnly)) {
+bool cacheBinaryMapFileIfNeeded(const std::string& inputName, bool routingOnly) {
+	GOOGLE_PROTOBUF_VERIFY_VERSION;
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+
+	if (findCachedFileIndex(inputName) != NULL) {
+		return false;
+	}
+
+	BinaryMapFile* mapFile = createBinaryMapFile(inputName);
+	if (!parseMapFile(mapFile, true, routingOnly)) {
 		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Native File not initialised for caching : %s %d ms",
 						  inputName.c_str(), (int)timer.GetElapsedMs());
 		delete mapFile;
@@ -3859,6 +4048,7 @@ bool addToCache(BinaryMapFile* mapFile, bool routingOnly) {
 		return false;
 	}
 	cacheHasChanged = true;
+	cacheFileIndexesValid = false;
 	auto mapFileName = getFileName(mapFile->inputName);
 	if (!cache) {
 		cache = new OsmAnd::OBF::OsmAndStoredIndex();
@@ -134,9 +134,15 @@ struct RoutingIndex : BinaryPartIndex {
 
 	uint32_t searchRouteEncodingRule(const std::string& tag, const std::string& value);
 
+	// Builds decoding rules (tag#value -> id) if they are not built yet, thread-safe
+	void initDecodingRules();
+
 	RouteTypeRule& quickGetEncodingRule(uint32_t id) {
 		return routeEncodingRules[id];
 	}
+
+   private:
+	void buildDecodingRules();
 };
 
 struct HHRoutePointsBox {
@@ -174,6 +180,28 @@ struct HHRouteBlockSegments {
 	std::vector<HHRouteBlockSegments *> sublist;
 };
 
+// Leaf block of HH point segments (points with file ids idRangeStart .. idRangeStart + idRangeLength - 1)
+struct HHSegmentsBlockInfo {
+	int idRangeStart;
+	int32_t idRangeLength;
+	uint64_t length;
+	uint64_t filePointer;
+};
+
+// Point segments of leaf block decoded into compact arrays: segments in of point i (file id idRangeStart + i) are
+// values[offsets[2 * i] .. offsets[2 * i + 1]), segments out are values[offsets[2 * i + 1] .. offsets[2 * i + 2])
+struct HHSegmentsBlock {
+	int idRangeStart;
+	std::vector<int32_t> values;
+	std::vector<uint32_t> offsets;
+
+	int getPointsCount() const { return offsets.empty() ? 0 : (int)(offsets.size() - 1) / 2; }
+
+	size_t getSize() const {
+		return sizeof(HHSegmentsBlock) + values.capacity() * sizeof(int32_t) + offsets.capacity() * sizeof(uint32_t);
+	}
+};
+
 struct TagValuePair {
 	std::string tag;
 	std::string value;
@@ -252,6 +280,13 @@ struct RouteDataObject {
 	std::vector<std::vector<uint32_t>> pointNameIds;
 	std::vector<std::vector<std::string>> pointNames;
 	std::vector<double> heightDistanceArray;
+	// heights were requested from ElevationProvider (road has no elevation tags), not set while there is no provider
+	bool heightsProvided = false;
+	// types before conditional tags were applied, kept to apply them for another time (see conditional sweep)
+	std::vector<uint32_t> unconditionalTypes;
+	std::vector<std::vector<uint32_t>> unconditionalPointTypes;
+	// road isn't accepted by router with conditional tags applied for current time
+	bool conditionallyRejected = false;
 	int64_t id;
 
 	void setPointTypes(int pntInd, std::vector<uint32_t> array) {
@@ -440,6 +475,18 @@ struct RouteDataObject {
 
 	void processConditionalTags(const tm& time);
 
+	bool hasConditionalTags();
+
+	void keepUnconditionalTypes() {
+		unconditionalTypes = types;
+		unconditionalPointTypes = pointTypes;
+	}
+
+	void restoreUnconditionalTypes() {
+		types = unconditionalTypes;
+		pointTypes = unconditionalPointTypes;
+	}
+
    #ifdef _IOS_BUILD
 	inline string transliterate(const string& s) {
 		QString transliterateName = OsmAnd::ICU::transliterateToLatin(QString::fromStdString(s));
@@ -498,6 +545,7 @@ struct RouteDataObject {
 		s += pointsX.capacity() * sizeof(uint32_t);
 		s += pointsY.capacity() * sizeof(uint32_t);
 		s += types.capacity() * sizeof(uint32_t);
+		s += unconditionalTypes.capacity() * sizeof(uint32_t);
 		s += restrictions.capacity() * sizeof(uint64_t);
 		std::vector<std::vector<uint32_t>>::iterator t = pointTypes.begin();
 		for (; t != pointTypes.end(); t++) {
@@ -586,6 +634,7 @@ struct RouteDataObject {
 	}
 
 	std::vector<double> calculateHeightArray();
+	std::vector<double> calculateProvidedHeightArray();
 
 	string getHighway();
 
@@ -900,6 +949,8 @@ struct BinaryMapFile {
 	int routefd = -1;
 	int geocodingfd = -1;
 	int hhfd = -1;
+	int prefetchfd = -1;
+	int transportfd = -1;
 	bool basemap;
 	bool external;
 	bool roadOnly;
@@ -948,6 +999,22 @@ struct BinaryMapFile {
 		return hhfd;
 	}
 
+	// separate descriptor used only by background route tile prefetcher
+	int getPrefetchFD() {
+		if (prefetchfd <= 0) {
+			prefetchfd = openFile();
+		}
+		return prefetchfd;
+	}
+
+	// separate descriptor used by shared transport network cache (reads are serialized by cache)
+	int getTransportFD() {
+		if (transportfd <= 0) {
+			transportfd = openFile();
+		}
+		return transportfd;
+	}
+
 	bool isBasemap() {
 		return basemap;
 	}
@@ -976,9 +1043,22 @@ struct BinaryMapFile {
 		if (hhfd >= 0) {
 			close(hhfd);
 		}
+		if (prefetchfd >= 0) {
+			close(prefetchfd);
+		}
+		if (transportfd >= 0) {
+			close(transportfd);
+		}
 	}
 };
 
+// Transport index reads of current thread use BinaryMapFile::getTransportFD instead of route descriptor
+// while scope exists
+struct TransportReadScope {
+	TransportReadScope();
+	~TransportReadScope();
+};
+
 struct ResultPublisher {
 	std::vector<FoundMapDataObject> result;
 	UNORDERED(map)<uint64_t, FoundMapDataObject> ids;
@@ -1103,11 +1183,24 @@ bool searchRouteSubregionsForBinaryMapFile(BinaryMapFile* file,
 void searchRouteDataForSubRegion(SearchQuery* q, std::vector<RouteDataObject*>& list, RouteSubregion* sub,
 								 bool geocoding);
 
+// Finds file and routing index of subregion (rules are initialized), returns NULL if file is not open
+BinaryMapFile* findRouteSubRegionFile(RouteSubregion* sub, SHARED_PTR<RoutingIndex>& routingIndex);
+
+// Reads route data block without touching routing index (could be called from background thread with own fd)
+void readRouteSubRegionData(int fileInd, std::vector<RouteDataObject*>& list,
+							const SHARED_PTR<RoutingIndex>& routingIndex, RouteSubregion* sub);
+
 ResultPublisher* searchObjectsForRendering(SearchQuery* q, bool skipDuplicates, std::string msgNothingFound,
 										   int& renderedState);
 
 BinaryMapFile* initBinaryMapFile(std::string inputName, bool useLive, bool routingOnly);
 
+// Initializes many files at once (startup): cached files are initialized from cache (looked up by file name),
+// others are parsed by threads, then all initialized files replace open files with the same names together.
+// Returns initialized files, files which failed are skipped.
+std::vector<BinaryMapFile*> initBinaryMapFiles(const std::vector<std::string>& inputNames, bool useLive,
+											   bool routingOnly, int threads);
+
 bool initMapFilesFromCache(std::string inputName);
 
 bool cacheBinaryMapFileIfNeeded(const std::string& inputName, bool routingOnly);
@@ -1121,8 +1214,12 @@ bool closeBinaryMapFile(std::string inputName);
 void getIncompleteTransportRoutes(BinaryMapFile* file);
 
 struct NetworkDBPoint;
+struct NetworkDBSegment;
 struct HHRoutingContext;
 struct HHRouteRegionPointsCtx;
 void initHHPoints(BinaryMapFile* file, SHARED_PTR<HHRouteIndex> reg, HHRoutingContext * ctx, short mapId, UNORDERED_map<int64_t, NetworkDBPoint *> & resPoints);
-int loadNetworkSegmentPoint(HHRoutingContext * ctx, SHARED_PTR<HHRouteRegionPointsCtx> regCtx, HHRouteBlockSegments * block, int searchInd);
+std::vector<NetworkDBSegment *> parseSegments(HHRoutingContext * ctx, std::vector<int32_t> pointSegments, std::vector<NetworkDBPoint *> lst, NetworkDBPoint * pnt, bool out);
+// Reads headers of all leaf blocks under segments root block (without point segments)
+void readHHSegmentsDirectory(BinaryMapFile* file, HHRouteBlockSegments * root, std::vector<HHSegmentsBlockInfo> & blocks);
+bool readHHSegmentsBlock(BinaryMapFile* file, const HHSegmentsBlockInfo & info, HHSegmentsBlock & block);
 #endif
@@ -79,7 +79,7 @@ static float estimatedDistance(const SHARED_PTR<RouteSegment>& seg, bool rev, co
 	return (float)(distance / ctx->config->router->getMaxSpeed());
 }
 
-static double h(RoutingContext* ctx, int begX, int begY, int endX, int endY) {
+static double h(RoutingContext* ctx, int begX, int begY, int endX, int endY, bool reverseWaySearch) {
 	if (ctx->dijkstraMode != 0) {
 		return 0;
 	}
@@ -89,6 +89,17 @@ static double h(RoutingContext* ctx, int begX, int begY, int endX, int endY) {
 	}
 	double distToFinalPoint = squareRootDist(begX, begY, endX, endY);
 	double result = distToFinalPoint / ctx->config->router->getMaxSpeed();
+	if (!ctx->landmarks.empty()) {
+		// reverse search estimates time from start point to the segment
+		double lb = reverseWaySearch ? ctx->landmarksLowerBound(endX, endY, begX, begY)
+									 : ctx->landmarksLowerBound(begX, begY, endX, endY);
+		if (lb > result) {
+			result = lb;
+			if (ctx->progress) {
+				ctx->progress->landmarkEstimates++;
+			}
+		}
+	}
 	return result;
 }
 
@@ -316,9 +327,11 @@ vector<SHARED_PTR<RouteSegment>> searchRouteInternal(RoutingContext* ctx, SHARED
 	// measure time
 
 	int iterationsToUpdate = 0;
+	int iterationsToUpdateFrontier = 0;
 	if (ctx->progress.get()) {
 		ctx->progress->timeToCalculate.Start();
 	}
+	ctx->initLandmarks();
 
 	// Initializing priority queue to visit way segments
 	SegmentsComparator sgmCmp;
@@ -414,6 +427,9 @@ vector<SHARED_PTR<RouteSegment>> searchRouteInternal(RoutingContext* ctx, SHARED
 		}
 		
 		if (!skipSegment) {
+			if (ctx->visitor) {
+				ctx->visitor(segment, !forwardSearch);
+			}
 			if (forwardSearch) {
 				bool doNotAddIntersections = onlyBackward;
 				processRouteSegment(ctx, false, graphDirectSegments, visitedDirectSegments, segment,
@@ -435,6 +451,17 @@ vector<SHARED_PTR<RouteSegment>> searchRouteInternal(RoutingContext* ctx, SHARED
 				break;
 			}
 		}
+		if (iterationsToUpdateFrontier-- < 0) {
+			iterationsToUpdateFrontier = 50;
+			ctx->updateSearchFrontier(graphDirectSegments.empty() ? nullptr : graphDirectSegments.top()->segment,
+									  graphReverseSegments.empty() ? nullptr : graphReverseSegments.top()->segment);
+			if (!graphDirectSegments.empty()) {
+				ctx->prefetchTiles(graphDirectSegments.top()->segment, false);
+			}
+			if (!graphReverseSegments.empty()) {
+				ctx->prefetchTiles(graphReverseSegments.top()->segment, true);
+			}
+		}
 		
 		
 		bool reiterate = false;
@@ -858,9 +885,13 @@ SHARED_PTR<RouteSegment> processIntersections(RoutingContext* ctx, SEGMENTS_QUEU
 	int targetEndY = reverseWaySearch ? ctx->startY : ctx->targetY;
 	const int x = currentSegment->getRoad()->pointsX[currentSegment->getSegmentEnd()];
 	const int y = currentSegment->getRoad()->pointsY[currentSegment->getSegmentEnd()];
-	float distanceToEnd = h(ctx, x, y, targetEndX, targetEndY);
+	float distanceToEnd = h(ctx, x, y, targetEndX, targetEndY, reverseWaySearch);
 	// reassign @distanceToEnd to make it correct for visited segment
 	currentSegment->distanceToEnd = distanceToEnd;
+	if (ctx->isOutsideRerouteCorridor(x, y)) {
+		// incremental reroute: don't expand search outside of corridor around previous route
+		return nextCurrentSegment;
+	}
 	auto connectedNextSegments = ctx->loadRouteSegment(x, y, reverseWaySearch);
 	bool directionAllowed = true;
 	bool singleRoad = true;
@@ -1069,6 +1100,78 @@ SHARED_PTR<RouteSegmentPoint> findRouteSegment(int px, int py, RoutingContext* c
 	return nullptr;
 }
 
+void findRouteSegments(const vector<int_pair>& points, RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentPoint>>& res,
+					   int k) {
+	res.clear();
+	if (ctx->publicTransport) {
+		for (const int_pair& p : points) {
+			res.push_back(findRouteSegment(p.first, p.second, ctx, false));
+		}
+		return;
+	}
+	RouteSegmentGrid& grid = ctx->segmentGrid;
+	for (const int_pair& p : points) {
+		if (!grid.isIndexed(p.first, p.second) && !ctx->isInterrupted()) {
+			if (ctx->progress) {
+				ctx->progress->timeToFindInitialSegments.Start();
+			}
+			vector<SHARED_PTR<RouteDataObject>> dataObjects;
+			ctx->loadTileData(p.first, p.second, RouteSegmentGrid::ZOOM, dataObjects);
+			for (auto& o : dataObjects) {
+				grid.addRoad(o);
+			}
+			grid.setIndexed(p.first, p.second);
+			if (ctx->progress) {
+				ctx->progress->timeToFindInitialSegments.Pause();
+			}
+		}
+	}
+	UNORDERED(map)<uint32_t, std::pair<int, double>> nearest;
+	for (const int_pair& p : points) {
+		SHARED_PTR<RouteSegmentPoint> ps;
+		// grid could be cleared by GC while roads around next points were loaded
+		if (grid.isIndexed(p.first, p.second)) {
+			if (ctx->progress) {
+				ctx->progress->timeToFindInitialSegments.Start();
+			}
+			grid.findNearestSegments(p.first, p.second, nearest);
+			vector<SHARED_PTR<RouteSegmentPoint>> list;
+			for (auto& n : nearest) {
+				SHARED_PTR<RouteDataObject>& r = grid.roads[n.first];
+				int j = n.second.first;
+				std::pair<int, int> pr =
+					getProjectionPoint(p.first, p.second, r->pointsX[j - 1], r->pointsY[j - 1], r->pointsX[j], r->pointsY[j]);
+				SHARED_PTR<RouteSegmentPoint> road = std::make_shared<RouteSegmentPoint>(
+					r, j - 1, j, squareDist31TileMetric(pr.first, pr.second, p.first, p.second));
+				road->preciseX = pr.first;
+				road->preciseY = pr.second;
+				float prio = ctx->config->router->defineDestinationPriority(road->road);
+				if (prio > 0) {
+					road->dist = (road->dist + GPS_POSSIBLE_ERROR * GPS_POSSIBLE_ERROR) / (prio * prio);
+					list.push_back(road);
+				}
+			}
+			sort(list.begin(), list.end(), sortRoutePoints);
+			if (!list.empty()) {
+				ps = list[0];
+				list.erase(list.begin());
+				if (k > 0 && (int)list.size() > k - 1) {
+					list.resize(k - 1);
+				}
+				ps->others = list;
+			}
+			if (ctx->progress) {
+				ctx->progress->timeToFindInitialSegments.Pause();
+			}
+		}
+		if (!ps && !ctx->isInterrupted()) {
+			// no roads nearby, look farther (lower zooms)
+			ps = findRouteSegment(p.first, p.second, ctx, false);
+		}
+		res.push_back(ps);
+	}
+}
+
 bool combineTwoSegmentResultPlanner(const SHARED_PTR<RouteSegmentResult>& toAdd, const SHARED_PTR<RouteSegmentResult>& previous,
 									bool reverse) {
 	bool ld = previous->getEndPointIndex() > previous->getStartPointIndex();
@@ -1282,3 +1385,29 @@ vector<SHARED_PTR<RouteSegmentResult>> searchRouteInternal(RoutingContext* ctx,
 	attachConnectedRoads(ctx, res);
 	return res;
 }
+
+vector<float> searchRouteSweep(RoutingContext* ctx, const vector<time_t>& departureTimes,
+							   vector<vector<SHARED_PTR<RouteSegmentResult>>>* routes) {
+	vector<float> times;
+	ctx->setConditionalSweep(true);
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+	for (time_t departureTime : departureTimes) {
+		if (ctx->isInterrupted()) {
+			break;
+		}
+		ctx->setConditionalTime(departureTime);
+		vector<SHARED_PTR<RouteSegmentResult>> res = searchRouteInternal(ctx, false);
+		times.push_back(ctx->finalRouteSegment && !res.empty() ? ctx->finalRouteSegment->distanceFromStart : -1);
+		if (routes) {
+			routes->push_back(res);
+		}
+		// only state of the last search is reset: precalculated route, previous route, intermediates
+		// and progress belong to whole sweep
+		ctx->resetSegmentsState();
+	}
+	timer.Pause();
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Route sweep %d departures, %.2f ms (tiles %d)",
+					  (int)times.size(), timer.GetElapsedMicros() / 1000.0, (int)ctx->tilesClock.size());
+	return times;
+}
@@ -27,7 +27,19 @@ typedef UNORDERED_map<int64_t, SHARED_PTR<RouteSegment> > VISITED_MAP;
 SHARED_PTR<RouteSegmentPoint> findRouteSegment(int px, int py, RoutingContext* ctx, bool transportStop = false,
 											   int64_t roadId = -1, int segmentInd = 0);
 
+// Same as findRouteSegment for every point but roads are indexed once in context grid (RouteSegmentGrid),
+// so dense points (GPX tracks) don't project on every road of tiles around them.
+// k - max number of nearest roads for point (found point and others), 0 - all roads around point
+void findRouteSegments(const vector<int_pair>& points, RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentPoint>>& res,
+					   int k = 0);
+
 vector<SHARED_PTR<RouteSegmentResult> > searchRouteInternal(RoutingContext* ctx, bool leftSideNavigation);
+// Time-dependent sweep: calculates route between start and target of context for every departure time.
+// Tiles are loaded once with conditional tags kept symbolic (see RoutingContext::conditionalSweep) and only search
+// is repeated with conditions of departure time, so loaded data and router caches are shared by all departures.
+// Returns routing time (seconds) for every departure time, -1 if route isn't found.
+vector<float> searchRouteSweep(RoutingContext* ctx, const vector<time_t>& departureTimes,
+							   vector<vector<SHARED_PTR<RouteSegmentResult>>>* routes = nullptr);
 vector<SHARED_PTR<RouteSegment>> searchRouteInternal(RoutingContext* ctx, SHARED_PTR<RouteSegmentPoint> start,
 													 SHARED_PTR<RouteSegmentPoint> end, const VISITED_MAP & boundaries, std::vector<int64_t> excludedKeys);
 
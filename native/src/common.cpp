@@ -137,7 +137,8 @@ double squareRootDist31(int x1, int y1, int x2, int y2) {
 
 // 14 precision, gives 10x speedup, 0.02% error
 double getTileWidth(int y31) {
-	static UNORDERED(map)<int, double> DIST_CACHE; // cache (static) TODO location: global (heap) or local (static-heap)
+	// per thread: routing contexts could work in parallel (chunked GPX approximation)
+	static thread_local UNORDERED(map)<int, double> DIST_CACHE;
 	const int PRECISION_ZOOM = 14; // 16 doesn't fit into tile int
 
 	double y = y31 / 1.0 / (1 << (31 - PRECISION_ZOOM));
@@ -0,0 +1,19 @@
+#ifndef _OSMAND_ELEVATION_PROVIDER_CPP
+#define _OSMAND_ELEVATION_PROVIDER_CPP
+
+#include "elevationProvider.h"
+
+static std::mutex elevationProviderMutex;
+static SHARED_PTR<ElevationProvider> elevationProvider;
+
+void ElevationProvider::setInstance(const SHARED_PTR<ElevationProvider>& provider) {
+	std::lock_guard<std::mutex> lock(elevationProviderMutex);
+	elevationProvider = provider;
+}
+
+SHARED_PTR<ElevationProvider> ElevationProvider::getInstance() {
+	std::lock_guard<std::mutex> lock(elevationProviderMutex);
+	return elevationProvider;
+}
+
+#endif /*_OSMAND_ELEVATION_PROVIDER_CPP*/
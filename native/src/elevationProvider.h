@@ -0,0 +1,24 @@
+#ifndef _OSMAND_ELEVATION_PROVIDER_H
+#define _OSMAND_ELEVATION_PROVIDER_H
+
+#include <mutex>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+// Source of heights for roads which have no elevation tags in map (e.g. DEM files).
+// Single provider is registered for the process and it is used by all routing contexts,
+// no provider is registered by default.
+class ElevationProvider {
+   public:
+	virtual ~ElevationProvider() {}
+
+	// Heights (meters) of points given in 31 coordinates, returns false if some point has no data
+	virtual bool getHeights(const std::vector<uint32_t>& x31, const std::vector<uint32_t>& y31,
+							std::vector<double>& heights) = 0;
+
+	static void setInstance(const SHARED_PTR<ElevationProvider>& provider);
+	static SHARED_PTR<ElevationProvider> getInstance();
+};
+
+#endif /*_OSMAND_ELEVATION_PROVIDER_H*/
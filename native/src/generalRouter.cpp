@@ -96,6 +96,31 @@ GeneralRouter::GeneralRouter(const GeneralRouter& parent, const MAP_STR_STR& par
 	}
 }
 
+SHARED_PTR<GeneralRouter> GeneralRouter::clone() {
+	SHARED_PTR<GeneralRouter> r = build(parameterValues);
+	// values could be changed after build (JNI)
+	r->_restrictionsAware = _restrictionsAware;
+	r->heightObstacles = heightObstacles;
+	r->sharpTurn = sharpTurn;
+	r->shortWaySharpTurn = shortWaySharpTurn;
+	r->slightTurn = slightTurn;
+	r->shortWaySlightTurn = shortWaySlightTurn;
+	r->roundaboutTurn = roundaboutTurn;
+	r->shortWayRoundaboutTurn = shortWayRoundaboutTurn;
+	r->minSpeed = minSpeed;
+	r->defaultSpeed = defaultSpeed;
+	r->maxSpeed = maxSpeed;
+	r->maxVehicleSpeed = maxVehicleSpeed;
+	r->impassableRoadIds = impassableRoadIds;
+	r->shortestRoute = shortestRoute;
+	r->allowPrivate = allowPrivate;
+	r->checkAllowPrivateNeeded = checkAllowPrivateNeeded;
+	r->profileName = profileName;
+	r->fileName = fileName;
+	r->hhNativeFilter = hhNativeFilter;
+	return r;
+}
+
 float parseFloat(MAP_STR_STR attributes, string key, float def) {
 	if (attributes.find(key) != attributes.end() && attributes[key] != "") {
 		return strtod_li(attributes[key]);
@@ -427,6 +427,9 @@ class GeneralRouter {
 		return SHARED_PTR<GeneralRouter>(new GeneralRouter(*this, params));
 	}
 
+	// Configured copy for another thread (evaluation caches are not shared)
+	SHARED_PTR<GeneralRouter> clone();
+
 	GeneralRouterProfile getProfile() {
 		return profile;
 	}
@@ -0,0 +1,228 @@
+#include "gpxChunkedApproximation.h"
+
+#include <chrono>
+
+#include "binaryRoutePlanner.h"
+#include "gpxRouteApproximation.h"
+#include "routeCalculationProgress.h"
+#include "routePlannerFrontEnd.h"
+#include "routeTileCache.h"
+
+// Progress of worker context: cancellation comes only from coordinating thread
+// (progress of approximation could be implemented in Java and can't be called from workers)
+struct GpxChunkProgress : RouteCalculationProgress {
+    std::atomic<bool>& interrupted;
+
+    GpxChunkProgress(std::atomic<bool>& interrupted) : interrupted(interrupted) {}
+
+    bool isCancelled() override { return interrupted.load(); }
+};
+
+GpxChunkedApproximation::GpxChunkedApproximation(RoutePlannerFrontEnd* router,
+                                                 SHARED_PTR<GpxRouteApproximation>& gctx,
+                                                 std::vector<SHARED_PTR<GpxPoint>>& gpxPoints)
+    :
+    router{router},
+    gctx{gctx},
+    gpxPoints{gpxPoints},
+    interrupted{false},
+    nextChunk{0},
+    runningWorkers{0},
+    approximatedDistance{0} {
+}
+
+bool GpxChunkedApproximation::isConfidentAnchor(const SHARED_PTR<GpxPoint>& p) {
+    float minPointApproximation = gctx->ctx->config->minPointApproximation;
+    SHARED_PTR<RouteSegmentPoint> rsp = findRouteSegment(get31TileNumberX(p->lon), get31TileNumberY(p->lat),
+                                                         gctx->ctx);
+    if (rsp == nullptr) {
+        return false;
+    }
+    LatLon point = rsp->getPreciseLatLon();
+    if (getDistance(point.lat, point.lon, p->lat, p->lon) > minPointApproximation / 2) {
+        return false;
+    }
+    // no other road (junction, parallel road) which could be chosen instead
+    for (const SHARED_PTR<RouteSegmentPoint>& o : rsp->others) {
+        if (o->getRoad()->getId() == rsp->getRoad()->getId()) {
+            continue;
+        }
+        LatLon other = o->getPreciseLatLon();
+        if (getDistance(other.lat, other.lon, p->lat, p->lon) < minPointApproximation) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GpxChunkedApproximation::addChunk(int start, int end) {
+    GpxChunk chunk;
+    chunk.start = start;
+    chunk.end = end;
+    std::vector<std::pair<double, double>> locations;
+    for (int k = start; k <= end; k++) {
+        locations.push_back(std::make_pair(gpxPoints[k]->lat, gpxPoints[k]->lon));
+    }
+    // geometry based algorithms use gpx direction by local index
+    SHARED_PTR<RouteDataObject> object = RoutePlannerFrontEnd::generateStraightLineSegment(0, locations)->object;
+    for (int k = start; k <= end; k++) {
+        const SHARED_PTR<GpxPoint>& p = gpxPoints[k];
+        SHARED_PTR<GpxPoint> cp = std::make_shared<GpxPoint>(k - start, p->lat, p->lon, p->cumDist);
+        cp->x31 = p->x31;
+        cp->y31 = p->y31;
+        cp->object = object;
+        chunk.points.push_back(cp);
+    }
+    chunks.push_back(chunk);
+}
+
+void GpxChunkedApproximation::splitChunks() {
+    int size = (int)gpxPoints.size();
+    float chunkLength = gctx->ctx->config->gpxApproximationChunkLength;
+    float minPointApproximation = gctx->ctx->config->minPointApproximation;
+    double total = gpxPoints[size - 1]->cumDist;
+    int start = 0;
+    int i = 0;
+    while (!gctx->ctx->progress->isCancelled()) {
+        while (i < size && gpxPoints[i]->cumDist - gpxPoints[start]->cumDist < chunkLength) {
+            i++;
+        }
+        // chunk becomes longer until confident point is found, last chunk is not shorter than half of length
+        int anchor = -1;
+        double checked = -1;
+        for (; i < size && total - gpxPoints[i]->cumDist > chunkLength / 2; i++) {
+            if (checked >= 0 && gpxPoints[i]->cumDist - checked < minPointApproximation) {
+                continue;
+            }
+            checked = gpxPoints[i]->cumDist;
+            if (isConfidentAnchor(gpxPoints[i])) {
+                anchor = i;
+                break;
+            }
+        }
+        if (anchor < 0) {
+            break;
+        }
+        addChunk(start, anchor);
+        start = anchor;
+        i = anchor + 1;
+    }
+    addChunk(start, size - 1);
+}
+
+void GpxChunkedApproximation::runWorker(RoutingContext* ctx) {
+    while (!interrupted) {
+        uint i = nextChunk++;
+        if (i >= chunks.size()) {
+            break;
+        }
+        GpxChunk& chunk = chunks[i];
+        chunk.gctx = std::make_shared<GpxRouteApproximation>(ctx);
+        chunk.gctx->setRouter(router);
+        router->approximateGpxPoints(chunk.gctx, chunk.points);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            approximatedDistance += chunk.points[chunk.points.size() - 1]->cumDist - chunk.points[0]->cumDist;
+        }
+        stateCondition.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        runningWorkers--;
+    }
+    stateCondition.notify_one();
+}
+
+void GpxChunkedApproximation::mergeChunk(GpxChunk& chunk) {
+    int last = (int)chunk.points.size() - 1;
+    for (int k = 0; k <= last; k++) {
+        if (k == last && chunk.end < (int)gpxPoints.size() - 1) {
+            break; // anchor is approximated as start of next chunk
+        }
+        SHARED_PTR<GpxPoint>& p = chunk.points[k];
+        SHARED_PTR<GpxPoint>& target = gpxPoints[chunk.start + k];
+        target->pnt = p->pnt;
+        target->straightLine = p->straightLine;
+        target->targetInd = p->targetInd < 0 ? -1 : p->targetInd + chunk.start;
+        target->routeToTarget = p->routeToTarget;
+        for (SHARED_PTR<RouteSegmentResult>& r : target->routeToTarget) {
+            if (r->getGpxPointIndex() >= 0) {
+                r->setGpxPointIndex(r->getGpxPointIndex() + chunk.start);
+            }
+        }
+    }
+    gctx->routeCalculations += chunk.gctx->routeCalculations;
+    gctx->routePointsSearched += chunk.gctx->routePointsSearched;
+    gctx->routeDistCalculations += chunk.gctx->routeDistCalculations;
+}
+
+void GpxChunkedApproximation::gpxApproximation() {
+    RoutingContext* ctx = gctx->ctx;
+    int threads = ctx->config->gpxApproximationThreads;
+    // direction points are changed while tiles are loaded, so they can't be shared by threads
+    if (threads > 1 && gpxPoints.size() > 1 && ctx->config->directionPoints.count() == 0 &&
+        ctx->config->gpxApproximationChunkLength > 0) {
+        splitChunks();
+    }
+    if (chunks.size() < 2 || ctx->progress->isCancelled()) {
+        chunks.clear();
+        router->approximateGpxPoints(gctx, gpxPoints);
+        return;
+    }
+    OsmAnd::ElapsedTimer timer;
+    timer.Start();
+    threads = std::min(threads, (int)chunks.size());
+    ctx->progress->updateTotalApproximateDistance(gpxPoints[gpxPoints.size() - 1]->cumDist);
+    tileCache = std::make_shared<RouteTileCache>(ctx->config->memoryLimitation);
+
+    // decoding rules are built before workers start, workers search them in prepareResult
+    for (BinaryMapFile* file : ctx->mapIndexReaderFilter.empty() ? getOpenMapFiles() : ctx->mapIndexReaderFilter) {
+        for (auto& routingIndex : file->routingIndexes) {
+            routingIndex->initDecodingRules();
+        }
+    }
+    // contexts are prepared here as they copy main context
+    std::vector<SHARED_PTR<RoutingContext>> contexts;
+    for (int t = 0; t < threads; t++) {
+        SHARED_PTR<RoutingConfiguration> config = std::make_shared<RoutingConfiguration>(*ctx->config);
+        config->router = ctx->config->router->clone();
+        config->prefetchTiles = 0;
+        SHARED_PTR<RoutingContext> wctx = std::make_shared<RoutingContext>(ctx);
+        wctx->config = config;
+        wctx->progress = std::make_shared<GpxChunkProgress>(interrupted);
+        wctx->tileCache = tileCache;
+        wctx->mapIndexReaderFilter = ctx->mapIndexReaderFilter;
+        contexts.push_back(wctx);
+    }
+    std::vector<std::thread> workers;
+    runningWorkers = threads;
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread(&GpxChunkedApproximation::runWorker, this, contexts[t].get()));
+    }
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (runningWorkers > 0) {
+            stateCondition.wait_for(lock, std::chrono::milliseconds(100));
+            double distance = approximatedDistance;
+            lock.unlock();
+            // progress is checked and updated only by this (calling) thread
+            if (ctx->progress->isCancelled()) {
+                interrupted = true;
+            }
+            ctx->progress->updateApproximatedDistance(distance);
+            lock.lock();
+        }
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+    if (!interrupted) {
+        for (GpxChunk& chunk : chunks) {
+            mergeChunk(chunk);
+        }
+    }
+    OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
+                      "Native Chunked Approximation took %.2f seconds (%d chunks, %d threads, tiles decoded %d, shared %d)",
+                      static_cast<double>(timer.GetElapsedMs()) / 1000.0, (int)chunks.size(), threads,
+                      tileCache->misses, tileCache->hits);
+}
@@ -0,0 +1,57 @@
+#ifndef _OSMAND_GPX_CHUNKED_APPROXIMATION_H
+#define _OSMAND_GPX_CHUNKED_APPROXIMATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+class RoutePlannerFrontEnd;
+class RouteTileCache;
+struct GpxPoint;
+struct GpxRouteApproximation;
+struct RoutingContext;
+
+// Approximates long tracks in parallel (config gpxApproximationThreads > 1).
+// Track is split into chunks of ~gpxApproximationChunkLength at anchor points matched close to a single road,
+// so chunks on both sides of the anchor find the same road point. Every chunk is approximated by selected
+// algorithm on a worker thread with own routing context (tiles are decoded once into shared RouteTileCache)
+// and results are written back to gpxPoints, so calculateGpxRouteResult() stitches them as usual.
+class GpxChunkedApproximation {
+    struct GpxChunk {
+        int start;
+        int end; // anchor (first point of next chunk) or last point of track
+        std::vector<SHARED_PTR<GpxPoint>> points;
+        SHARED_PTR<GpxRouteApproximation> gctx;
+    };
+
+public:
+    GpxChunkedApproximation(RoutePlannerFrontEnd* router, SHARED_PTR<GpxRouteApproximation>& gctx,
+                            std::vector<SHARED_PTR<GpxPoint>>& gpxPoints);
+    void gpxApproximation();
+
+private:
+    RoutePlannerFrontEnd* router;
+    SHARED_PTR<GpxRouteApproximation>& gctx;
+    std::vector<SHARED_PTR<GpxPoint>>& gpxPoints;
+    std::vector<GpxChunk> chunks;
+    SHARED_PTR<RouteTileCache> tileCache;
+
+    std::atomic<bool> interrupted;
+    std::atomic<uint> nextChunk;
+    std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    int runningWorkers;
+    double approximatedDistance;
+
+    void splitChunks();
+    bool isConfidentAnchor(const SHARED_PTR<GpxPoint>& p);
+    void addChunk(int start, int end);
+    void runWorker(RoutingContext* ctx);
+    void mergeChunk(GpxChunk& chunk);
+};
+
+#endif
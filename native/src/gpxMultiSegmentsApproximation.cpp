@@ -235,7 +235,7 @@ bool GpxMultiSegmentsApproximation::initRoutingPoint(const SHARED_PTR<GpxPoint>&
     if (start != nullptr && start->pnt == nullptr) {
         gctx->routePointsSearched++;
         double gpxDir = start->object->directionRoute(start->ind, true);
-        SHARED_PTR<RouteSegmentPoint> rsp = findRouteSegment(start->x31, start->y31, gctx->ctx);
+        SHARED_PTR<RouteSegmentPoint> rsp = gctx->snapGpxPoint(gpxPoints, start);
         if (rsp == nullptr || getDistance(get31LatitudeY(rsp->preciseY), get31LongitudeX(rsp->preciseX),
                                           start->lat, start->lon) > distThreshold) {
             return false;
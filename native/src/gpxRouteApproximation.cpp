@@ -35,9 +35,9 @@ void GpxRouteApproximation::searchGpxRouteByRouting(SHARED_PTR<GpxRouteApproxima
 		double routeDist = gctx->ctx->config->maxStepApproximation;
 		SHARED_PTR<GpxPoint> next = findNextGpxPointWithin(gpxPoints, start, routeDist);
 		bool routeFound = false;
-		if (next && initRoutingPoint(start, gctx, minPointApproximation)) {
+		if (next && initRoutingPoint(gpxPoints, start, gctx, minPointApproximation)) {
 			while (routeDist >= gctx->ctx->config->minStepApproximation && !routeFound) {
-				routeFound = initRoutingPoint(next, gctx, minPointApproximation);
+				routeFound = initRoutingPoint(gpxPoints, next, gctx, minPointApproximation);
 				if (routeFound) {
 					routeFound = findGpxRouteSegment(gctx, gpxPoints, start, next, prev != nullptr);
 					if (routeFound) {
@@ -105,11 +105,35 @@ void GpxRouteApproximation::searchGpxRouteByRouting(SHARED_PTR<GpxRouteApproxima
 //	}
 }
 
-bool GpxRouteApproximation::initRoutingPoint(SHARED_PTR<GpxPoint>& start, SHARED_PTR<GpxRouteApproximation>& gctx, double distThreshold) {
+// Snaps point together with next points of the track (consecutive points mostly need the same roads)
+SHARED_PTR<RouteSegmentPoint> GpxRouteApproximation::snapGpxPoint(const vector<SHARED_PTR<GpxPoint>>& gpxPoints,
+																  const SHARED_PTR<GpxPoint>& point) {
+	const auto it = snappedPoints.find(point->ind);
+	if (it != snappedPoints.end()) {
+		return it->second;
+	}
+	snappedPoints.clear();
+	vector<int_pair> points;
+	for (int i = point->ind; i < gpxPoints.size() && i - point->ind < SNAP_BATCH_POINTS; i++) {
+		const SHARED_PTR<GpxPoint>& p = gpxPoints[i];
+		if (i > point->ind && p->cumDist - point->cumDist > SNAP_BATCH_DISTANCE) {
+			break;
+		}
+		points.push_back(int_pair(get31TileNumberX(p->lon), get31TileNumberY(p->lat)));
+	}
+	vector<SHARED_PTR<RouteSegmentPoint>> res;
+	findRouteSegments(points, ctx, res);
+	for (int i = 0; i < res.size(); i++) {
+		snappedPoints[point->ind + i] = res[i];
+	}
+	return res.empty() ? nullptr : res[0];
+}
+
+bool GpxRouteApproximation::initRoutingPoint(const vector<SHARED_PTR<GpxPoint>>& gpxPoints, SHARED_PTR<GpxPoint>& start,
+											 SHARED_PTR<GpxRouteApproximation>& gctx, double distThreshold) {
 	if (start && !start->pnt) {
 		gctx->routePointsSearched++;
-		SHARED_PTR<RouteSegmentPoint> rsp = findRouteSegment(get31TileNumberX(start->lon), get31TileNumberY(start->lat),
-		                                                     gctx->ctx);
+		SHARED_PTR<RouteSegmentPoint> rsp = gctx->snapGpxPoint(gpxPoints, start);
 		if (rsp) {
 			LatLon point = rsp->getPreciseLatLon();
 			if (getDistance(point.lat, point.lon, start->lat, start->lon) < distThreshold) {
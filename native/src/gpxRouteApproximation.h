@@ -6,11 +6,16 @@
 
 struct RoutingIndex;
 struct RouteSegmentResult;
+struct RouteSegmentPoint;
 struct GpxPoint;
 struct RoutingContext;
 class RoutePlannerFrontEnd;
 
 struct GpxRouteApproximation {
+	// gpx points snapped to roads at once (by number and distance from the first one)
+	const static int SNAP_BATCH_POINTS = 64;
+	constexpr static double SNAP_BATCH_DISTANCE = 1000;
+
 	RoutingContext* ctx = nullptr;
 	RoutePlannerFrontEnd* router = nullptr;
 	int routeCalculations = 0;
@@ -18,6 +23,8 @@ struct GpxRouteApproximation {
 	int routeDistCalculations = 0;
 	vector<SHARED_PTR<GpxPoint>> finalPoints;
 	vector<SHARED_PTR<RouteSegmentResult>> fullRoute;
+	// road points of current batch of gpx points by index
+	UNORDERED(map)<int, SHARED_PTR<RouteSegmentPoint>> snappedPoints;
 
 	// Used only in Java:
 	// int routeDistance = 0;
@@ -40,7 +47,9 @@ struct GpxRouteApproximation {
 	                      vector<SHARED_PTR<RouteSegmentResult>>& res);
 	bool isRouteCloseToGpxPoints(float minPointApproximation, vector<SHARED_PTR<GpxPoint>>& gpxPoints,
 	                         SHARED_PTR<GpxPoint>& start, SHARED_PTR<GpxPoint>& next);
-	bool initRoutingPoint(SHARED_PTR<GpxPoint>& start, SHARED_PTR<GpxRouteApproximation>& gctx, double distThreshold);
+	SHARED_PTR<RouteSegmentPoint> snapGpxPoint(const vector<SHARED_PTR<GpxPoint>>& gpxPoints, const SHARED_PTR<GpxPoint>& point);
+	bool initRoutingPoint(const vector<SHARED_PTR<GpxPoint>>& gpxPoints, SHARED_PTR<GpxPoint>& start,
+						  SHARED_PTR<GpxRouteApproximation>& gctx, double distThreshold);
 	SHARED_PTR<GpxPoint> findNextGpxPointWithin(vector<SHARED_PTR<GpxPoint>>& gpxPoints, SHARED_PTR<GpxPoint>& start,
 												double dist);
 	bool findGpxRouteSegment(SHARED_PTR<GpxRouteApproximation>& gctx, vector<SHARED_PTR<GpxPoint>>& gpxPoints,
@@ -136,7 +136,7 @@ SHARED_PTR<GpxPoint> GpxSimplePointsMatchApproximation::findNextRoutablePoint(Ro
                                                                      std::vector<SHARED_PTR<GpxPoint>>& gpxPoints,
                                                                      int searchStart) {
     for (int i = searchStart; i < gpxPoints.size(); i++) {
-        if (gctx->initRoutingPoint(gpxPoints.at(i), gctx, distThreshold)) {
+        if (gctx->initRoutingPoint(gpxPoints, gpxPoints.at(i), gctx, distThreshold)) {
             return gpxPoints.at(i);
         }
     }
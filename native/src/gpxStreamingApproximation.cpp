@@ -0,0 +1,120 @@
+#include "gpxStreamingApproximation.h"
+
+#include "gpxRouteApproximation.h"
+#include "routeCalculationProgress.h"
+#include "routePlannerFrontEnd.h"
+#include "routeSegment.h"
+#include "routeSegmentResult.h"
+#include "routingContext.h"
+
+GpxStreamingApproximation::GpxStreamingApproximation(RoutePlannerFrontEnd* router, RoutingContext* ctx,
+                                                     double lagDistance, GpxStreamingCallback acceptor)
+    :
+    router{router},
+    ctx{ctx},
+    lagDistance{lagDistance},
+    acceptor{acceptor},
+    nextApproximationDist{2 * lagDistance},
+    emittedDistance{0} {
+    if (!ctx->progress) {
+        ctx->progress = std::make_shared<RouteCalculationProgress>();
+    }
+}
+
+void GpxStreamingApproximation::addPoint(double lat, double lon) {
+    double cumDist = 0;
+    if (!window.empty()) {
+        const StreamPoint& prev = window.back();
+        cumDist = prev.cumDist + getDistance(lat, lon, prev.lat, prev.lon);
+    }
+    window.push_back({lat, lon, cumDist});
+    if (cumDist >= nextApproximationDist) {
+        approximateWindow(false);
+        // window is not approximated again until lagDistance / 2 is added (nothing could be settled)
+        nextApproximationDist = std::max(window.front().cumDist + 2 * lagDistance, cumDist + lagDistance / 2);
+    }
+}
+
+void GpxStreamingApproximation::finish() {
+    approximateWindow(true);
+    window.clear();
+}
+
+// Returns last point of window which is the end of route leg (or straight line) and is lagDistance behind
+// the last point, 0 if there is no such point
+int GpxStreamingApproximation::findSettledPoint(const std::vector<SHARED_PTR<GpxPoint>>& points, bool flush,
+                                                bool& straightEnd) {
+    int last = (int)points.size() - 1;
+    straightEnd = false;
+    if (flush) {
+        return last;
+    }
+    double limit = points[last]->cumDist - lagDistance;
+    int settled = 0;
+    for (int i = 0; i < last;) {
+        bool straight = points[i]->routeToTarget.empty();
+        int next = straight ? i + 1 : points[i]->targetInd;
+        if (next <= i || next > last) {
+            break;
+        }
+        if (points[next]->cumDist > limit) {
+            // long leg shouldn't keep the window forever
+            if (settled == 0 && points[last]->cumDist - points[0]->cumDist > MAX_WINDOW_LAGS * lagDistance) {
+                settled = next;
+                straightEnd = straight;
+            }
+            break;
+        }
+        settled = next;
+        straightEnd = straight;
+        i = next;
+    }
+    return settled;
+}
+
+void GpxStreamingApproximation::approximateWindow(bool flush) {
+    if (window.size() < 2) {
+        return;
+    }
+    std::vector<std::pair<double, double>> locations;
+    for (const StreamPoint& s : window) {
+        locations.push_back(std::make_pair(s.lat, s.lon));
+    }
+    SHARED_PTR<RouteDataObject> object = RoutePlannerFrontEnd::generateStraightLineSegment(0, locations)->object;
+    std::vector<SHARED_PTR<GpxPoint>> points;
+    double startDist = window.front().cumDist;
+    for (uint k = 0; k < window.size(); k++) {
+        const StreamPoint& s = window[k];
+        SHARED_PTR<GpxPoint> p = std::make_shared<GpxPoint>(k, s.lat, s.lon, s.cumDist - startDist);
+        p->object = object;
+        points.push_back(p);
+    }
+    SHARED_PTR<GpxRouteApproximation> gctx = std::make_shared<GpxRouteApproximation>(ctx);
+    gctx->setRouter(router);
+    router->approximateGpxPoints(gctx, points);
+    if (ctx->progress->isCancelled()) {
+        return;
+    }
+    bool straightEnd;
+    int settled = findSettledPoint(points, flush, straightEnd);
+    if (settled == 0) {
+        return;
+    }
+    // settled point starts the next window and its leg is approximated again with the following points,
+    // it is kept only as the end of straight line to connect geometry
+    if (!flush) {
+        points.resize(straightEnd ? settled + 1 : settled);
+        if (straightEnd) {
+            points.back()->routeToTarget.clear();
+            points.back()->targetInd = -1;
+        }
+    }
+    SHARED_PTR<GpxRouteApproximation> result = std::make_shared<GpxRouteApproximation>(ctx);
+    result->setRouter(router);
+    result->calculateGpxRouteResult(result, points);
+    if (!result->fullRoute.empty()) {
+        acceptor(result->fullRoute);
+    }
+    emittedDistance += window[settled].cumDist - startDist;
+    window.erase(window.begin(), window.begin() + settled);
+}
@@ -0,0 +1,57 @@
+#ifndef _OSMAND_GPX_STREAMING_APPROXIMATION_H
+#define _OSMAND_GPX_STREAMING_APPROXIMATION_H
+
+#include <deque>
+#include <functional>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+class RoutePlannerFrontEnd;
+struct GpxPoint;
+struct RouteSegmentResult;
+struct RoutingContext;
+
+typedef std::function<void(const std::vector<SHARED_PTR<RouteSegmentResult>>& segments)> GpxStreamingCallback;
+
+// Incremental approximation of live track (points are added one by one).
+// Only last part of track (window) is kept: when it becomes 2 * lagDistance long, it is approximated by
+// selected algorithm and route legs which end more than lagDistance behind the last point are settled -
+// route is emitted to acceptor and points before the end of the last settled leg are dropped.
+// Every window is approximated by new GpxRouteApproximation, so memory doesn't grow with the track
+// (tiles of routing context are limited by its memory limit).
+class GpxStreamingApproximation {
+    // window longer than this number of lag distances is settled up to the first leg end
+    static constexpr double MAX_WINDOW_LAGS = 4;
+
+    struct StreamPoint {
+        double lat;
+        double lon;
+        double cumDist;
+    };
+
+public:
+    GpxStreamingApproximation(RoutePlannerFrontEnd* router, RoutingContext* ctx, double lagDistance,
+                              GpxStreamingCallback acceptor);
+
+    void addPoint(double lat, double lon);
+    // approximates and emits the rest of track
+    void finish();
+
+    int getWindowSize() const { return (int)window.size(); }
+    double getEmittedDistance() const { return emittedDistance; }
+
+private:
+    RoutePlannerFrontEnd* router;
+    RoutingContext* ctx;
+    double lagDistance;
+    GpxStreamingCallback acceptor;
+    std::deque<StreamPoint> window;
+    double nextApproximationDist;
+    double emittedDistance;
+
+    void approximateWindow(bool flush);
+    int findSettledPoint(const std::vector<SHARED_PTR<GpxPoint>>& points, bool flush, bool& straightEnd);
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include "heightmapKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HEIGHTMAP_KERNELS_X86
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HEIGHTMAP_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// Scalar reference kernels (also used for the tails of vectorized ones)
+
+inline void blendHillshadeScalar(const uint8_t* shade, const uint8_t* slope, uint8_t* blend, const uint32_t count)
+{
+    for (uint32_t idx = 0; idx < count; idx++)
+        blend[idx] = shade[idx] != 0 ? (static_cast<uint32_t>(shade[idx]) * slope[idx] >> 8) + 1 : 0;
+}
+
+inline void mergeHeightsScalar(float* destination, const float* source, const uint32_t count,
+    const float scaleFactor, const bool forceReplace, const float noData)
+{
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        if (forceReplace || destination[idx] == noData)
+        {
+            const auto src = source[idx];
+            destination[idx] = src == noData ? noData : src * scaleFactor;
+        }
+    }
+}
+
+inline void convertToBytesScalar(const float* values, uint8_t* bytes, const uint32_t count)
+{
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        const auto value = values[idx];
+        bytes[idx] = std::isnan(value) ? 0 : static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+    }
+}
+
+#if defined(HEIGHTMAP_KERNELS_X86)
+
+TARGET_SSE41 static void blendHillshadeSSE41(const uint8_t* shade, const uint8_t* slope, uint8_t* blend,
+    const uint32_t count)
+{
+    const auto zero = _mm_setzero_si128();
+    const auto one = _mm_set1_epi16(1);
+    uint32_t idx = 0;
+    for (; idx + 16 <= count; idx += 16)
+    {
+        const auto hs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shade + idx));
+        const auto sp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slope + idx));
+        // Products of bytes fit in 16 bits
+        const auto lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(
+            _mm_cvtepu8_epi16(hs), _mm_cvtepu8_epi16(sp)), 8), one);
+        const auto hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(
+            _mm_unpackhi_epi8(hs, zero), _mm_unpackhi_epi8(sp, zero)), 8), one);
+        const auto result = _mm_andnot_si128(_mm_cmpeq_epi8(hs, zero), _mm_packus_epi16(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(blend + idx), result);
+    }
+    blendHillshadeScalar(shade + idx, slope + idx, blend + idx, count - idx);
+}
+
+TARGET_AVX2 static void blendHillshadeAVX2(const uint8_t* shade, const uint8_t* slope, uint8_t* blend,
+    const uint32_t count)
+{
+    const auto zero = _mm256_setzero_si256();
+    const auto one = _mm256_set1_epi16(1);
+    uint32_t idx = 0;
+    for (; idx + 32 <= count; idx += 32)
+    {
+        const auto hs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shade + idx));
+        const auto sp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slope + idx));
+        const auto lo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(hs)),
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(sp))), 8), one);
+        const auto hi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(hs, 1)),
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(sp, 1))), 8), one);
+        // Packing works within 128-bit lanes, so restore order of 64-bit parts
+        const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        const auto result = _mm256_andnot_si256(_mm256_cmpeq_epi8(hs, zero), packed);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(blend + idx), result);
+    }
+    blendHillshadeScalar(shade + idx, slope + idx, blend + idx, count - idx);
+}
+
+TARGET_SSE41 static void mergeHeightsSSE41(float* destination, const float* source, const uint32_t count,
+    const float scaleFactor, const bool forceReplace, const float noData)
+{
+    const auto noDataValues = _mm_set1_ps(noData);
+    const auto scale = _mm_set1_ps(scaleFactor);
+    const auto force = forceReplace ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_setzero_ps();
+    uint32_t idx = 0;
+    for (; idx + 4 <= count; idx += 4)
+    {
+        const auto dst = _mm_loadu_ps(destination + idx);
+        const auto src = _mm_loadu_ps(source + idx);
+        const auto value = _mm_blendv_ps(_mm_mul_ps(src, scale), noDataValues, _mm_cmpeq_ps(src, noDataValues));
+        const auto replace = _mm_or_ps(force, _mm_cmpeq_ps(dst, noDataValues));
+        _mm_storeu_ps(destination + idx, _mm_blendv_ps(dst, value, replace));
+    }
+    mergeHeightsScalar(destination + idx, source + idx, count - idx, scaleFactor, forceReplace, noData);
+}
+
+TARGET_AVX2 static void mergeHeightsAVX2(float* destination, const float* source, const uint32_t count,
+    const float scaleFactor, const bool forceReplace, const float noData)
+{
+    const auto noDataValues = _mm256_set1_ps(noData);
+    const auto scale = _mm256_set1_ps(scaleFactor);
+    const auto force = forceReplace ? _mm256_castsi256_ps(_mm256_set1_epi32(-1)) : _mm256_setzero_ps();
+    uint32_t idx = 0;
+    for (; idx + 8 <= count; idx += 8)
+    {
+        const auto dst = _mm256_loadu_ps(destination + idx);
+        const auto src = _mm256_loadu_ps(source + idx);
+        const auto value = _mm256_blendv_ps(_mm256_mul_ps(src, scale), noDataValues,
+            _mm256_cmp_ps(src, noDataValues, _CMP_EQ_OQ));
+        const auto replace = _mm256_or_ps(force, _mm256_cmp_ps(dst, noDataValues, _CMP_EQ_OQ));
+        _mm256_storeu_ps(destination + idx, _mm256_blendv_ps(dst, value, replace));
+    }
+    mergeHeightsScalar(destination + idx, source + idx, count - idx, scaleFactor, forceReplace, noData);
+}
+
+TARGET_SSE41 static void convertToBytesSSE41(const float* values, uint8_t* bytes, const uint32_t count)
+{
+    const auto zero = _mm_setzero_ps();
+    const auto maxValue = _mm_set1_ps(255.0f);
+    const auto half = _mm_set1_ps(0.5f);
+    uint32_t idx = 0;
+    for (; idx + 16 <= count; idx += 16)
+    {
+        __m128i parts[4];
+        for (int i = 0; i < 4; i++)
+        {
+            // maxps returns the second operand for NaN
+            const auto value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + idx + i * 4), zero), maxValue);
+            parts[i] = _mm_cvttps_epi32(_mm_add_ps(value, half));
+        }
+        const auto result = _mm_packus_epi16(_mm_packs_epi32(parts[0], parts[1]), _mm_packs_epi32(parts[2], parts[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + idx), result);
+    }
+    convertToBytesScalar(values + idx, bytes + idx, count - idx);
+}
+
+#elif defined(HEIGHTMAP_KERNELS_NEON)
+
+static void blendHillshadeNEON(const uint8_t* shade, const uint8_t* slope, uint8_t* blend, const uint32_t count)
+{
+    const auto one = vdup_n_u8(1);
+    uint32_t idx = 0;
+    for (; idx + 8 <= count; idx += 8)
+    {
+        const auto hs = vld1_u8(shade + idx);
+        const auto result = vadd_u8(vshrn_n_u16(vmull_u8(hs, vld1_u8(slope + idx)), 8), one);
+        vst1_u8(blend + idx, vand_u8(result, vtst_u8(hs, hs)));
+    }
+    blendHillshadeScalar(shade + idx, slope + idx, blend + idx, count - idx);
+}
+
+static void mergeHeightsNEON(float* destination, const float* source, const uint32_t count,
+    const float scaleFactor, const bool forceReplace, const float noData)
+{
+    const auto noDataValues = vdupq_n_f32(noData);
+    const auto force = vdupq_n_u32(forceReplace ? 0xFFFFFFFF : 0);
+    uint32_t idx = 0;
+    for (; idx + 4 <= count; idx += 4)
+    {
+        const auto dst = vld1q_f32(destination + idx);
+        const auto src = vld1q_f32(source + idx);
+        const auto value = vbslq_f32(vceqq_f32(src, noDataValues), noDataValues, vmulq_n_f32(src, scaleFactor));
+        const auto replace = vorrq_u32(force, vceqq_f32(dst, noDataValues));
+        vst1q_f32(destination + idx, vbslq_f32(replace, value, dst));
+    }
+    mergeHeightsScalar(destination + idx, source + idx, count - idx, scaleFactor, forceReplace, noData);
+}
+
+static void convertToBytesNEON(const float* values, uint8_t* bytes, const uint32_t count)
+{
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto maxValue = vdupq_n_f32(255.0f);
+    const auto half = vdupq_n_f32(0.5f);
+    uint32_t idx = 0;
+    for (; idx + 8 <= count; idx += 8)
+    {
+        uint16x4_t parts[2];
+        for (int i = 0; i < 2; i++)
+        {
+            const auto value = vld1q_f32(values + idx + i * 4);
+            const auto clamped = vminq_f32(vmaxq_f32(value, zero), maxValue);
+            // NaN is not equal to itself
+            const auto converted = vandq_u32(vcvtq_u32_f32(vaddq_f32(clamped, half)), vceqq_f32(value, value));
+            parts[i] = vmovn_u32(converted);
+        }
+        vst1_u8(bytes + idx, vmovn_u16(vcombine_u16(parts[0], parts[1])));
+    }
+    convertToBytesScalar(values + idx, bytes + idx, count - idx);
+}
+
+#endif
+
+static KernelsLevel getSupportedKernelsLevel()
+{
+#if defined(HEIGHTMAP_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return KernelsLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return KernelsLevel::SSE41;
+    return KernelsLevel::Scalar;
+#elif defined(HEIGHTMAP_KERNELS_NEON)
+    return KernelsLevel::NEON;
+#else
+    return KernelsLevel::Scalar;
+#endif
+}
+
+static std::atomic<KernelsLevel>& kernelsLevel()
+{
+    static std::atomic<KernelsLevel> level(getSupportedKernelsLevel());
+    return level;
+}
+
+KernelsLevel getKernelsLevel()
+{
+    return kernelsLevel().load();
+}
+
+void setKernelsLevel(const KernelsLevel level)
+{
+    const auto supported = getSupportedKernelsLevel();
+    if (level == KernelsLevel::Scalar || level == supported ||
+        (level == KernelsLevel::SSE41 && supported == KernelsLevel::AVX2))
+        kernelsLevel().store(level);
+}
+
+void blendHillshadeKernel(const uint8_t* shade, const uint8_t* slope, uint8_t* blend, const uint32_t count)
+{
+    switch (getKernelsLevel())
+    {
+#if defined(HEIGHTMAP_KERNELS_X86)
+        case KernelsLevel::AVX2:
+            blendHillshadeAVX2(shade, slope, blend, count);
+            return;
+        case KernelsLevel::SSE41:
+            blendHillshadeSSE41(shade, slope, blend, count);
+            return;
+#elif defined(HEIGHTMAP_KERNELS_NEON)
+        case KernelsLevel::NEON:
+            blendHillshadeNEON(shade, slope, blend, count);
+            return;
+#endif
+        default:
+            blendHillshadeScalar(shade, slope, blend, count);
+    }
+}
+
+void mergeHeightsKernel(float* destination, const float* source, const uint32_t count, const float scaleFactor,
+    const bool forceReplace, const float noData)
+{
+    switch (getKernelsLevel())
+    {
+#if defined(HEIGHTMAP_KERNELS_X86)
+        case KernelsLevel::AVX2:
+            mergeHeightsAVX2(destination, source, count, scaleFactor, forceReplace, noData);
+            return;
+        case KernelsLevel::SSE41:
+            mergeHeightsSSE41(destination, source, count, scaleFactor, forceReplace, noData);
+            return;
+#elif defined(HEIGHTMAP_KERNELS_NEON)
+        case KernelsLevel::NEON:
+            mergeHeightsNEON(destination, source, count, scaleFactor, forceReplace, noData);
+            return;
+#endif
+        default:
+            mergeHeightsScalar(destination, source, count, scaleFactor, forceReplace, noData);
+    }
+}
+
+void convertToBytesKernel(const float* values, uint8_t* bytes, const uint32_t count)
+{
+    switch (getKernelsLevel())
+    {
+#if defined(HEIGHTMAP_KERNELS_X86)
+        case KernelsLevel::AVX2:
+        case KernelsLevel::SSE41:
+            // Conversion is limited by packing, AVX2 doesn't help
+            convertToBytesSSE41(values, bytes, count);
+            return;
+#elif defined(HEIGHTMAP_KERNELS_NEON)
+        case KernelsLevel::NEON:
+            convertToBytesNEON(values, bytes, count);
+            return;
+#endif
+        default:
+            convertToBytesScalar(values, bytes, count);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef _OSMAND_HEIGHTMAP_KERNELS_H
+#define _OSMAND_HEIGHTMAP_KERNELS_H
+
+#include <cstdint>
+
+// Pixel kernels of terrain rasters. Every kernel has scalar reference implementation and vectorized ones
+// (SSE4.1 or AVX2 selected at runtime on x86, NEON on ARM) which give the same result bit-for-bit.
+enum class KernelsLevel
+{
+	Scalar,
+	SSE41,
+	AVX2,
+	NEON
+};
+
+KernelsLevel getKernelsLevel();
+// Selects kernels (e.g. scalar reference), level not supported by CPU is ignored
+void setKernelsLevel(const KernelsLevel level);
+
+// blend = shade != 0 ? (shade * slope >> 8) + 1 : 0
+void blendHillshadeKernel(const uint8_t* shade, const uint8_t* slope, uint8_t* blend, const uint32_t count);
+// Replaces no-data (or all if forceReplace) destination values by scaled source values, no-data isn't scaled
+void mergeHeightsKernel(float* destination, const float* source, const uint32_t count, const float scaleFactor,
+	const bool forceReplace, const float noData);
+// bytes = value is NaN ? 0 : value (clamped to 0..255) rounded
+void convertToBytesKernel(const float* values, uint8_t* bytes, const uint32_t count);
+
+#endif /*_OSMAND_HEIGHTMAP_KERNELS_H*/
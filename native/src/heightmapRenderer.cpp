@@ -1,20 +1,20 @@
 #include "heightmapRenderer.h"
+#include "heightmapKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
 
 #ifndef TIFF_NODATA
 #define TIFF_NODATA (-32768.0)
 #endif
 
-inline uint64_t multiplyParts(const uint64_t shade, const uint64_t slope)
-{
-    const uint64_t mask0 = 0xFFULL;
-    const uint64_t mask1 = 0xFF0000ULL;
-    const uint64_t mask2 = 0xFF00000000ULL;
-    const uint64_t mask3 = 0xFF000000000000ULL;
-    return ((shade & mask0) != 0 ? (shade & mask0) * (slope & mask0) + 0x0100ULL : 0) |
-        ((shade & mask1) != 0 ? (shade & mask1) * ((slope & mask1) >> 16) + 0x01000000ULL : 0) |
-        ((shade & mask2) != 0 ? (shade & mask2) * ((slope & mask2) >> 32) + 0x010000000000ULL : 0) |
-        ((shade & mask3) != 0 ? (shade & mask3) * (slope >> 48) + 0x0100000000000000ULL : 0);
-}
+#ifndef SLOPE_NODATA
+#define SLOPE_NODATA (-9999.0)
+#endif
 
 inline void blendHillshade(
     const uint32_t tileSize,
@@ -22,35 +22,8 @@ inline void blendHillshade(
     char* slope,
     char* blend)
 {
-    if ((tileSize & 7) > 0)
-    {
-        // Simple pixel-by-pixel blending
-        const auto pixelCount = tileSize * tileSize;
-        for (uint32_t idx = 0; idx < pixelCount; idx++)
-            blend[idx] =
-                shade[idx] != 0 ? (static_cast<ushort>(shade[idx]) * static_cast<ushort>(slope[idx]) >> 8) + 1 : 0;
-    }
-    else
-    {
-        // Optimized blending
-        const uint64_t bigMask = 0xFF00FF00FF00FF00ULL;
-        const uint64_t litMask = 0x00FF00FF00FF00FFULL;
-        const auto quadCount = tileSize * tileSize / 8;
-        auto pShade = reinterpret_cast<uint64_t*>(shade);
-        auto pSlope = reinterpret_cast<uint64_t*>(slope);
-        auto pBlend = reinterpret_cast<uint64_t*>(blend);
-        for (int i = 0; i < quadCount; i++)
-        {
-            auto quad = *pShade++;
-            auto hsb = (quad & bigMask) >> 8;
-            auto hsl = quad & litMask;
-            quad = *pSlope++;
-            auto spb = (quad & bigMask) >> 8;
-            auto spl = quad & litMask;
-            *pBlend = (multiplyParts(hsb, spb) & bigMask) | (multiplyParts(hsl, spl) >> 8 & litMask);
-            pBlend++;
-        }
-    }
+    blendHillshadeKernel(reinterpret_cast<const uint8_t*>(shade), reinterpret_cast<const uint8_t*>(slope),
+        reinterpret_cast<uint8_t*>(blend), tileSize * tileSize);
 }
 
 inline void mergeHeights(
@@ -59,16 +32,234 @@ inline void mergeHeights(
     const bool forceReplace,
     char* destination,
     float* source)
+{
+    mergeHeightsKernel(reinterpret_cast<float*>(destination), source, tileSize * tileSize, scaleFactor,
+        forceReplace, static_cast<float>(TIFF_NODATA));
+}
+
+std::shared_ptr<const ColorRamp> getColorRamp(const std::string& filename)
+{
+    static std::mutex rampsMutex;
+    static std::unordered_map<std::string, std::pair<time_t, std::shared_ptr<const ColorRamp>>> ramps;
+
+    struct stat fileStat;
+    if (stat(filename.c_str(), &fileStat) != 0)
+    {
+        OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Color file %s is not found", filename.c_str());
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(rampsMutex);
+    auto& cached = ramps[filename];
+    if (cached.second && cached.first == fileStat.st_mtime)
+        return cached.second;
+
+    std::vector<std::pair<double, uint32_t>> entries;
+    auto ramp = std::make_shared<ColorRamp>();
+    ramp->hasNoDataColor = false;
+    ramp->noDataColor = 0;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> tokens;
+        size_t start = line.find_first_not_of(" ,\t:\r");
+        while (start != std::string::npos)
+        {
+            const auto end = line.find_first_of(" ,\t:\r", start);
+            tokens.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            start = end == std::string::npos ? end : line.find_first_not_of(" ,\t:\r", end);
+        }
+        if (tokens.size() < 4 || tokens[0][0] == '#')
+            continue;
+        uint8_t rgba[4] = { 0, 0, 0, 255 };
+        for (int i = 0; i < 4 && i + 1 < tokens.size(); i++)
+            rgba[i] = static_cast<uint8_t>(std::min(std::max(atoi(tokens[i + 1].c_str()), 0), 255));
+        uint32_t color;
+        memcpy(&color, rgba, sizeof(color));
+        if (tokens[0] == "nv")
+        {
+            ramp->hasNoDataColor = true;
+            ramp->noDataColor = color;
+        }
+        else if (tokens[0].back() == '%')
+            OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Warning, "Relative value %s of color file %s is skipped",
+                tokens[0].c_str(), filename.c_str());
+        else
+            entries.push_back(std::make_pair(atof(tokens[0].c_str()), color));
+    }
+    if (entries.empty())
+    {
+        OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Color file %s has no colors", filename.c_str());
+        return nullptr;
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) { return a.first < b.first; });
+    for (const auto& entry : entries)
+    {
+        ramp->values.push_back(entry.first);
+        ramp->colors.push_back(entry.second);
+    }
+    for (int value = 0; value < 256; value++)
+        ramp->byteColors[value] = getRampColor(*ramp, value);
+    cached = std::make_pair(fileStat.st_mtime, ramp);
+    return ramp;
+}
+
+uint32_t getRampColor(const ColorRamp& ramp, const double value)
+{
+    // Linear interpolation between colors (as gdaldem color-relief does by default)
+    const auto& values = ramp.values;
+    const auto i = std::lower_bound(values.begin(), values.end(), value) - values.begin();
+    if (i == 0)
+        return ramp.colors.front();
+    if (i == values.size())
+        return ramp.colors.back();
+    if (values[i - 1] == value)
+        return ramp.colors[i - 1];
+    const double ratio = (value - values[i - 1]) / (values[i] - values[i - 1]);
+    uint8_t lower[4], upper[4], rgba[4];
+    memcpy(lower, &ramp.colors[i - 1], sizeof(lower));
+    memcpy(upper, &ramp.colors[i], sizeof(upper));
+    for (int c = 0; c < 4; c++)
+    {
+        const int component = static_cast<int>(0.45 + lower[c] + ratio * (upper[c] - lower[c]));
+        rgba[c] = static_cast<uint8_t>(std::min(std::max(component, 0), 255));
+    }
+    uint32_t color;
+    memcpy(&color, rgba, sizeof(color));
+    return color;
+}
+
+// Horn's gradients of heights for count pixels of a row (pointers are at the left neighbour of the first
+// pixel in rows above, at and below), gradient of pixel with no-data neighbour is NaN. Loop is branchless to be vectorized.
+inline void computeGradients(
+    const float* top,
+    const float* middle,
+    const float* bottom,
+    const uint32_t count,
+    float* dx,
+    float* dy)
 {
     const auto noData = static_cast<float>(TIFF_NODATA);
-    auto result = reinterpret_cast<float*>(destination);
-    const auto valueCount = tileSize * tileSize;
-    for (uint32_t idx = 0; idx < valueCount; idx++)
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    for (uint32_t i = 0; i < count; i++)
     {
-        if (forceReplace || result[idx] == noData)
+        const float a0 = top[i], a1 = top[i + 1], a2 = top[i + 2];
+        const float a3 = middle[i], a4 = middle[i + 1], a5 = middle[i + 2];
+        const float a6 = bottom[i], a7 = bottom[i + 1], a8 = bottom[i + 2];
+        const bool valid = (a0 != noData) & (a1 != noData) & (a2 != noData) & (a3 != noData) & (a4 != noData) &
+            (a5 != noData) & (a6 != noData) & (a7 != noData) & (a8 != noData);
+        dx[i] = valid ? (a0 + a3 + a3 + a6) - (a2 + a5 + a5 + a8) : nan;
+        dy[i] = valid ? (a6 + a7 + a7 + a8) - (a0 + a1 + a1 + a2) : nan;
+    }
+}
+
+// Applies kernel to the rows of gradients of size x size part of tile at (offset, offset).
+// Pixels at the tile edges have no gradient (as gdaldem without -compute_edges).
+template<typename F>
+inline void processGradients(
+    const float* heights,
+    const uint32_t tileSize,
+    const uint32_t offset,
+    const uint32_t size,
+    F kernel)
+{
+    std::vector<float> dx(size);
+    std::vector<float> dy(size);
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    const uint32_t first = offset == 0 ? 1 : 0;
+    const uint32_t last = std::min(size, tileSize - 1 - offset);
+    for (uint32_t row = 0; row < size; row++)
+    {
+        const auto y = offset + row;
+        std::fill(dx.begin(), dx.end(), nan);
+        if (y > 0 && y < tileSize - 1 && first < last)
+        {
+            const auto pRow = heights + y * tileSize + offset + first - 1;
+            computeGradients(pRow - tileSize, pRow, pRow + tileSize, last - first, &dx[first], &dy[first]);
+        }
+        kernel(row, dx.data(), dy.data());
+    }
+}
+
+void computeSlope(
+    const float* heights,
+    const uint32_t tileSize,
+    const uint32_t offset,
+    const uint32_t size,
+    const PointD& resolution,
+    float* slope)
+{
+    // Slope in degrees (gdaldem slope)
+    const auto noData = static_cast<float>(SLOPE_NODATA);
+    const auto invEW = static_cast<float>(1.0 / resolution.x);
+    const auto invNS = static_cast<float>(1.0 / resolution.y);
+    const auto radiansToDegrees = static_cast<float>(180.0 / M_PI);
+    processGradients(heights, tileSize, offset, size,
+        [&](const uint32_t row, const float* dx, const float* dy)
+        {
+            auto pSlope = slope + row * size;
+            for (uint32_t i = 0; i < size; i++)
+            {
+                const float x = dx[i] * invEW;
+                const float y = dy[i] * invNS;
+                pSlope[i] = std::isnan(x) ? noData : std::atan(std::sqrt(x * x + y * y) / 8.0f) * radiansToDegrees;
+            }
+        });
+}
+
+void computeHillshade(
+    const float* heights,
+    const uint32_t tileSize,
+    const uint32_t offset,
+    const uint32_t size,
+    const PointD& resolution,
+    const double zFactor,
+    char* shade)
+{
+    // Hillshade lit from the default direction (gdaldem hillshade: azimuth 315, altitude 45), 0 is no-data
+    const double azimuth = 315.0 * M_PI / 180.0;
+    const double altitude = 45.0 * M_PI / 180.0;
+    const double z = zFactor / 8.0;
+    const auto invEW = static_cast<float>(1.0 / resolution.x);
+    const auto invNS = static_cast<float>(1.0 / resolution.y);
+    const auto sinAlt = static_cast<float>(254.0 * std::sin(altitude));
+    const auto cosAz = static_cast<float>(254.0 * std::cos(azimuth) * std::cos(altitude) * z);
+    const auto sinAz = static_cast<float>(254.0 * std::sin(azimuth) * std::cos(altitude) * z);
+    const auto squareZ = static_cast<float>(z * z);
+    std::vector<float> values(size);
+    processGradients(heights, tileSize, offset, size,
+        [&](const uint32_t row, const float* dx, const float* dy)
+        {
+            for (uint32_t i = 0; i < size; i++)
+            {
+                const float x = dx[i] * invEW;
+                const float y = dy[i] * invNS;
+                const float cang = (sinAlt - (y * cosAz - x * sinAz)) / std::sqrt(1.0f + squareZ * (x * x + y * y));
+                // NaN (no-data) stays NaN
+                values[i] = cang <= 0.0f ? 1.0f : 1.0f + cang;
+            }
+            convertToBytesKernel(values.data(), reinterpret_cast<uint8_t*>(shade + row * size), size);
+        });
+}
+
+inline void colorize(
+    const ColorRamp& ramp,
+    const float* source,
+    const uint32_t sourceStride,
+    const uint32_t size,
+    const float noData,
+    void* pBuffer)
+{
+    auto pColor = reinterpret_cast<uint32_t*>(pBuffer);
+    const auto noDataColor = ramp.hasNoDataColor ? ramp.noDataColor : 0;
+    for (uint32_t row = 0; row < size; row++)
+    {
+        const auto pSource = source + row * sourceStride;
+        for (uint32_t i = 0; i < size; i++)
         {
-            const auto src = source[idx];
-            result[idx] = src == noData ? noData : src * scaleFactor;
+            const auto value = pSource[i];
+            *pColor++ = value == noData ? noDataColor : getRampColor(ramp, value);
         }
     }
 }
@@ -78,190 +269,269 @@ inline bool postProcess(
     const ProcessingParameters& procParameters,
     const uint32_t tileSize,
     const uint32_t overlap,
-    const PointD& tileOrigin,
     const PointD& tileResolution,
-    const int gcpCount,
-    const void* gcpList,
     void* pBuffer)
 {
+    const auto resultColors = getColorRamp(procParameters.resultColorsFilename);
+    if (!resultColors)
+        return false;
+
+    const auto heights = reinterpret_cast<const float*>(pByteBuffer);
+    const auto resultOffset = overlap / 2;
+    const auto resultSize = tileSize - overlap;
+    const auto resultLength = resultSize * resultSize;
+    if (procParameters.rasterType == RasterType::Height)
+    {
+        // Produce colorized height raster
+        colorize(*resultColors, heights + resultOffset * tileSize + resultOffset, tileSize, resultSize,
+            static_cast<float>(TIFF_NODATA), pBuffer);
+        return true;
+    }
+
+    // Prepare common slope raster
     bool result = false;
-    char dataPointer[24];
-    auto pCharBuffer = const_cast<char*>(pByteBuffer);
-    auto pGCPList = reinterpret_cast<const GDAL_GCP*>(gcpList);
-    dataPointer[CPLPrintPointer(dataPointer, pCharBuffer, 23)] = 0;
-    auto filename = new char[1024];
-    sprintf(filename,
-        "MEM:::DATATYPE=Float32,DATAPOINTER=%s,PIXELS=%d,LINES=%d,GEOTRANSFORM=%.17g/%.17g/0.0/%.17g/0.0/%.17g",
-        dataPointer, tileSize, tileSize, tileOrigin.x, tileResolution.x, tileOrigin.y, tileResolution.y);
-    if (const auto heightmapDataset = (GDALDataset*) GDALOpen(filename, GA_ReadOnly))
+    auto slope = new float[resultLength];
+    computeSlope(heights, tileSize, resultOffset, resultSize, tileResolution, slope);
+    if (procParameters.rasterType == RasterType::Hillshade)
     {
-        auto band = heightmapDataset->GetRasterBand(1);
-        if (procParameters.rasterType == RasterType::Height)
+        // Compose hybrid hillshade raster
+        if (const auto intermediateColors = getColorRamp(procParameters.intermediateColorsFilename))
         {
-            // Produce colorized height raster
-            if (band && heightmapDataset->SetGCPs(gcpCount, pGCPList, "") == CE_None)
+            const auto noData = static_cast<float>(SLOPE_NODATA);
+            const auto noDataColor = intermediateColors->hasNoDataColor ? intermediateColors->noDataColor : 0;
+            auto gsBuffer = new char[resultLength];
+            for (uint32_t idx = 0; idx < resultLength; idx++)
             {
-                band->SetNoDataValue(TIFF_NODATA);
-                char outputFormat[] = "MEM";
-                const char* colorizeArgs[] = { "-of", outputFormat, "-alpha", NULL };
-                if (GDALDEMProcessingOptions* colorizeOptions = GDALDEMProcessingOptionsNew(
-                    const_cast<char **>(colorizeArgs), NULL))
-                {
-                    const auto resultDataset = (GDALDataset*) GDALDEMProcessing(
-                        outputFormat,
-                        heightmapDataset,
-                        "color-relief",
-                        procParameters.resultColorsFilename.c_str(),
-                        colorizeOptions,
-                        nullptr);
-                    if (resultDataset)
-                    {
-                        const auto resultOffset = overlap / 2;
-                        const auto resultSize = tileSize - overlap;
-                        result = resultDataset->RasterIO(GF_Read,
-                            resultOffset, resultOffset, resultSize, resultSize,
-                            pBuffer, resultSize, resultSize, GDT_Byte, 4, nullptr,
-                            4, resultSize * 4, 1, nullptr) == CE_None;
-                        GDALClose(resultDataset);
-                    }
-                    GDALDEMProcessingOptionsFree(colorizeOptions);
-                }
+                // Grayscale is the red component of intermediate colors
+                const auto color = slope[idx] == noData ? noDataColor : getRampColor(*intermediateColors, slope[idx]);
+                gsBuffer[idx] = reinterpret_cast<const char*>(&color)[0];
             }
+            auto hsBuffer = new char[resultLength];
+            computeHillshade(heights, tileSize, resultOffset, resultSize, tileResolution, 2.0, hsBuffer);
+            auto mixBuffer = new char[resultLength];
+            blendHillshade(resultSize, hsBuffer, gsBuffer, mixBuffer);
+            auto pColor = reinterpret_cast<uint32_t*>(pBuffer);
+            for (uint32_t idx = 0; idx < resultLength; idx++)
+                pColor[idx] = resultColors->byteColors[static_cast<uint8_t>(mixBuffer[idx])];
+            delete[] mixBuffer;
+            delete[] hsBuffer;
+            delete[] gsBuffer;
+            result = true;
         }
-        else if (band && heightmapDataset->SetGCPs(gcpCount, pGCPList, "") == CE_None)
+    }
+    else // RasterType::Slope
+    {
+        // Produce colorized slope raster
+        colorize(*resultColors, slope, resultSize, resultSize, static_cast<float>(SLOPE_NODATA), pBuffer);
+        result = true;
+    }
+    delete[] slope;
+    return result;
+}
+
+GeotiffDataset::GeotiffDataset(GDALDataset* dataset, off_t fileSize, time_t fileModified)
+    : dataset(dataset)
+    , fileSize(fileSize)
+    , fileModified(fileModified)
+{
+    rasterBandCount = dataset->GetRasterCount();
+    rasterSize = PointI(dataset->GetRasterXSize(), dataset->GetRasterYSize());
+    hasGeoTransform = dataset->GetGeoTransform(geoTransform) == CE_None;
+}
+
+GeotiffDataset::~GeotiffDataset()
+{
+    GDALClose(dataset);
+}
+
+GeotiffDatasetCache::GeotiffDatasetCache()
+{
+}
+
+GeotiffDatasetCache& GeotiffDatasetCache::getInstance()
+{
+    static GeotiffDatasetCache instance;
+    return instance;
+}
+
+bool GeotiffDatasetCache::exists(const std::string& filePath)
+{
+    const auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        const auto it = existingFiles.find(filePath);
+        if (it != existingFiles.end() && (it->second.first || now < it->second.second))
+            return it->second.first;
+    }
+    struct stat fileStat;
+    const bool fileExists = stat(filePath.c_str(), &fileStat) == 0;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    existingFiles[filePath] = std::make_pair(fileExists, now + std::chrono::seconds(MISSING_FILE_TIMEOUT_SEC));
+    return fileExists;
+}
+
+std::shared_ptr<GeotiffDataset> GeotiffDatasetCache::get(const std::string& filePath)
+{
+    struct stat fileStat;
+    const bool fileExists = stat(filePath.c_str(), &fileStat) == 0;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        const auto it = datasets.find(filePath);
+        if (it != datasets.end())
         {
-            band->SetNoDataValue(TIFF_NODATA);
-            // Prepare common slope raster
-            char outputFormat[] = "MEM";
-            const char* slopeArgs[] = { "-of", outputFormat, NULL };
-            if (GDALDEMProcessingOptions* slopeOptions = GDALDEMProcessingOptionsNew(
-                const_cast<char **>(slopeArgs), NULL))
+            const auto& geotiff = it->second.first;
+            if (fileExists && geotiff->fileSize == fileStat.st_size && geotiff->fileModified == fileStat.st_mtime)
             {
-                if (const auto slopeDataset = (GDALDataset*) GDALDEMProcessing(outputFormat, heightmapDataset,
-                    "slope", nullptr, slopeOptions, nullptr))
-                {
-                    if (procParameters.rasterType == RasterType::Hillshade)
-                    {
-                        // Compose hybrid hillshade raster
-                        const char* hillshadeArgs[] = { "-of", outputFormat, "-z", "2", NULL };
-                        if (GDALDEMProcessingOptions* hillshadeOptions = GDALDEMProcessingOptionsNew(
-                            const_cast<char **>(hillshadeArgs), NULL))
-                        {
-                            const auto hillshadeDataset = (GDALDataset*) GDALDEMProcessing(
-                                outputFormat,
-                                heightmapDataset,
-                                "hillshade",
-                                nullptr,
-                                hillshadeOptions,
-                                nullptr);
-                            if (hillshadeDataset)
-                            {
-                                const auto grayscaleDataset = (GDALDataset*) GDALDEMProcessing(
-                                    outputFormat,
-                                    slopeDataset,
-                                    "color-relief",
-                                    procParameters.intermediateColorsFilename.c_str(),
-                                    slopeOptions,
-                                    nullptr);
-                                if (grayscaleDataset)
-                                {
-                                    const auto resultOffset = overlap / 2;
-                                    const auto resultSize = tileSize - overlap;
-                                    const auto resultLength = resultSize * resultSize;
-                                    auto gsBuffer = new char[resultLength];
-                                    GDALRasterBand* gsBand = grayscaleDataset->GetRasterBand(1);
-                                    if (gsBand->RasterIO(GF_Read, resultOffset, resultOffset, resultSize, resultSize,
-                                        gsBuffer, resultSize, resultSize, GDT_Byte, 0, 0, nullptr) == CE_None)
-                                    {
-                                        auto hsBuffer = new char[resultLength];
-                                        GDALRasterBand* band = hillshadeDataset->GetRasterBand(1);
-                                        if (band->RasterIO(GF_Read, resultOffset, resultOffset, resultSize, resultSize,
-                                            hsBuffer, resultSize, resultSize, GDT_Byte, 0, 0, nullptr) == CE_None)
-                                        {
-                                            auto mixBuffer = new char[resultLength];
-                                            blendHillshade(resultSize, hsBuffer, gsBuffer, mixBuffer);
-                                            dataPointer[CPLPrintPointer(dataPointer, mixBuffer, 23)] = 0;
-                                            sprintf(filename,"MEM:::DATATYPE=Byte,DATAPOINTER=%s,PIXELS=%d,LINES=%d,"
-                                                "GEOTRANSFORM=%.17g/%.17g/0.0/%.17g/0.0/%.17g",
-                                                dataPointer, resultSize, resultSize,
-                                                tileOrigin.x, tileResolution.x, tileOrigin.y, tileResolution.y);
-                                            if (const auto mixDataset = (GDALDataset*) GDALOpen(filename, GA_ReadOnly))
-                                            {
-                                                if (mixDataset->SetGCPs(gcpCount, pGCPList, "") == CE_None)
-                                                {
-                                                    const char* colorizeArgs[] = {"-of", outputFormat, "-alpha", NULL};
-                                                    if (GDALDEMProcessingOptions* colorizeOptions =
-                                                        GDALDEMProcessingOptionsNew(
-                                                        const_cast<char **>(colorizeArgs), NULL))
-                                                    {
-                                                        const auto resultDataset = (GDALDataset*) GDALDEMProcessing(
-                                                            outputFormat,
-                                                            mixDataset,
-                                                            "color-relief",
-                                                            procParameters.resultColorsFilename.c_str(),
-                                                            colorizeOptions,
-                                                            nullptr);
-                                                        if (resultDataset)
-                                                        {
-                                                            result = resultDataset->RasterIO(GF_Read,
-                                                                0, 0, resultSize, resultSize,
-                                                                pBuffer, resultSize, resultSize, GDT_Byte, 4, nullptr,
-                                                                4, resultSize * 4, 1, nullptr) == CE_None;
-                                                            GDALClose(resultDataset);                                                        
-                                                        }
-                                                        GDALDEMProcessingOptionsFree(colorizeOptions);
-                                                    }
-                                                }
-                                                GDALClose(mixDataset);
-                                            }
-                                            delete[] mixBuffer;
-                                        }
-                                        delete[] hsBuffer;
-                                    }
-                                    delete[] gsBuffer;
-                                    GDALClose(grayscaleDataset);
-                                }
-                                GDALClose(hillshadeDataset);
-                            }
-                            GDALDEMProcessingOptionsFree(hillshadeOptions);
-                        }
-                    }
-                    else // RasterType::Slope
-                    {
-                        // Produce colorized slope raster
-                        const char* colorizeArgs[] = { "-of", outputFormat, "-alpha", NULL };
-                        if (GDALDEMProcessingOptions* colorizeOptions = GDALDEMProcessingOptionsNew(
-                            const_cast<char **>(colorizeArgs), NULL))
-                        {
-                            const auto resultDataset = (GDALDataset*) GDALDEMProcessing(
-                                outputFormat,
-                                slopeDataset,
-                                "color-relief",
-                                procParameters.resultColorsFilename.c_str(),
-                                colorizeOptions,
-                                nullptr);
-                            if (resultDataset)
-                            {
-                                const auto resultOffset = overlap / 2;
-                                const auto resultSize = tileSize - overlap;
-                                result = resultDataset->RasterIO(GF_Read,
-                                    resultOffset, resultOffset, resultSize, resultSize,
-                                    pBuffer, resultSize, resultSize, GDT_Byte, 4, nullptr,
-                                    4, resultSize * 4, 1, nullptr) == CE_None;
-                                GDALClose(resultDataset);
-                            }
-                            GDALDEMProcessingOptionsFree(colorizeOptions);
-                        }
-                    }
-                    GDALClose(slopeDataset);
-                }
-                GDALDEMProcessingOptionsFree(slopeOptions);
+                recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->second.second);
+                return geotiff;
             }
+            // File is replaced or removed: dataset is closed when the last reader releases it
+            recentlyUsed.erase(it->second.second);
+            datasets.erase(it);
+        }
+        if (!fileExists)
+        {
+            existingFiles[filePath] =
+                std::make_pair(false, Clock::now() + std::chrono::seconds(MISSING_FILE_TIMEOUT_SEC));
+            return nullptr;
         }
-        GDALClose(heightmapDataset);
     }
-    delete[] filename;
-    return result;
+    // Open file without lock (file opened concurrently by other thread is closed when it is not used)
+    const auto dataset = (GDALDataset*) GDALOpen(filePath.c_str(), GA_ReadOnly);
+    if (!dataset)
+        return nullptr;
+    auto geotiff = std::make_shared<GeotiffDataset>(dataset, fileStat.st_size, fileStat.st_mtime);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const auto it = datasets.find(filePath);
+    if (it != datasets.end())
+    {
+        if (it->second.first->fileSize == geotiff->fileSize && it->second.first->fileModified == geotiff->fileModified)
+            return it->second.first;
+        recentlyUsed.erase(it->second.second);
+        datasets.erase(it);
+    }
+    recentlyUsed.push_front(filePath);
+    datasets[filePath] = std::make_pair(geotiff, recentlyUsed.begin());
+    while (datasets.size() > MAX_DATASETS)
+    {
+        // Dataset is closed when the last reader releases it
+        datasets.erase(recentlyUsed.back());
+        recentlyUsed.pop_back();
+    }
+    return geotiff;
+}
+
+void GeotiffDatasetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    datasets.clear();
+    recentlyUsed.clear();
+    existingFiles.clear();
+}
+
+GeotiffElevationProvider::GeotiffElevationProvider(const std::string& tilePath)
+    : tilePath(tilePath)
+{
+}
+
+std::shared_ptr<const GeotiffElevationProvider::HeightBlock> GeotiffElevationProvider::getBlock(
+    const std::string& filePath, GeotiffDataset& geotiff, int blockX, int blockY)
+{
+    const auto key = filePath + ":" + std::to_string(blockX) + ":" + std::to_string(blockY);
+    {
+        std::lock_guard<std::mutex> lock(blocksMutex);
+        const auto it = blocks.find(key);
+        if (it != blocks.end())
+        {
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->second.second);
+            return it->second.first;
+        }
+    }
+    auto block = std::make_shared<HeightBlock>();
+    block->blockX = blockX;
+    block->blockY = blockY;
+    block->width = std::min(BLOCK_SIZE, geotiff.rasterSize.x - blockX * BLOCK_SIZE);
+    const auto height = std::min(BLOCK_SIZE, geotiff.rasterSize.y - blockY * BLOCK_SIZE);
+    if (block->width <= 0 || height <= 0 || geotiff.rasterBandCount < 1)
+        return nullptr;
+    block->values.resize(block->width * height);
+    {
+        std::lock_guard<std::mutex> datasetLock(geotiff.mutex);
+        const auto band = geotiff.dataset->GetRasterBand(1);
+        if (!band || band->RasterIO(GF_Read, blockX * BLOCK_SIZE, blockY * BLOCK_SIZE, block->width, height,
+            block->values.data(), block->width, height, GDT_Float32, 0, 0, nullptr) != CE_None)
+            return nullptr;
+        int hasNoData = 0;
+        const auto noData = static_cast<float>(band->GetNoDataValue(&hasNoData));
+        if (hasNoData)
+            std::replace(block->values.begin(), block->values.end(), noData,
+                std::numeric_limits<float>::quiet_NaN());
+    }
+    std::lock_guard<std::mutex> lock(blocksMutex);
+    const auto it = blocks.find(key);
+    if (it != blocks.end())
+        return it->second.first;
+    recentlyUsed.push_front(key);
+    blocks[key] = std::make_pair(block, recentlyUsed.begin());
+    while (blocks.size() > MAX_BLOCKS)
+    {
+        blocks.erase(recentlyUsed.back());
+        recentlyUsed.pop_back();
+    }
+    return block;
+}
+
+bool GeotiffElevationProvider::getHeights(const std::vector<uint32_t>& x31, const std::vector<uint32_t>& y31,
+    std::vector<double>& heights)
+{
+    auto& datasetCache = GeotiffDatasetCache::getInstance();
+    const auto tileShift = 31 - SOURCE_ZOOM;
+    std::string filePath;
+    std::shared_ptr<GeotiffDataset> geotiff;
+    std::shared_ptr<const HeightBlock> block;
+    const auto getValue = [&](const int x, const int y) -> float
+    {
+        const auto blockX = x / BLOCK_SIZE;
+        const auto blockY = y / BLOCK_SIZE;
+        if (!block || block->blockX != blockX || block->blockY != blockY)
+            block = getBlock(filePath, *geotiff, blockX, blockY);
+        return block ? block->values[(y - blockY * BLOCK_SIZE) * block->width + x - blockX * BLOCK_SIZE]
+            : std::numeric_limits<float>::quiet_NaN();
+    };
+    heights.resize(x31.size());
+    for (size_t i = 0; i < x31.size(); i++)
+    {
+        const auto path = tilePath + std::to_string(SOURCE_ZOOM) + "/" + std::to_string(x31[i] >> tileShift) +
+            "/" + std::to_string(y31[i] >> tileShift) + ".tif";
+        if (path != filePath)
+        {
+            filePath = path;
+            geotiff = datasetCache.exists(filePath) ? datasetCache.get(filePath) : nullptr;
+            block.reset();
+        }
+        if (!geotiff || !geotiff->hasGeoTransform || geotiff->geoTransform[2] != 0.0 ||
+            geotiff->geoTransform[4] != 0.0 || geotiff->rasterSize.x < 1 || geotiff->rasterSize.y < 1)
+            return false;
+        const auto geoTransform = geotiff->geoTransform;
+        const auto meters = metersFrom31(PointD(x31[i], y31[i]));
+        // Position relative to pixel centers
+        const auto px = std::min(std::max((meters.x - geoTransform[0]) / geoTransform[1] - 0.5, 0.0),
+            static_cast<double>(geotiff->rasterSize.x - 1));
+        const auto py = std::min(std::max((meters.y - geoTransform[3]) / geoTransform[5] - 0.5, 0.0),
+            static_cast<double>(geotiff->rasterSize.y - 1));
+        const auto x0 = static_cast<int>(px);
+        const auto y0 = static_cast<int>(py);
+        const auto x1 = std::min(x0 + 1, geotiff->rasterSize.x - 1);
+        const auto y1 = std::min(y0 + 1, geotiff->rasterSize.y - 1);
+        const auto fx = px - x0;
+        const auto fy = py - y0;
+        const double top = getValue(x0, y0) * (1.0 - fx) + getValue(x1, y0) * fx;
+        const double bottom = getValue(x0, y1) * (1.0 - fx) + getValue(x1, y1) * fx;
+        heights[i] = top * (1.0 - fy) + bottom * fy;
+        if (std::isnan(heights[i]))
+            return false;
+    }
+    return true;
 }
 
 bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::string& midColorFilename,
@@ -287,9 +557,6 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
 
     // Composite tiles can be made up of data from multiple files
     char* compositeTile = nullptr;
-    void* compositeGCPList = nullptr;
-    int compositeGCPCount;
-    PointD compositeOrigin;
     PointD compositeResolution;
     bool compose = false;
     bool atLeastOnePresent = false;
@@ -370,15 +637,15 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
 
     bool result = false;
     double noData = TIFF_NODATA;
+    auto& datasetCache = GeotiffDatasetCache::getInstance();
     for (int32_t y = startTile.y; y <= endTile.y; y ++)
     {
         for (int32_t x = startTile.x; x <= endTile.x; x ++)
         {
             const std::string filePath =
                 tilePath + std::to_string(minZoom) + "/" + std::to_string(x) + "/" + std::to_string(y) + ".tif";
-            if (FILE *file = fopen(filePath.c_str(), "r"))
+            if (datasetCache.exists(filePath))
             {
-                fclose(file);
                 available = true;
                 const int zoomShift = zoom - minZoom;
                 bool tileFound = true;
@@ -388,22 +655,20 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
                     bool empty = false;
 
                     result = false;
-                    if (const auto dataset = (GDALDataset*) GDALOpen(filePath.c_str(), GA_ReadOnly))
+                    if (const auto geotiff = datasetCache.get(filePath))
                     {
                         // Read raster data from source Geotiff file
-                        const auto rasterBandCount = dataset->GetRasterCount();
+                        const auto dataset = geotiff->dataset;
+                        const auto rasterBandCount = geotiff->rasterBandCount;
                         GDALRasterBand* band;
                         result = rasterBandCount > 0 && rasterBandCount < 10;
-                        double geoTransform[6];
-                        if (result && dataset->GetGeoTransform(geoTransform) == CE_None &&
+                        const auto geoTransform = geotiff->geoTransform;
+                        if (result && geotiff->hasGeoTransform &&
                             geoTransform[2] == 0.0 && geoTransform[4] == 0.0)
                         {
-                            const auto rasterSize = PointI(dataset->GetRasterXSize(), dataset->GetRasterYSize());
-                            const auto gcpCount = dataset->GetGCPCount();
-                            const auto gcpList = dataset->GetGCPs();
+                            const auto rasterSize = geotiff->rasterSize;
                             auto upperLeft = metersFrom31(upperLeftNative);
                             auto lowerRight = metersFrom31(lowerRightNative);
-                            const auto tileOrigin = upperLeft;
                             PointD tileResolution;
                             tileResolution.x = (lowerRight.x - upperLeft.x) / tileSize;
                             tileResolution.y = (lowerRight.y - upperLeft.y) / tileSize;
@@ -488,6 +753,7 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
                             auto pData = pByteBuffer;
                             int pShift = outRaster ? (tileOffset.y * tileSize + tileOffset.x) * pixelSizeInBytes : 0;
                             const auto side = tileSize * pixelSizeInBytes;
+                            std::unique_lock<std::mutex> datasetLock(geotiff->mutex);
                             for (int bandIndex = 1; bandIndex <= numOfBands; bandIndex++)
                             {
                                 result = result && (band = dataset->GetRasterBand(bandIndex));
@@ -506,6 +772,7 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
                                 if (!result) break;
                                 pData += bandSize;
                             }
+                            datasetLock.unlock();
                             // Hillshade/slope/height raster processing
                             if (procParameters)
                             {
@@ -523,12 +790,7 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
 
                                         if (!atLeastOnePresent)
                                         {
-                                            compositeOrigin = tileOrigin;
                                             compositeResolution = tileResolution;
-                                            compositeGCPCount = gcpCount;
-                                            const auto listSize = sizeof(GDAL_GCP) * gcpCount;
-                                            compositeGCPList = malloc(listSize);
-                                            memcpy(compositeGCPList, reinterpret_cast<const char*>(gcpList), listSize);
                                             atLeastOnePresent = true;
                                         }
                                     }
@@ -539,8 +801,8 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
                                 {
                                     // Produce hillshade/slope/height raster from heightmap data
                                     result = result && destDataType == GDT_Byte && bandCount == 4 &&
-                                        postProcess(pByteBuffer, *procParameters, tileSize, overlap, tileOrigin,
-                                            tileResolution, gcpCount, gcpList, pBuffer);                                
+                                        postProcess(pByteBuffer, *procParameters, tileSize, overlap,
+                                            tileResolution, pBuffer);                                
                                 }
                                 delete[] pByteBuffer;
                                 pByteBuffer = static_cast<char*>(pBuffer);
@@ -548,7 +810,6 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
                                     (destDataType == GDT_Byte ? 1 : (destDataType == GDT_Int16 ? 2 : 4));
                             }
                         }
-                        GDALClose(dataset);
                     }
                 }
             }
@@ -562,8 +823,8 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
         if (atLeastOnePresent)
         {
             // Produce hillshade/slope/height raster from heightmap data
-            result = postProcess(compositeTile, *procParameters, tileSize, overlap, compositeOrigin,
-                compositeResolution, compositeGCPCount, compositeGCPList, pBuffer);
+            result = postProcess(compositeTile, *procParameters, tileSize, overlap,
+                compositeResolution, pBuffer);
         }
         else if (incomplete)
         {
@@ -580,8 +841,5 @@ bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::s
     if (compositeTile)
         free(compositeTile);
 
-    if (compositeGCPList)
-        free(compositeGCPList);
-
     return result;
 }
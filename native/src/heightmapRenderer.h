@@ -3,11 +3,19 @@
 
 #include <string>
 #include <fstream>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
 #include <gdal_priv.h>
 #include <gdal_utils.h>
 #include <cpl_conv.h>
 
 #include "Logging.h"
+#include "elevationProvider.h"
 
 enum class RasterType
 {
@@ -72,7 +80,106 @@ inline static PointD metersFrom31(const PointD& location31)
 	return PointD(metersFrom31(location31.x), metersFrom31(earthIn31 - location31.y));
 }
 
-uint64_t multiplyParts(const uint64_t shade, const uint64_t slope);
+// Colors of gdaldem color-relief file (lines "value r g b [a]", "nv r g b [a]" is color of no-data).
+// Colors are RGBA bytes packed into uint32_t in memory order.
+struct ColorRamp
+{
+	std::vector<double> values;
+	std::vector<uint32_t> colors;
+	bool hasNoDataColor;
+	uint32_t noDataColor;
+	// Precomputed colors of byte raster values
+	uint32_t byteColors[256];
+};
+
+// Returns parsed color file, it is parsed again only when file is modified
+std::shared_ptr<const ColorRamp> getColorRamp(const std::string& filename);
+uint32_t getRampColor(const ColorRamp& ramp, const double value);
+void computeSlope(const float* heights, const uint32_t tileSize, const uint32_t offset, const uint32_t size,
+	const PointD& resolution, float* slope);
+void computeHillshade(const float* heights, const uint32_t tileSize, const uint32_t offset, const uint32_t size,
+	const PointD& resolution, const double zFactor, char* shade);
+
+// Opened source GeoTIFF file with its metadata, dataset is read by one thread at a time (under mutex)
+struct GeotiffDataset
+{
+	GDALDataset* dataset;
+	int rasterBandCount;
+	PointI rasterSize;
+	bool hasGeoTransform;
+	double geoTransform[6];
+	// size and modification time of opened file, dataset is reopened when file is replaced
+	off_t fileSize;
+	time_t fileModified;
+	std::mutex mutex;
+
+	GeotiffDataset(GDALDataset* dataset, off_t fileSize, time_t fileModified);
+	~GeotiffDataset();
+};
+
+// Neighbouring output tiles are made from the same source files, so limited number of recently used
+// files is kept open. Existence of files is cached too (missing files are checked again after a while).
+// Opened files are checked by size and modification time on every use, so updated or removed terrain
+// files are not read from stale datasets.
+class GeotiffDatasetCache
+{
+	const static int MAX_DATASETS = 16;
+	const static int MISSING_FILE_TIMEOUT_SEC = 30;
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::pair<std::shared_ptr<GeotiffDataset>, std::list<std::string>::iterator> CachedDataset;
+
+	std::mutex cacheMutex;
+	// most recently used first
+	std::list<std::string> recentlyUsed;
+	std::unordered_map<std::string, CachedDataset> datasets;
+	std::unordered_map<std::string, std::pair<bool, Clock::time_point>> existingFiles;
+
+	GeotiffDatasetCache();
+
+   public:
+	static GeotiffDatasetCache& getInstance();
+
+	bool exists(const std::string& filePath);
+	std::shared_ptr<GeotiffDataset> get(const std::string& filePath);
+	void clear();
+};
+
+// Heights for routing from the same GeoTIFF files (and opened datasets) as terrain rasters.
+// Heights are read from files by blocks which are kept in limited LRU cache, so roads of the same area
+// don't read files again. Height of point is bilinear interpolation of the nearest pixel centers.
+class GeotiffElevationProvider : public ElevationProvider
+{
+	const static int SOURCE_ZOOM = 9;
+	const static int BLOCK_SIZE = 256;
+	const static int MAX_BLOCKS = 64;
+
+	struct HeightBlock
+	{
+		int blockX;
+		int blockY;
+		int width;
+		// no-data is NaN
+		std::vector<float> values;
+	};
+	typedef std::pair<std::shared_ptr<const HeightBlock>, std::list<std::string>::iterator> CachedBlock;
+
+	std::string tilePath;
+	std::mutex blocksMutex;
+	// most recently used first
+	std::list<std::string> recentlyUsed;
+	std::unordered_map<std::string, CachedBlock> blocks;
+
+	std::shared_ptr<const HeightBlock> getBlock(const std::string& filePath, GeotiffDataset& geotiff,
+		int blockX, int blockY);
+
+   public:
+	GeotiffElevationProvider(const std::string& tilePath);
+
+	bool getHeights(const std::vector<uint32_t>& x31, const std::vector<uint32_t>& y31,
+		std::vector<double>& heights) override;
+};
+
 void blendHillshade(const uint32_t tileSize, char* shade, char* slope, char* blend);
 void mergeHeights(const uint32_t tileSize, const float scaleFactor, const bool forceReplace,
 	void* destination, float* source);
@@ -81,10 +188,7 @@ bool postProcess(
 	const ProcessingParameters& procParameters,
 	const uint32_t tileSize,
 	const uint32_t overlap,
-	const PointD& tileOrigin,
 	const PointD& tileResolution,
-	const int gcpCount,
-	const void* gcpList,
 	void* pBuffer);
 
 bool getGeotiffData(std::string& tilePath, std::string& outColorFilename, std::string& midColorFilename,
@@ -0,0 +1,96 @@
+#ifndef _OSMAND_HH_NETWORK_COST_CACHE_CPP
+#define _OSMAND_HH_NETWORK_COST_CACHE_CPP
+
+#include "hhNetworkCostCache.h"
+
+#include "generalRouter.h"
+#include "hhRouteDataStructure.h"
+
+HHNetworkCostCache& HHNetworkCostCache::getInstance() {
+	static HHNetworkCostCache instance;
+	return instance;
+}
+
+std::string HHNetworkCostCache::getNetworkKey(HHRoutingContext* hctx) {
+	std::string key;
+	for (auto& r : hctx->regions) {
+		if (r->file == nullptr || r->fileRegion == nullptr) {
+			continue;
+		}
+		key += r->file->inputName + ":" + std::to_string(r->fileRegion->edition) + ":" +
+			   r->fileRegion->profileParams.at(r->routingProfile) + ";";
+	}
+	SHARED_PTR<GeneralRouter> router = hctx->rctx->config->router;
+	key += "|" + profileToString(router->getProfile());
+	for (auto& p : router->serializeParameterValues(router->getParameterValues())) {
+		key += "," + p;
+	}
+	std::vector<int64_t> impassable(router->impassableRoadIds.begin(), router->impassableRoadIds.end());
+	std::sort(impassable.begin(), impassable.end());
+	key += "|";
+	for (int64_t id : impassable) {
+		key += std::to_string(id) + ",";
+	}
+	// conditional restrictions switch at minutes (e.g. "no @ (Mo-Fr 07:30-09:15)"), so key has minute precision
+	if (hctx->rctx->conditionalTime != 0) {
+		key += "|" + std::to_string(hctx->rctx->conditionalTime / 60);
+	}
+	return key;
+}
+
+SHARED_PTR<const HHNetworkCosts> HHNetworkCostCache::get(const std::string& key) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& n : networks) {
+		if (n.first == key) {
+			return n.second;
+		}
+	}
+	return nullptr;
+}
+
+static bool setSegmentCost(std::vector<std::pair<int64_t, double>>& costs, int64_t pnt, double dist) {
+	for (auto& c : costs) {
+		if (c.first == pnt) {
+			c.second = dist;
+			return false;
+		}
+	}
+	costs.push_back(std::make_pair(pnt, dist));
+	return true;
+}
+
+void HHNetworkCostCache::update(const std::string& key, const std::vector<HHSegmentCost>& costs) {
+	if (key.empty() || costs.empty()) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	// snapshots could be used by other contexts, so new version is a copy
+	SHARED_PTR<HHNetworkCosts> n = std::make_shared<HHNetworkCosts>();
+	for (uint i = 0; i < networks.size(); i++) {
+		if (networks[i].first == key) {
+			if (networks[i].second->size + costs.size() <= MAX_SEGMENTS) {
+				*n = *networks[i].second;
+			}
+			networks.erase(networks.begin() + i);
+			break;
+		}
+	}
+	for (auto& c : costs) {
+		if (setSegmentCost(n->outgoing[c.start], c.end, c.dist)) {
+			n->size++;
+		}
+		setSegmentCost(n->incoming[c.end], c.start, c.dist);
+	}
+	n->version = ++version;
+	networks.push_back(std::make_pair(key, n));
+	while (networks.size() > MAX_NETWORKS) {
+		networks.erase(networks.begin());
+	}
+}
+
+void HHNetworkCostCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	networks.clear();
+}
+
+#endif /*_OSMAND_HH_NETWORK_COST_CACHE_CPP*/
@@ -0,0 +1,61 @@
+#ifndef _OSMAND_HH_NETWORK_COST_CACHE_H
+#define _OSMAND_HH_NETWORK_COST_CACHE_H
+
+#include <mutex>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct HHRoutingContext;
+
+// Cost of HH network segment (start -> end point index) corrected by detailed routing,
+// dist < 0 means segment is disabled as route wasn't found
+struct HHSegmentCost {
+	int64_t start;
+	int64_t end;
+	double dist;
+
+	HHSegmentCost(int64_t start, int64_t end, double dist) : start(start), end(end), dist(dist) {}
+};
+
+// Immutable snapshot of corrected costs of one network, new version is created on every update
+struct HHNetworkCosts {
+	int version = 0;
+	size_t size = 0;
+	// start point index -> (end point index, dist)
+	UNORDERED(map)<int64_t, std::vector<std::pair<int64_t, double>>> outgoing;
+	// end point index -> (start point index, dist)
+	UNORDERED(map)<int64_t, std::vector<std::pair<int64_t, double>>> incoming;
+};
+
+// Keeps segment costs recalculated by HH routing (recalculateNetworkCluster, segments with increased cost or
+// not found) between requests and contexts, so next requests through the same "dirty" clusters start with
+// corrected costs and don't repeat recalculation iterations.
+// Networks are keyed by HH files (with edition), profile, router parameters and minute of conditional time
+// (see getNetworkKey).
+class HHNetworkCostCache {
+	std::mutex mutex;
+	int version;
+	// most recently updated networks are at the end
+	std::vector<std::pair<std::string, SHARED_PTR<const HHNetworkCosts>>> networks;
+
+   public:
+	const static int MAX_NETWORKS = 8;
+	const static int MAX_SEGMENTS = 200000;
+
+	HHNetworkCostCache() : version(0) {}
+
+	static HHNetworkCostCache& getInstance();
+
+	static std::string getNetworkKey(HHRoutingContext* hctx);
+
+	// Returns costs snapshot of network or NULL
+	SHARED_PTR<const HHNetworkCosts> get(const std::string& key);
+
+	// Merges costs into network (later costs of the same segment win)
+	void update(const std::string& key, const std::vector<HHSegmentCost>& costs);
+
+	void clear();
+};
+
+#endif /*_OSMAND_HH_NETWORK_COST_CACHE_H*/
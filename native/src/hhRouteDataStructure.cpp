@@ -75,13 +75,41 @@ void HHRoutingContext::clearVisited(const UNORDERED_map<int64_t, NetworkDBPoint
 	visitedRev.clear();
 }
 
+void HHRoutingContext::applyRecalculatedCosts(NetworkDBPoint * point, bool reverse) {
+	int & version = reverse ? point->costsVersionRev : point->costsVersionPos;
+	if (costs == nullptr || version == costs->version || !point->isConnSet(reverse)) {
+		return;
+	}
+	version = costs->version;
+	const auto & pointCosts = reverse ? costs->incoming : costs->outgoing;
+	auto it = pointCosts.find(point->index);
+	if (it == pointCosts.end()) {
+		return;
+	}
+	for (const auto & c : it->second) {
+		auto p = pointsById.find(c.first);
+		if (p == pointsById.end()) {
+			continue;
+		}
+		NetworkDBSegment * s = point->getSegment(p->second, !reverse);
+		if (s != nullptr) {
+			s->dist = c.second;
+		} else if (c.second >= 0) {
+			// segment was found by cluster recalculation
+			if (reverse) {
+				point->connectedReverse.push_back(createNetworkDBSegment(p->second, point, c.second, false, false));
+			} else {
+				point->connected.push_back(createNetworkDBSegment(point, p->second, c.second, true, false));
+			}
+		}
+	}
+}
+
 double HHRoutingContext::distanceToEnd(bool reverse, NetworkDBPoint * nextPoint) {
 	if (config->HEURISTIC_COEFFICIENT > 0) {
 		double distanceToEnd = nextPoint->rt(reverse)->rtDistanceToEnd;
 		if (distanceToEnd == 0) {
-			double dist = squareRootDist31(reverse ? startX : endX, reverse ? startY : endY,
-										   nextPoint->midX(), nextPoint->midY());
-			distanceToEnd = config->HEURISTIC_COEFFICIENT * dist / rctx->config->router->getMaxSpeed();
+			distanceToEnd = heuristicDistanceToEnd(reverse, nextPoint);
 			nextPoint->setDistanceToEnd(reverse, distanceToEnd);
 		}
 		return distanceToEnd;
@@ -89,4 +117,13 @@ double HHRoutingContext::distanceToEnd(bool reverse, NetworkDBPoint * nextPoint)
 	return 0;
 }
 
+double HHRoutingContext::heuristicDistanceToEnd(bool reverse, const NetworkDBPoint * nextPoint) const {
+	if (config->HEURISTIC_COEFFICIENT > 0) {
+		double dist = squareRootDist31(reverse ? startX : endX, reverse ? startY : endY,
+									   nextPoint->startX / 2 + nextPoint->endX / 2, nextPoint->startY / 2 + nextPoint->endY / 2);
+		return config->HEURISTIC_COEFFICIENT * dist / rctx->config->router->getMaxSpeed();
+	}
+	return 0;
+}
+
 #endif /*_OSMAND_HH_ROUTE_DATA_STRUCTURE_CPP*/
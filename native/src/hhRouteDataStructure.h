@@ -5,6 +5,8 @@
 #include "routeCalcResult.h"
 #include "routingContext.h"
 #include "NetworkDBPointRouteInfo.h"
+#include "hhNetworkCostCache.h"
+#include "hhSegmentsLoader.h"
 #include <set>
 #include <queue>
 
@@ -31,7 +33,12 @@ struct HHRoutingConfig
 	// TODO 3.1 HHRoutePlanner Alternative routes - could use distributions like 50% route (2 alt), 25%/75% route (1 alt)
 	double ALT_EXCLUDE_RAD_MULT = 0.3; // radius multiplier to exclude points
 	double ALT_EXCLUDE_RAD_MULT_IN = 3; // skip some points to speed up calculation
-	double ALT_NON_UNIQUENESS = 0.7; // 0.7 - 30% of points must be unique
+	double ALT_NON_UNIQUENESS = 0.7; // 0.7 - 30% of route cost must be on segments not shared with other routes
+	double ALT_PENALTY = 1.4; // cost multiplier of main route segments in alternative runs
+	double ALT_MAX_COST_CF = 1.5; // alternatives more expensive than main route * cf are skipped (0 - no limit)
+	int ALT_MAX_ROUTES = 3; // max selected alternatives (0 - no limit)
+	int ALT_ROUTE_THREADS = 4; // alternative runs are independent and calculated in parallel
+	bool CACHE_RECALCULATED_COSTS = true; // share corrected segment costs between requests (HHNetworkCostCache)
 
 	double MAX_COST = 0;
 	int MAX_DEPTH = -1; // max depth to go to
@@ -138,6 +145,9 @@ struct NetworkDBPoint {
 	std::vector<NetworkDBSegment *> connected;
 	std::vector<NetworkDBSegment *> connectedReverse;
 	bool isConnectedSet, isConnectedReverseSet; // dreaming of C++17 std::optional
+	// version of HHNetworkCosts applied to loaded segments
+	int costsVersionPos = 0;
+	int costsVersionRev = 0;
 
 	std::vector<TagValuePair> tagValues;
 	
@@ -169,6 +179,7 @@ struct NetworkDBPoint {
 		isConnectedSet = false;
 		connectedReverse.clear();
 		isConnectedReverseSet = false;
+		costsVersionPos = costsVersionRev = 0;
 	}
 	
 	LatLon getPoint() {
@@ -471,6 +482,36 @@ private:
 
 typedef priority_queue<SHARED_PTR<NetworkDBPointCost>, vector<SHARED_PTR<NetworkDBPointCost>>, HHPointComparator> HH_QUEUE;
 
+// Search state of one alternative route run. Main search keeps its state in points (rtPos / rtRev),
+// alternative runs (different excluded points) keep own state, so they could be calculated in parallel.
+// Points avoided by router configuration (rtExclude) are skipped by runs as by main search.
+struct HHAlternativeRun {
+	struct PointState {
+		NetworkDBPoint * parent = nullptr;
+		// segment from parent chosen by this run (there could be shortcut between the same points)
+		NetworkDBSegment * segment = nullptr;
+		double distanceFromStart = 0;
+		double cost = 0;
+		bool visited = false;
+	};
+	
+	UNORDERED(set)<NetworkDBPoint *> exclude;
+	UNORDERED_map<NetworkDBPoint *, PointState> pos;
+	UNORDERED_map<NetworkDBPoint *, PointState> rev;
+	NetworkDBPoint * finalPoint = nullptr;
+	int visitedVertices = 0;
+	int addedVertices = 0;
+	int loadEdgesCnt = 0;
+	
+	PointState & st(NetworkDBPoint * point, bool reverse) {
+		return (reverse ? rev : pos)[point];
+	}
+	
+	bool isExcluded(NetworkDBPoint * point) const {
+		return exclude.find(point) != exclude.end();
+	}
+};
+
 struct HHRoutingContext {
 	bool USE_GLOBAL_QUEUE = false;
 	
@@ -498,6 +539,13 @@ struct HHRoutingContext {
 	std::vector<NetworkDBPoint *> cacheAllNetworkDBPoint;
 	UNORDERED_map<string, string> filterRoutingParameters;
 	
+	// segment costs corrected by previous requests (shared with other contexts) and by current request
+	std::string costsKey;
+	SHARED_PTR<const HHNetworkCosts> costs;
+	std::vector<HHSegmentCost> recalculatedCosts;
+	// segments of points are loaded on first access
+	HHSegmentsLoader segmentsLoader;
+	
 	DataTileManager pointsRect;
 	
 	HHRoutingContext(): pointsRect(11) {
@@ -595,23 +643,13 @@ struct HHRoutingContext {
 		return it->second;
 	}
 	
-	static bool checkId(int id, HHRouteBlockSegments * s) {
-		return s->idRangeStart <= id && s->idRangeStart + s->idRangeLength > id;
-	}
-	
 	int32_t loadNetworkSegmentPoint(NetworkDBPoint * point, bool reverse) {
 		if (point->isConnSet(reverse)) {
 			return 0;
 		}
 		short mapId = point->mapId;
 		if (mapId < regions.size()) {
-			SHARED_PTR<HHRouteRegionPointsCtx> & r = regions[mapId];
-			SHARED_PTR<HHRouteIndex> & fileRegion = r->fileRegion;
-			for (auto * s : fileRegion->segments) {
-				if (s->profileId == r->getRoutingProfile() && checkId(point->fileId, s)) {
-					return ::loadNetworkSegmentPoint(this, r, s, point->fileId);
-				}
-			}
+			return segmentsLoader.load(this, regions[mapId], point);
 		}
 		return 0;
 	}
@@ -633,9 +671,21 @@ struct HHRoutingContext {
 			NetworkDBPoint * p = it->second;
 			p->markSegmentsNotLoaded();
 		}
+		segmentsLoader.clear();
 	}
 	
 	double distanceToEnd(bool reverse, NetworkDBPoint * nextPoint);
+	// A* heuristic of point (not cached in point)
+	double heuristicDistanceToEnd(bool reverse, const NetworkDBPoint * nextPoint) const;
+	
+	void addRecalculatedCost(NetworkDBPoint * start, NetworkDBPoint * end, double dist) {
+		if (config->CACHE_RECALCULATED_COSTS) {
+			recalculatedCosts.push_back(HHSegmentCost(start->index, end->index, dist));
+		}
+	}
+	
+	// Applies corrected costs to loaded segments of point (once per costs version)
+	void applyRecalculatedCosts(NetworkDBPoint * point, bool reverse);
 	
 private:
 	SHARED_PTR<HH_QUEUE> queueGlobal;
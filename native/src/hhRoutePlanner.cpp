@@ -2,6 +2,7 @@
 #define _OSMAND_HH_ROUTE_PLANNER_CPP
 
 #include <ctime>
+#include <thread>
 #include "hhRoutePlanner.h"
 #include "CommonCollections.h"
 #include "Logging.h"
@@ -239,6 +240,13 @@ SHARED_PTR<HHRoutingContext> HHRoutePlanner::initHCtx(HHRoutingConfig * c, int s
 	return hctx;
 }
 
+void HHRoutePlanner::saveRecalculatedCosts(const SHARED_PTR<HHRoutingContext> & hctx) {
+	if (hctx->recalculatedCosts.size() > 0) {
+		HHNetworkCostCache::getInstance().update(hctx->costsKey, hctx->recalculatedCosts);
+		hctx->recalculatedCosts.clear();
+	}
+}
+
 HHNetworkRouteRes * HHRoutePlanner::cancelledStatus() const {
 	return new HHNetworkRouteRes("Routing was cancelled.");
 }
@@ -256,6 +264,10 @@ HHNetworkRouteRes * HHRoutePlanner::runRouting(int startX, int startY, int endX,
 		return res;
 	}
 	filterPointsBasedOnConfiguration(hctx);
+	if (config->CACHE_RECALCULATED_COSTS) {
+		hctx->costsKey = HHNetworkCostCache::getNetworkKey(hctx.get());
+		hctx->costs = HHNetworkCostCache::getInstance().get(hctx->costsKey);
+	}
 	
 	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Routing %.5f %.5f -> %.5f %.5f (HC %d, dir %d)",
 					  get31LatitudeY(startY), get31LongitudeX(startX),
@@ -311,6 +323,7 @@ HHNetworkRouteRes * HHRoutePlanner::runRouting(int startX, int startY, int endX,
 		hctx->stats.routingTime += time;
 		if (recalc) {
 			if (calcCount > hctx->config->MAX_COUNT_REITERATION) {
+				saveRecalculatedCosts(hctx);
 				OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Too many recalculations (stop)");
 				HHNetworkRouteRes * res = new HHNetworkRouteRes("Too many recalculations (outdated maps or unsupported parameters).");
 				return res;
@@ -320,6 +333,7 @@ HHNetworkRouteRes * HHRoutePlanner::runRouting(int startX, int startY, int endX,
 			route = nullptr;
 		}
 	} while (route == nullptr);
+	saveRecalculatedCosts(hctx);
 	
 	if (firstIterationTime > 0 && DEBUG_VERBOSE_LEVEL == 0 && SL > 0) {
 		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Parse detailed route segments... %d iterations, %.f ms", iteration, hctx->stats.routingTime - firstIterationTime);
@@ -761,6 +775,7 @@ void HHRoutePlanner::recalculateNetworkCluster(const SHARED_PTR<HHRoutingContext
 				p->endX = o->getEndPointX();
 				p->endY = o->getEndPointY();
 				float routeTime = o->getDistanceFromStart() + calcRoutingSegmentTimeOnlyDist(hctx->rctx->config->router, o) / 2 + 1;
+				hctx->addRecalculatedCost(start, p, routeTime);
 				NetworkDBSegment * c = start->getSegment(p, true);
 				if (c != nullptr) {
 					c->dist = routeTime;
@@ -781,6 +796,7 @@ void HHRoutePlanner::recalculateNetworkCluster(const SHARED_PTR<HHRoutingContext
 		auto it = resUnique.find(calculateRoutePointInternalId(c->end->roadId, c->end->start, c->end->end));
 		if (it == resUnique.end()) {
 			c->dist = -1; // disable as not found
+			hctx->addRecalculatedCost(start, c->end, -1);
 			NetworkDBSegment * co = c->end->getSegment(start, false);
 			if (co != nullptr) {
 				co->dist = -1;
@@ -822,6 +838,7 @@ bool HHRoutePlanner::retrieveSegmentsGeometry(const SHARED_PTR<HHRoutingContext>
 					recalculateNetworkCluster(hctx, s.segment->start);
 				}
 				s.segment->dist = -1;
+				hctx->addRecalculatedCost(s.segment->start, s.segment->end, -1);
 				return true;
 			}
 			if (f.size() > 1) {
@@ -836,6 +853,7 @@ bool HHRoutePlanner::retrieveSegmentsGeometry(const SHARED_PTR<HHRoutingContext>
 									  distanceFromStart, s.segment->dist, (int)s.segment->start->index, (int)s.segment->end->index);
 				}
 				s.segment->dist = distanceFromStart;
+				hctx->addRecalculatedCost(s.segment->start, s.segment->end, distanceFromStart);
 				return true;
 			}
 			s.rtTimeDetailed = distanceFromStart;
@@ -963,6 +981,7 @@ void HHRoutePlanner::addConnectedToQueue(const SHARED_PTR<HHRoutingContext> & hc
 	OsmAnd::ElapsedTimer timer;
 	timer.Start();
 	int cnt = hctx->loadNetworkSegmentPoint(point, reverse);
+	hctx->applyRecalculatedCosts(point, reverse);
 	hctx->stats.loadEdgesCnt += cnt;
 	hctx->stats.loadEdgesTime += (double) timer.GetElapsedNanos() / 1000000;
 	for (NetworkDBSegment * connected : point->conn(reverse)) {
@@ -1144,8 +1163,6 @@ void HHRoutePlanner::printPoint(NetworkDBPoint * p, bool rev) const {
 void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & hctx, HHNetworkRouteRes * route,
 										  UNORDERED_map<int64_t, NetworkDBPoint *> & stPoints, UNORDERED_map<int64_t,
 										  NetworkDBPoint *> & endPoints, SHARED_PTR<RouteCalculationProgress> & progress) {
-	std::vector<NetworkDBPoint *> exclude;
-	HHNetworkRouteRes * rt = route;
 	// distances between all points and start/end
 	std::vector<NetworkDBPoint *> points;
 	for (int i = 0; i < route->segments.size(); i++) {
@@ -1158,13 +1175,17 @@ void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & h
 		}
 		points.push_back(s->end);
 	}
-	double * distances = new double[points.size()];
+	int size = (int) points.size();
+	if (size == 0) {
+		return;
+	}
+	std::vector<double> distances(size);
 	NetworkDBPoint * prev = nullptr;
-	for (int i = 0; i < sizeof(distances); i++) {
+	for (int i = 0; i < size; i++) {
 		NetworkDBPoint * pnt = points.at(i);
 		if (i == 0) {
 			distances[i] = squareRootDist31(hctx->startX, hctx->startY, pnt->midX(), pnt->midY());
-		} else if (i == sizeof(distances) - 1) {
+		} else if (i == size - 1) {
 			distances[i] = squareRootDist31(hctx->endX, hctx->endY, pnt->midX(), pnt->midY());
 		} else {
 			distances[i] = squareRootDist31(prev->midX(), prev->midY(), pnt->midX(), pnt->midY());
@@ -1173,21 +1194,21 @@ void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & h
 	}
 	
 	// calculate min(cumPos, cumNeg) distance
-	double * cdistPos = new double[sizeof(distances)];
-	double * cdistNeg = new double[sizeof(distances)];
-	for (int i = 0; i < sizeof(distances); i++) {
+	std::vector<double> cdistPos(size);
+	std::vector<double> cdistNeg(size);
+	for (int i = 0; i < size; i++) {
 		if(i == 0) {
 			cdistPos[0] = distances[i];
-			cdistNeg[sizeof(distances) - 1] = distances[sizeof(distances)- 1];
+			cdistNeg[size - 1] = distances[size - 1];
 		} else {
 			cdistPos[i] = cdistPos[i - 1] + distances[i];
-			cdistNeg[sizeof(distances) - i - 1] = cdistNeg[sizeof(distances) - i] + distances[sizeof(distances) - i - 1];
+			cdistNeg[size - i - 1] = cdistNeg[size - i] + distances[size - i - 1];
 		}
 	}
-	double * minDistance = new double[sizeof(distances)];
-	bool * useToSkip = new bool[sizeof(distances)];
+	std::vector<double> minDistance(size);
+	std::vector<bool> useToSkip(size, false);
 	int altPoints = 0;
-	for (int i = 0; i < sizeof(distances); i++) {
+	for (int i = 0; i < size; i++) {
 		minDistance[i] = std::min(cdistNeg[i], cdistPos[i]) * hctx->config->ALT_EXCLUDE_RAD_MULT;
 		bool coveredByPrevious = false;
 		for (int j = 0; j < i; j++) {
@@ -1205,7 +1226,7 @@ void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & h
 	}
 	if (DEBUG_VERBOSE_LEVEL >= 1) {
 		std::string s = "[";
-		for (int i = 0; i < sizeof(minDistance); i++) {
+		for (int i = 0; i < size; i++) {
 			if (i > 0) {
 				s += ", ";
 			}
@@ -1217,73 +1238,94 @@ void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & h
 	if (progress->isCancelled()) {
 		return;
 	}
-	for (int i = 0; i < sizeof(distances); i++) {
+	
+	// penalty method: segments of main route are more expensive in every run,
+	// run 0 has only penalty, other runs exclude points around selected point of main route as well
+	std::set<std::pair<int64_t, int64_t>> penalized;
+	for (auto & r : route->segments) {
+		if (r.segment != nullptr) {
+			penalized.insert(std::make_pair(r.segment->start->index, r.segment->end->index));
+		}
+	}
+	std::vector<HHAlternativeRun> runs(1);
+	for (int i = 0; i < size; i++) {
 		if (!useToSkip[i]) {
 			continue;
 		}
-		hctx->clearVisited(stPoints, endPoints);
-		for (NetworkDBPoint * pnt : exclude) {
-			pnt->rtExclude = false;
-		}
-		exclude.clear();
-		
+		runs.push_back(HHAlternativeRun());
 		LatLon pnt = points.at(i)->getPoint();
-		//std::vector<NetworkDBPoint *> getClosestObjects(double latitude, double longitude, double radius);
 		std::vector<NetworkDBPoint *> objs = hctx->pointsRect.getClosestObjects(pnt.lat, pnt.lon, minDistance[i]);
 		for (NetworkDBPoint * p : objs) {
 			LatLon pCoords = p->getPoint();
 			if (getDistance(pCoords.lat, pCoords.lon, pnt.lat, pnt.lon) <= minDistance[i]) {
-				exclude.push_back(p);
-				p->rtExclude = true;
+				runs.back().exclude.insert(p);
 			}
 		}
-		
-		NetworkDBPoint * finalPnt = runRoutingPointsToPoints(hctx, stPoints, endPoints);
-		if (progress->isCancelled()) {
-			return;
-		}
-		if (finalPnt != nullptr) {
-			double cost = (finalPnt->rt(false)->rtDistanceFromStart + finalPnt->rt(true)->rtDistanceFromStart);
+	}
+	
+	// keeps detailed start / end segments which are read by runs
+	hctx->clearVisited(stPoints, endPoints);
+	std::mutex loadMutex;
+	int threads = std::max(1, std::min(hctx->config->ALT_ROUTE_THREADS, (int) runs.size()));
+	auto task = [&](int t) {
+		for (int r = t; r < runs.size(); r += threads) {
+			runAlternativeRouting(hctx, runs[r], stPoints, endPoints, penalized, loadMutex);
+		}
+	};
+	std::vector<std::thread> workers;
+	for (int t = 1; t < threads; t++) {
+		workers.push_back(std::thread(task, t));
+	}
+	task(0);
+	for (auto & w : workers) {
+		w.join();
+	}
+	if (progress->isCancelled()) {
+		return;
+	}
+	
+	std::vector<HHNetworkRouteRes *> alts;
+	for (HHAlternativeRun & run : runs) {
+		hctx->stats.visitedVertices += run.visitedVertices;
+		hctx->stats.addedVertices += run.addedVertices;
+		hctx->stats.loadEdgesCnt += run.loadEdgesCnt;
+		if (run.finalPoint != nullptr) {
+			HHNetworkRouteRes * alt = createAlternativeRoute(hctx, run);
 			if (DEBUG_VERBOSE_LEVEL == 1) {
-				OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Alternative route cost: %.2f", cost);
+				OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Alternative route cost: %.2f", alt->getHHRoutingTime());
 			}
-			rt = createRouteSegmentFromFinalPoint(hctx, finalPnt);
-			route->altRoutes.push_back(rt);
-		} else {
-			break;
+			alts.push_back(alt);
 		}
 	}
 	
-	std::sort(route->altRoutes.begin(), route->altRoutes.end(), [](HHNetworkRouteRes * o1, HHNetworkRouteRes * o2) {
-		return o1->getHHRoutingTime() > o2->getHHRoutingTime();
+	// cheapest alternatives first, alternative is selected if enough of its cost is not shared
+	// with main route and already selected alternatives
+	std::sort(alts.begin(), alts.end(), [](HHNetworkRouteRes * o1, HHNetworkRouteRes * o2) {
+		return o1->getHHRoutingTime() < o2->getHHRoutingTime();
 	});
-	
-	int size = (int) route->altRoutes.size();
-	if (size > 0) {
-		for(int k = 0; k < route->altRoutes.size(); ) {
-			HHNetworkRouteRes * altR = route->altRoutes.at(k);
-			bool unique = true;
-			for (int j = 0; j <= k; j++) {
-				HHNetworkRouteRes * cmp = j == k ? route : route->altRoutes.at(j);
-				std::set<int64_t> cp = altR->uniquePoints;
-				retainAll(cp, cmp->uniquePoints);                
-				if (cp.size() >= hctx->config->ALT_NON_UNIQUENESS * altR->uniquePoints.size()) {
-					unique = false;
-					break;
-				}
-			}
-			if (unique) {
-				k++;
-			} else {
-				route->altRoutes.erase(route->altRoutes.begin() + k);
+	double maxCost = hctx->config->ALT_MAX_COST_CF > 0 ? route->getHHRoutingTime() * hctx->config->ALT_MAX_COST_CF : 0;
+	for (HHNetworkRouteRes * alt : alts) {
+		bool unique = (hctx->config->ALT_MAX_ROUTES <= 0 || route->altRoutes.size() < hctx->config->ALT_MAX_ROUTES)
+			&& (maxCost == 0 || alt->getHHRoutingTime() <= maxCost)
+			&& overlapCost(alt, route) < hctx->config->ALT_NON_UNIQUENESS;
+		for (int j = 0; unique && j < route->altRoutes.size(); j++) {
+			if (overlapCost(alt, route->altRoutes.at(j)) >= hctx->config->ALT_NON_UNIQUENESS) {
+				unique = false;
 			}
 		}
-		if (route->altRoutes.size() > 0 && hctx->config->STATS_VERBOSE_LEVEL > 0) {
+		if (unique) {
+			route->altRoutes.push_back(alt);
+		} else {
+			delete alt;
+		}
+	}
+	if (route->altRoutes.size() > 0) {
+		if (hctx->config->STATS_VERBOSE_LEVEL > 0) {
 			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
-							  "Cost %.2f - %.2f [%zu unique / %d]...",
+							  "Cost %.2f - %.2f [%zu unique / %zu]...",
 							  route->altRoutes.at(0)->getHHRoutingTime(),
 							  route->altRoutes.at(route->altRoutes.size() - 1)->getHHRoutingTime(),
-							  route->altRoutes.size(), size);
+							  route->altRoutes.size(), alts.size());
 		}
 		int ind = DEBUG_ALT_ROUTE_SELECTION % (route->altRoutes.size() + 1);
 		if (ind > 0) {
@@ -1298,10 +1340,189 @@ void HHRoutePlanner::calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & h
 			route->altRoutes = r;
 		}
 	}
-	
-	for (NetworkDBPoint * pnt : exclude) {
-		pnt->rtExclude = false;
+}
+
+void HHRoutePlanner::runAlternativeRouting(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run,
+										   UNORDERED_map<int64_t, NetworkDBPoint *> & stPoints, UNORDERED_map<int64_t, NetworkDBPoint *> & endPoints,
+										   const std::set<std::pair<int64_t, int64_t>> & penalized, std::mutex & loadMutex) {
+	SHARED_PTR<RouteCalculationProgress> progress = hctx->rctx->progress;
+	SHARED_PTR<HH_QUEUE> pos = hctx->createQueue();
+	SHARED_PTR<HH_QUEUE> rev = hctx->createQueue();
+	for (int k = 0; k < 2; k++) {
+		bool reverse = k == 1;
+		for (auto & it : (reverse ? endPoints : stPoints)) {
+			NetworkDBPoint * p = it.second;
+			// rtExclude is set by configuration of router (avoided roads), not by search
+			if (p->rtExclude || run.isExcluded(p)) {
+				continue;
+			}
+			// rtPos / rtRev of start / end points are only read here (rt() would create them)
+			SHARED_PTR<NetworkDBPointRouteInfo> & rt = reverse ? p->rtRev : p->rtPos;
+			HHAlternativeRun::PointState & s = run.st(p, reverse);
+			s.distanceFromStart = rt == nullptr ? 0 : rt->rtDistanceFromStart;
+			s.cost = std::max(s.distanceFromStart + hctx->heuristicDistanceToEnd(reverse, p), MINIMAL_COST);
+			(reverse ? rev : pos)->push(std::make_shared<NetworkDBPointCost>(p, s.cost, reverse));
+			run.addedVertices++;
+		}
+	}
+	// same stop condition as runRoutingWithInitQueue
+	float DIR_CONFIG = hctx->config->DIJKSTRA_DIRECTION;
+	bool met = false;
+	while (true) {
+		SHARED_PTR<HH_QUEUE> queue;
+		if (hctx->config->DIJKSTRA_DIRECTION == 0 || (!rev->empty() && !pos->empty())) {
+			if (rev->empty() || pos->empty()) {
+				break;
+			}
+			queue = pos->top()->cost < rev->top()->cost ? pos : rev;
+		} else {
+			queue = hctx->config->DIJKSTRA_DIRECTION > 0 ? pos : rev;
+			if (queue->empty()) {
+				break;
+			}
+		}
+		if (progress != nullptr && progress->isCancelled()) {
+			return;
+		}
+		SHARED_PTR<NetworkDBPointCost> pointCost = queue->top();
+		queue->pop();
+		NetworkDBPoint * point = pointCost->point;
+		bool r = pointCost->rev;
+		run.visitedVertices++;
+		if (run.st(point, !r).visited) {
+			if (!met) {
+				met = true;
+				if (DIR_CONFIG == 0 && hctx->config->HEURISTIC_COEFFICIENT != 0) {
+					DIR_CONFIG = r ? -1 : 1;
+				}
+			}
+			double rcost = run.st(point, true).distanceFromStart + run.st(point, false).distanceFromStart;
+			if (rcost <= pointCost->cost) {
+				run.finalPoint = point;
+				return;
+			}
+			queue->push(std::make_shared<NetworkDBPointCost>(point, rcost, r));
+			run.st(point, r).visited = true;
+			continue;
+		}
+		HHAlternativeRun::PointState & s = run.st(point, r);
+		if (s.visited) {
+			continue;
+		}
+		s.visited = true;
+		if (hctx->config->MAX_COST > 0 && pointCost->cost > hctx->config->MAX_COST) {
+			break;
+		}
+		bool directionAllowed = (DIR_CONFIG <= 0 && r) || (DIR_CONFIG >= 0 && !r);
+		if (directionAllowed) {
+			addAlternativeConnectedToQueue(hctx, run, queue, point, r, penalized, loadMutex);
+		}
+	}
+}
+
+void HHRoutePlanner::addAlternativeConnectedToQueue(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run, SHARED_PTR<HH_QUEUE> & queue,
+													NetworkDBPoint * point, bool reverse, const std::set<std::pair<int64_t, int64_t>> & penalized,
+													std::mutex & loadMutex) {
+	std::vector<NetworkDBSegment *> segments;
+	{
+		// segments are shared by runs and loaded once, loaded segments are not modified
+		std::lock_guard<std::mutex> lock(loadMutex);
+		run.loadEdgesCnt += hctx->loadNetworkSegmentPoint(point, reverse);
+		hctx->applyRecalculatedCosts(point, reverse);
+		segments = point->conn(reverse);
+	}
+	double distanceFromStart = run.st(point, reverse).distanceFromStart;
+	for (NetworkDBSegment * connected : segments) {
+		NetworkDBPoint * nextPoint = reverse ? connected->start : connected->end;
+		if (!hctx->config->USE_CH && !hctx->config->USE_CH_SHORTCUTS && connected->shortcut) {
+			continue;
+		}
+		if (connected->dist < 0 || nextPoint->rtExclude || run.isExcluded(nextPoint)) {
+			continue;
+		}
+		double dist = connected->dist;
+		if (penalized.find(std::make_pair(connected->start->index, connected->end->index)) != penalized.end()) {
+			dist *= hctx->config->ALT_PENALTY;
+		}
+		HHAlternativeRun::PointState & next = run.st(nextPoint, reverse);
+		if (next.visited) {
+			continue;
+		}
+		double cost = distanceFromStart + dist + hctx->heuristicDistanceToEnd(reverse, nextPoint);
+		if (next.cost == 0 || cost < next.cost) {
+			next.parent = point;
+			next.segment = connected;
+			next.distanceFromStart = distanceFromStart + dist;
+			next.cost = cost;
+			queue->push(std::make_shared<NetworkDBPointCost>(nextPoint, cost, reverse));
+			run.addedVertices++;
+		}
+	}
+}
+
+HHNetworkRouteRes * HHRoutePlanner::createAlternativeRoute(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run) {
+	// same as createRouteSegmentFromFinalPoint, but segments are the ones chosen by the run (not looked up
+	// between points, which could return shortcut the run skipped), with original (not penalized) cost
+	HHNetworkRouteRes * route = new HHNetworkRouteRes();
+	NetworkDBPoint * itPnt = run.finalPoint;
+	route->uniquePoints.insert(itPnt->index);
+	while (run.st(itPnt, true).parent != nullptr) {
+		const HHAlternativeRun::PointState & state = run.st(itPnt, true);
+		NetworkDBPoint * nextPnt = state.parent;
+		NetworkDBSegment * segment = state.segment;
+		HHNetworkSegmentRes res(segment);
+		res.rtTimeDetailed = res.rtTimeHHSegments = segment->dist;
+		route->segments.push_back(res);
+		itPnt = nextPnt;
+		route->uniquePoints.insert(itPnt->index);
+	}
+	if (itPnt->rtRev != nullptr && itPnt->rtRev->rtDetailedRoute != nullptr) {
+		HHNetworkSegmentRes res(nullptr);
+		res.list = convertFinalSegmentToResults(hctx->rctx, itPnt->rtRev->rtDetailedRoute);
+		res.rtTimeDetailed = res.rtTimeHHSegments = itPnt->rtRev->rtDetailedRoute->distanceFromStart;
+		route->segments.push_back(res);
+	}
+	std::reverse(route->segments.begin(), route->segments.end());
+	itPnt = run.finalPoint;
+	while (run.st(itPnt, false).parent != nullptr) {
+		const HHAlternativeRun::PointState & state = run.st(itPnt, false);
+		NetworkDBPoint * nextPnt = state.parent;
+		NetworkDBSegment * segment = state.segment;
+		HHNetworkSegmentRes res(segment);
+		res.rtTimeDetailed = res.rtTimeHHSegments = segment->dist;
+		route->segments.push_back(res);
+		itPnt = nextPnt;
+		route->uniquePoints.insert(itPnt->index);
+	}
+	if (itPnt->rtPos != nullptr && itPnt->rtPos->rtDetailedRoute != nullptr) {
+		HHNetworkSegmentRes res(nullptr);
+		res.list = convertFinalSegmentToResults(hctx->rctx, itPnt->rtPos->rtDetailedRoute);
+		res.rtTimeDetailed = res.rtTimeHHSegments = itPnt->rtPos->rtDetailedRoute->distanceFromStart;
+		route->segments.push_back(res);
+	}
+	std::reverse(route->segments.begin(), route->segments.end());
+	return route;
+}
+
+double HHRoutePlanner::overlapCost(HHNetworkRouteRes * alt, HHNetworkRouteRes * cmp) const {
+	// share of alt network cost on segments of cmp route
+	std::set<std::pair<int64_t, int64_t>> cmpSegments;
+	for (auto & r : cmp->segments) {
+		if (r.segment != nullptr) {
+			cmpSegments.insert(std::make_pair(r.segment->start->index, r.segment->end->index));
+		}
+	}
+	double total = 0, shared = 0;
+	for (auto & r : alt->segments) {
+		if (r.segment == nullptr) {
+			continue;
+		}
+		total += r.segment->dist;
+		if (cmpSegments.find(std::make_pair(r.segment->start->index, r.segment->end->index)) != cmpSegments.end()) {
+			shared += r.segment->dist;
+		}
 	}
+	return total > 0 ? shared / total : 1;
 }
 
 bool HHRoutePlanner::retainAll(std::set<int64_t> & source, const std::set<int64_t> & other) const {
@@ -1,6 +1,8 @@
 #ifndef _OSMAND_HH_ROUTE_PLANNER_H
 #define _OSMAND_HH_ROUTE_PLANNER_H
 
+#include <mutex>
+
 #include "CommonCollections.h"
 #include "hhRouteDataStructure.h"
 #include "routingContext.h"
@@ -67,7 +69,16 @@ private:
 	void calcAlternativeRoute(const SHARED_PTR<HHRoutingContext> & hctx, HHNetworkRouteRes * route,
 							  UNORDERED_map<int64_t, NetworkDBPoint *> & stPoints, UNORDERED_map<int64_t,
 							  NetworkDBPoint *> & endPoints, SHARED_PTR<RouteCalculationProgress> & progress);
+	void runAlternativeRouting(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run,
+							   UNORDERED_map<int64_t, NetworkDBPoint *> & stPoints, UNORDERED_map<int64_t, NetworkDBPoint *> & endPoints,
+							   const std::set<std::pair<int64_t, int64_t>> & penalized, std::mutex & loadMutex);
+	void addAlternativeConnectedToQueue(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run, SHARED_PTR<HH_QUEUE> & queue,
+										NetworkDBPoint * point, bool reverse, const std::set<std::pair<int64_t, int64_t>> & penalized,
+										std::mutex & loadMutex);
+	HHNetworkRouteRes * createAlternativeRoute(const SHARED_PTR<HHRoutingContext> & hctx, HHAlternativeRun & run);
+	double overlapCost(HHNetworkRouteRes * alt, HHNetworkRouteRes * cmp) const;
 	HHNetworkRouteRes * cancelledStatus() const;
+	void saveRecalculatedCosts(const SHARED_PTR<HHRoutingContext> & hctx);
 	void filterPointsBasedOnConfiguration(const SHARED_PTR<HHRoutingContext> & hctx);
 	
 };
@@ -0,0 +1,96 @@
+#ifndef _OSMAND_HH_SEGMENTS_LOADER_CPP
+#define _OSMAND_HH_SEGMENTS_LOADER_CPP
+
+#include "hhSegmentsLoader.h"
+
+#include "Logging.h"
+#include "hhRouteDataStructure.h"
+
+void HHSegmentsLoader::setMaxSize(size_t s) {
+	maxSize = s;
+	evict();
+}
+
+int32_t HHSegmentsLoader::load(HHRoutingContext* ctx, const SHARED_PTR<HHRouteRegionPointsCtx>& r,
+							   NetworkDBPoint* point) {
+	std::vector<HHSegmentsBlockInfo>& dir = getDirectory(r);
+	auto it = std::upper_bound(dir.begin(), dir.end(), point->fileId,
+							   [](int id, const HHSegmentsBlockInfo& b) { return id < b.idRangeStart; });
+	if (it == dir.begin()) {
+		return 0;
+	}
+	it--;
+	if (point->fileId >= it->idRangeStart + it->idRangeLength) {
+		return 0;
+	}
+	SHARED_PTR<HHSegmentsBlock> block = getBlock(r, (int)(it - dir.begin()));
+	int ind = point->fileId - it->idRangeStart;
+	if (!block || ind >= block->getPointsCount()) {
+		return 0;
+	}
+	auto v = block->values.begin();
+	std::vector<int32_t> segmentsIn(v + block->offsets[2 * ind], v + block->offsets[2 * ind + 1]);
+	std::vector<int32_t> segmentsOut(v + block->offsets[2 * ind + 1], v + block->offsets[2 * ind + 2]);
+	point->connectedSet(true, parseSegments(ctx, segmentsIn, ctx->getIncomingPoints(point), point, false));
+	point->connectedSet(false, parseSegments(ctx, segmentsOut, ctx->getOutgoingPoints(point), point, true));
+	return (int32_t)(point->connectedReverse.size() + point->connected.size());
+}
+
+std::vector<HHSegmentsBlockInfo>& HHSegmentsLoader::getDirectory(const SHARED_PTR<HHRouteRegionPointsCtx>& r) {
+	auto it = directories.find(r->id);
+	if (it != directories.end()) {
+		return it->second;
+	}
+	std::vector<HHSegmentsBlockInfo>& dir = directories[r->id];
+	if (r->file != nullptr) {
+		for (auto* s : r->fileRegion->segments) {
+			if (s->profileId == r->getRoutingProfile()) {
+				readHHSegmentsDirectory(r->file, s, dir);
+			}
+		}
+	}
+	std::sort(dir.begin(), dir.end(), [](const HHSegmentsBlockInfo& a, const HHSegmentsBlockInfo& b) {
+		return a.idRangeStart < b.idRangeStart;
+	});
+	return dir;
+}
+
+SHARED_PTR<HHSegmentsBlock> HHSegmentsLoader::getBlock(const SHARED_PTR<HHRouteRegionPointsCtx>& r, int blockIndex) {
+	int64_t key = ((int64_t)r->id << 32) + blockIndex;
+	auto it = blocks.find(key);
+	if (it != blocks.end()) {
+		lru.splice(lru.end(), lru, it->second.lru);
+		return it->second.block;
+	}
+	SHARED_PTR<HHSegmentsBlock> block = std::make_shared<HHSegmentsBlock>();
+	if (!readHHSegmentsBlock(r->file, directories[r->id][blockIndex], *block)) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "HH segments block %d can't be read", blockIndex);
+		return nullptr;
+	}
+	decodedBlocks++;
+	size += block->getSize();
+	CachedBlock& c = blocks[key];
+	c.block = block;
+	c.lru = lru.insert(lru.end(), key);
+	evict();
+	return block;
+}
+
+void HHSegmentsLoader::evict() {
+	// last block is kept as it's in use
+	while (size > maxSize && lru.size() > 1) {
+		auto it = blocks.find(lru.front());
+		size -= it->second.block->getSize();
+		blocks.erase(it);
+		lru.pop_front();
+		evictedBlocks++;
+	}
+}
+
+void HHSegmentsLoader::clear() {
+	blocks.clear();
+	lru.clear();
+	size = 0;
+}
+
+#endif /*_OSMAND_HH_SEGMENTS_LOADER_CPP*/
@@ -0,0 +1,53 @@
+#ifndef _OSMAND_HH_SEGMENTS_LOADER_H
+#define _OSMAND_HH_SEGMENTS_LOADER_H
+
+#include <list>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+#include "binaryRead.h"
+
+struct NetworkDBPoint;
+struct HHRoutingContext;
+struct HHRouteRegionPointsCtx;
+
+// Lazy loader of HH network segments. Directory of leaf blocks (point id ranges with file offsets) is read once
+// per region, block is decoded into compact arrays (HHSegmentsBlock) when search touches one of its points first time
+// and segments objects are created only for touched points. Decoded blocks are evicted (least recently used)
+// when their size exceeds maxSize.
+class HHSegmentsLoader {
+	struct CachedBlock {
+		SHARED_PTR<HHSegmentsBlock> block;
+		std::list<int64_t>::iterator lru;
+	};
+
+	// region id -> leaf blocks sorted by idRangeStart
+	UNORDERED_map<short, std::vector<HHSegmentsBlockInfo>> directories;
+	UNORDERED_map<int64_t, CachedBlock> blocks;
+	// least recently used blocks are at the beginning
+	std::list<int64_t> lru;
+	size_t size;
+	size_t maxSize;
+
+   public:
+	const static size_t DEFAULT_MAX_SIZE = 32 * 1024 * 1024;
+
+	int decodedBlocks = 0;
+	int evictedBlocks = 0;
+
+	HHSegmentsLoader() : size(0), maxSize(DEFAULT_MAX_SIZE) {}
+
+	void setMaxSize(size_t s);
+
+	// Sets segments in and out of point, returns number of loaded segments
+	int32_t load(HHRoutingContext* ctx, const SHARED_PTR<HHRouteRegionPointsCtx>& r, NetworkDBPoint* point);
+
+	void clear();
+
+   private:
+	std::vector<HHSegmentsBlockInfo>& getDirectory(const SHARED_PTR<HHRouteRegionPointsCtx>& r);
+	SHARED_PTR<HHSegmentsBlock> getBlock(const SHARED_PTR<HHRouteRegionPointsCtx>& r, int blockIndex);
+	void evict();
+};
+
+#endif /*_OSMAND_HH_SEGMENTS_LOADER_H*/
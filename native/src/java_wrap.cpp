@@ -1,6 +1,8 @@
 #ifdef ANDROID_BUILD
 #include <dlfcn.h>
 #endif
+#include <thread>
+
 #include <SkBitmap.h>
 #include <SkCanvas.h>
 #include <SkCodec.h>
@@ -12,6 +14,7 @@
 #include "binaryRoutePlanner.h"
 #include "java_renderRules.h"
 #include "java_wrap.h"
+#include "nativeRoutingTile.h"
 
 #ifndef ANDROID_BUILD
 #include <gdal.h>
@@ -20,7 +23,10 @@
 
 #include "rendering.h"
 #include "routePlannerFrontEnd.h"
+#include "routeResultBuffer.h"
 #include "routingContext.h"
+#include "routingContextPool.h"
+#include "transportNetworkCache.h"
 #include "transportRoutePlanner.h"
 #include "transportRouteResult.h"
 #include "transportRouteResultSegment.h"
@@ -29,6 +35,7 @@
 #include "transportRoutingContext.h"
 #include "hhRouteDataStructure.h"
 #include "gpxRouteApproximation.h"
+#include "gpxStreamingApproximation.h"
 #include "Logging.h"
 
 JavaVM* globalJVM = NULL;
@@ -64,7 +71,7 @@ extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
 extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_deleteNativeRoutingContext(JNIEnv* ienv, jobject obj,
 																						   jlong searchResult) {
 	RoutingContext* result = (RoutingContext*)searchResult;
-	if (result != NULL) {
+	if (result != NULL && !RoutingContextPool::getInstance().release(result)) {
 		delete result;
 	}
 }
@@ -90,9 +97,30 @@ extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_closeBinaryMapFi
 	const char* utf = ienv->GetStringUTFChars((jstring)path, NULL);
 	std::string inputName(utf);
 	ienv->ReleaseStringUTFChars((jstring)path, utf);
+	// pooled contexts reference tiles of closed file, preload is stopped (joined) by clear
+	RoutingContextPool::getInstance().clear();
+	TransportNetworkCache::getInstance().clear();
 	closeBinaryMapFile(inputName);
 }
 
+extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_setNativeRoutingContextPoolSize(JNIEnv* ienv,
+																								jobject obj,
+																								jint size) {
+	RoutingContextPool::getInstance().setMaxSize(size);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_setNativeTransportNetworkCacheSize(JNIEnv* ienv,
+																								   jobject obj,
+																								   jint tiles) {
+	TransportNetworkCache::getInstance().setMaxTiles(tiles);
+}
+
+// Starts background loading of transport network of area (cache should be enabled)
+extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_preloadNativeTransportNetwork(
+	JNIEnv* ienv, jobject obj, jint zoom, jint left31, jint top31, jint right31, jint bottom31) {
+	TransportNetworkCache::getInstance().startPreload(zoom, left31, top31, right31, bottom31);
+}
+
 extern "C" JNIEXPORT jboolean JNICALL Java_net_osmand_NativeLibrary_initCacheMapFiles(JNIEnv* ienv, jobject obj,
 																					  jobject path) {
 	const char* utf = ienv->GetStringUTFChars((jstring)path, NULL);
@@ -107,13 +135,49 @@ extern "C" JNIEXPORT jboolean JNICALL Java_net_osmand_NativeLibrary_initBinaryMa
 	const char* utf = ienv->GetStringUTFChars((jstring)path, NULL);
 	std::string inputName(utf);
 	ienv->ReleaseStringUTFChars((jstring)path, utf);
+	// preload reads list of open files
+	TransportNetworkCache::getInstance().stopPreload();
 	BinaryMapFile* fl = initBinaryMapFile(inputName, useLive, false);
+	// tiles loaded by pooled contexts don't include new file
+	RoutingContextPool::getInstance().clear();
+	TransportNetworkCache::getInstance().clear();
 	if (fl == NULL) {
 		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Warning, "File %s was not initialized", inputName.c_str());
 	}
 	return fl != NULL;
 }
 
+// Initializes files in parallel, returns for every file whether it was initialized
+extern "C" JNIEXPORT jbooleanArray JNICALL Java_net_osmand_NativeLibrary_initBinaryMapFiles(JNIEnv* ienv,
+																							jobject obj,
+																							jobjectArray paths,
+																							jboolean useLive) {
+	std::vector<std::string> inputNames;
+	jsize size = ienv->GetArrayLength(paths);
+	for (jsize i = 0; i < size; i++) {
+		jstring path = (jstring)ienv->GetObjectArrayElement(paths, i);
+		inputNames.push_back(getString(ienv, path));
+		ienv->DeleteLocalRef(path);
+	}
+	int threads = std::max(1, (int)std::thread::hardware_concurrency());
+	TransportNetworkCache::getInstance().stopPreload();
+	std::vector<BinaryMapFile*> files = initBinaryMapFiles(inputNames, useLive, false, threads);
+	// tiles loaded by pooled contexts don't include new files
+	RoutingContextPool::getInstance().clear();
+	TransportNetworkCache::getInstance().clear();
+	UNORDERED(set)<std::string> initialized;
+	for (BinaryMapFile* file : files) {
+		initialized.insert(file->inputName);
+	}
+	std::vector<jboolean> result(size);
+	for (jsize i = 0; i < size; i++) {
+		result[i] = initialized.find(inputNames[i]) != initialized.end();
+	}
+	jbooleanArray jresult = ienv->NewBooleanArray(size);
+	ienv->SetBooleanArrayRegion(jresult, 0, size, result.data());
+	return jresult;
+}
+
 extern "C" JNIEXPORT jboolean JNICALL Java_net_osmand_NativeLibrary_initFontType(JNIEnv* ienv, jobject obj,
 																				 jstring path, jstring name,
 																				 jboolean bold, jboolean italic) {
@@ -484,6 +548,26 @@ extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_getGeotiffTil
 
 	return resultObject;
 }
+
+// Heights of roads without elevation tags are taken from heightmap files of directory (empty path disables it)
+extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_setNativeElevationTilePath(JNIEnv* ienv,
+																							 jobject obj,
+																							 jstring tilePath) {
+	const char* utfTilePath = ienv->GetStringUTFChars(tilePath, NULL);
+	std::string tifTilePath(utfTilePath);
+	ienv->ReleaseStringUTFChars(tilePath, utfTilePath);
+	// Terrain files could be downloaded or removed while path is changed, so opened files are not reused
+	GeotiffDatasetCache::getInstance().clear();
+	if (tifTilePath.empty()) {
+		ElevationProvider::setInstance(nullptr);
+		return;
+	}
+	if (!isGDALRegistered) {
+		isGDALRegistered = true;
+		GDALAllRegister();
+	}
+	ElevationProvider::setInstance(std::make_shared<GeotiffElevationProvider>(tifTilePath));
+}
 #endif
 
 ///////////////////////////////////////////////
@@ -1321,10 +1405,23 @@ jobject convertRenderedObjectToJava(JNIEnv* ienv, MapDataObject* robj, std::stri
 	return resobj;
 }
 
+// Index of Java routing regions by (filePointer << 31) + length
+UNORDERED(map)<int64_t, int> getRegionIndexes(JNIEnv* ienv, jobjectArray regions) {
+	UNORDERED(map)<int64_t, int> indexes;
+	for (int t = 0; t < ienv->GetArrayLength(regions); t++) {
+		jobject oreg = ienv->GetObjectArrayElement(regions, t);
+		int64_t fp = ienv->GetLongField(oreg, jfield_RouteRegion_filePointer);
+		int64_t ln = ienv->GetLongField(oreg, jfield_RouteRegion_length);
+		ienv->DeleteLocalRef(oreg);
+		indexes[(fp << 31) + ln] = t;
+	}
+	return indexes;
+}
+
 jobject convertRouteDataObjectToJava(JNIEnv* ienv, RouteDataObject* route, jobject reg) {
 	jintArray nameInts = ienv->NewIntArray(route->names.size());
 	jobjectArray nameStrings = ienv->NewObjectArray(route->names.size(), jclassString, NULL);
-	jint* ar = new jint[route->names.size()];  // NEVER DEALLOCATED
+	std::vector<jint> ar(route->names.size());
 	UNORDERED(map)<int, std::string>::iterator itNames = route->names.begin();
 	jsize sz = 0;
 	for (; itNames != route->names.end(); itNames++, sz++) {
@@ -1334,7 +1431,9 @@ jobject convertRouteDataObjectToJava(JNIEnv* ienv, RouteDataObject* route, jobje
 		ienv->DeleteLocalRef(js);
 		ar[sz] = itNames->first;
 	}
-	ienv->SetIntArrayRegion(nameInts, 0, route->names.size(), ar);
+	if (ar.size() > 0) {
+		ienv->SetIntArrayRegion(nameInts, 0, ar.size(), &ar[0]);
+	}
 	jobject robj = ienv->NewObject(jclass_RouteDataObject, jmethod_RouteDataObject_init, reg, nameInts, nameStrings);
 	ienv->DeleteLocalRef(nameInts);
 	ienv->DeleteLocalRef(nameStrings);
@@ -1465,20 +1564,10 @@ jobject convertRouteSegmentResultToJava(JNIEnv* ienv, SHARED_PTR<RouteSegmentRes
 	return resobj;
 }
 
-class NativeRoutingTile {
-   public:
-	std::vector<RouteDataObject*> result;
-	UNORDERED(map)<uint64_t, std::vector<RouteDataObject*>> cachedByLocations;
-};
-
 //	protected static native void deleteRouteSearchResult(long searchResultHandle!);
 extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_deleteRouteSearchResult(JNIEnv* ienv, jobject obj,
 																						jlong ref) {
 	NativeRoutingTile* t = (NativeRoutingTile*)ref;
-	for (unsigned int i = 0; i < t->result.size(); i++) {
-		delete t->result[i];
-		t->result[i] = NULL;
-	}
 	delete t;
 }
 
@@ -1837,15 +1926,123 @@ jobject convertGpxPointToJava(JNIEnv* ienv, SHARED_PTR<GpxPoint> result, UNORDER
 	return jGpxPoint;
 }
 
+// Key of everything parseRouteConfiguration reads (except evaluation rules which are defined by profile and parameters)
+// and of the data loaded into context, used to find pooled context for the same configuration
+std::string getRoutingContextPoolKey(JNIEnv* ienv, jobject jRouteConfig, bool basemap) {
+	std::string key = basemap ? "B" : "N";
+	jstring rName = (jstring)ienv->GetObjectField(jRouteConfig, jfield_RoutingConfiguration_routerName);
+	key += "|" + getString(ienv, rName);
+	ienv->DeleteLocalRef(rName);
+	key += "|" + std::to_string(ienv->GetIntField(jRouteConfig, jfield_RoutingConfiguration_planRoadDirection));
+	key += "|" + std::to_string(ienv->GetLongField(jRouteConfig, jfield_RoutingConfiguration_nativeMemoryLimitation));
+	key += "|" + std::to_string(ienv->GetFloatField(jRouteConfig, jfield_RoutingConfiguration_heuristicCoefficient));
+	key += "|" + std::to_string(ienv->GetFloatField(jRouteConfig, jfield_RoutingConfiguration_minPointApproximation));
+	key += "|" + std::to_string(ienv->GetFloatField(jRouteConfig, jfield_RoutingConfiguration_minStepApproximation));
+	key += "|" + std::to_string(ienv->GetFloatField(jRouteConfig, jfield_RoutingConfiguration_maxStepApproximation));
+	key += "|" + std::to_string(ienv->GetFloatField(jRouteConfig, jfield_RoutingConfiguration_smoothenPointsNoRoute));
+	key += "|" + std::to_string(
+					 ienv->GetDoubleField(jRouteConfig, jfield_RoutingConfiguration_penaltyForReverseDirection));
+	key += "|" + std::to_string(ienv->GetIntField(jRouteConfig, jfield_RoutingConfiguration_ZOOM_TO_LOAD_TILES));
+	// conditional tags are applied while tiles are loaded
+	key += "|" + std::to_string(ienv->GetLongField(jRouteConfig, jfield_RoutingConfiguration_routeCalculationTime) / 1000);
+
+	jobject router = ienv->GetObjectField(jRouteConfig, jfield_RoutingConfiguration_router);
+	key += "|" + std::to_string(ienv->GetBooleanField(router, jfield_GeneralRouter_restrictionsAware));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_sharpTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_shortWaySharpTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_slightTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_shortWaySlightTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_roundaboutTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_shortWayRoundaboutTurn));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_minSpeed));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_defaultSpeed));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_maxSpeed));
+	key += "|" + std::to_string(ienv->GetFloatField(router, jfield_GeneralRouter_maxVehicleSpeed));
+	key += "|" + std::to_string(ienv->GetBooleanField(router, jfield_GeneralRouter_heightObstacles));
+	key += "|" + std::to_string(ienv->GetBooleanField(router, jfield_GeneralRouter_shortestRoute));
+	jobjectArray ar = (jobjectArray)ienv->GetObjectField(router, jfield_GeneralRouter_hhNativeFilter);
+	for (auto& v : convertJArrayToStrings(ienv, ar)) {
+		key += "|f:" + v;
+	}
+	ienv->DeleteLocalRef(ar);
+	ar = (jobjectArray)ienv->GetObjectField(router, jfield_GeneralRouter_hhNativeParameterValues);
+	for (auto& v : convertJArrayToStrings(ienv, ar)) {
+		key += "|p:" + v;
+	}
+	ienv->DeleteLocalRef(ar);
+	jobjectArray objectAttributes = (jobjectArray)ienv->GetObjectField(router, jfield_GeneralRouter_objectAttributes);
+	for (int i = 0; i < ienv->GetArrayLength(objectAttributes); i++) {
+		jobject ctx = ienv->GetObjectArrayElement(objectAttributes, i);
+		key += "|a" + std::to_string(i);
+		ar = (jobjectArray)ienv->CallObjectMethod(ctx, jmethod_RouteAttributeContext_getParamKeys);
+		for (auto& v : convertJArrayToStrings(ienv, ar)) {
+			key += ":" + v;
+		}
+		ienv->DeleteLocalRef(ar);
+		ar = (jobjectArray)ienv->CallObjectMethod(ctx, jmethod_RouteAttributeContext_getParamValues);
+		for (auto& v : convertJArrayToStrings(ienv, ar)) {
+			key += "=" + v;
+		}
+		ienv->DeleteLocalRef(ar);
+		ienv->DeleteLocalRef(ctx);
+	}
+	ienv->DeleteLocalRef(objectAttributes);
+	jlongArray impassableRoadIds =
+		(jlongArray)ienv->CallObjectMethod(router, jmethod_GeneralRouter_getImpassableRoadIds);
+	if (impassableRoadIds != NULL) {
+		jsize size = ienv->GetArrayLength(impassableRoadIds);
+		std::vector<jlong> ids(size);
+		if (size > 0) {
+			ienv->GetLongArrayRegion(impassableRoadIds, 0, size, &ids[0]);
+		}
+		for (jlong id : ids) {
+			key += "|i" + std::to_string(id);
+		}
+		ienv->DeleteLocalRef(impassableRoadIds);
+	}
+	ienv->DeleteLocalRef(router);
+	// direction points are connected to roads while tiles are loaded
+	jobjectArray directionPoints =
+		(jobjectArray)ienv->CallObjectMethod(jRouteConfig, jmethod_RoutingConfiguration_getDirectionPoints);
+	for (int j = 0; j < ienv->GetArrayLength(directionPoints); j++) {
+		jobject jdp = ienv->GetObjectArrayElement(directionPoints, j);
+		key += "|d" + std::to_string(ienv->GetIntField(jdp, jfield_DirectionPoint_x31)) + "," +
+			   std::to_string(ienv->GetIntField(jdp, jfield_DirectionPoint_y31));
+		jobjectArray tagsKeyValue = (jobjectArray)ienv->GetObjectField(jdp, jfield_DirectionPoint_tags);
+		for (int t = 0; t < ienv->GetArrayLength(tagsKeyValue); t++) {
+			jobjectArray jstrArr = (jobjectArray)ienv->GetObjectArrayElement(tagsKeyValue, t);
+			for (auto& v : convertJArrayToStrings(ienv, jstrArr)) {
+				key += ":" + v;
+			}
+			ienv->DeleteLocalRef(jstrArr);
+		}
+		ienv->DeleteLocalRef(tagsKeyValue);
+		ienv->DeleteLocalRef(jdp);
+	}
+	ienv->DeleteLocalRef(directionPoints);
+	return key;
+}
+
 RoutingContext* getRoutingContext(JNIEnv* ienv, jobject jCtx, jfloat initDirection, bool basemap, jobject progress) {
 	jobject jRouteConfig = ienv->GetObjectField(jCtx, jfield_RoutingContext_config);
 
 	RoutingContext* c = (RoutingContext*)ienv->GetLongField(jCtx, jfield_RoutingContext_nativeRoutingContext);
 	if (c == NULL) {
-		SHARED_PTR<RoutingConfiguration> config =
-			SHARED_PTR<RoutingConfiguration>(new RoutingConfiguration(initDirection));
-		parseRouteConfiguration(ienv, config, jRouteConfig);
-		c = new RoutingContext(config);
+		RoutingContextPool& pool = RoutingContextPool::getInstance();
+		std::string poolKey;
+		if (pool.isEnabled()) {
+			poolKey = getRoutingContextPoolKey(ienv, jRouteConfig, basemap);
+			c = pool.acquire(poolKey);
+		}
+		if (c == NULL) {
+			SHARED_PTR<RoutingConfiguration> config =
+				SHARED_PTR<RoutingConfiguration>(new RoutingConfiguration(initDirection));
+			parseRouteConfiguration(ienv, config, jRouteConfig);
+			c = new RoutingContext(config);
+			if (!poolKey.empty()) {
+				pool.attach(c, poolKey);
+			}
+		}
 		ienv->SetLongField(jCtx, jfield_RoutingContext_nativeRoutingContext, (jlong)c);
 	}
 	c->config->initialDirection = initDirection;
@@ -1946,14 +2143,7 @@ extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_nativeSearchG
 	rpfe->setUseGeometryBasedApproximation(useGeo);
 	rpfe->searchGpxRoute(r, gpxPoints);
 	jobject jResult = ienv->NewObject(jclass_GpxRouteApproximationResult, jmethod_GpxRouteApproximationResult_init);
-	UNORDERED(map)<int64_t, int> indexes;
-	for (int t = 0; t < ienv->GetArrayLength(regions); t++) {
-		jobject oreg = ienv->GetObjectArrayElement(regions, t);
-		int64_t fp = ienv->GetLongField(oreg, jfield_RouteRegion_filePointer);
-		int64_t ln = ienv->GetLongField(oreg, jfield_RouteRegion_length);
-		ienv->DeleteLocalRef(oreg);
-		indexes[(fp << 31) + ln] = t;
-	}
+	UNORDERED(map)<int64_t, int> indexes = getRegionIndexes(ienv, regions);
 	for (uint i = 0; i < r->fullRoute.size(); i++) {
 		jobject resobj = convertRouteSegmentResultToJava(ienv, r->fullRoute[i], indexes, regions);
 		ienv->CallVoidMethod(jResult, jmethod_GpxRouteApproximationResult_addResultSegment, resobj);
@@ -1967,8 +2157,72 @@ extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_nativeSearchG
 	return jResult;
 }
 
-extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeRouting(
-	JNIEnv* ienv, jobject obj, jobject jCtx, jobject jHHConfig, jfloat initDirection, jobjectArray regions, bool basemap) {
+// Native state of streaming GPX approximation, owns own routing context (it lives between JNI calls)
+struct GpxStreamHandle {
+	SHARED_PTR<RoutingContext> ctx;
+	RoutePlannerFrontEnd router;
+	SHARED_PTR<GpxStreamingApproximation> stream;
+	vector<SHARED_PTR<RouteSegmentResult>> emitted;
+};
+
+jobjectArray convertGpxStreamSegmentsToJava(JNIEnv* ienv, GpxStreamHandle* h, jobjectArray regions) {
+	UNORDERED(map)<int64_t, int> indexes = getRegionIndexes(ienv, regions);
+	jobjectArray res = ienv->NewObjectArray(h->emitted.size(), jclass_RouteSegmentResult, NULL);
+	for (uint i = 0; i < h->emitted.size(); i++) {
+		jobject resobj = convertRouteSegmentResultToJava(ienv, h->emitted[i], indexes, regions);
+		ienv->SetObjectArrayElement(res, i, resobj);
+		ienv->DeleteLocalRef(resobj);
+	}
+	h->emitted.clear();
+	return res;
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_net_osmand_NativeLibrary_nativeCreateGpxStreamApproximation(
+	JNIEnv* ienv, jobject obj, jobject jCtx, jboolean useGeo, jdouble lagDistance) {
+	jobject jRouteConfig = ienv->GetObjectField(jCtx, jfield_RoutingContext_config);
+	SHARED_PTR<RoutingConfiguration> config = SHARED_PTR<RoutingConfiguration>(new RoutingConfiguration(NO_DIRECTION));
+	parseRouteConfiguration(ienv, config, jRouteConfig);
+	ienv->DeleteLocalRef(jRouteConfig);
+
+	GpxStreamHandle* h = new GpxStreamHandle();
+	h->ctx = SHARED_PTR<RoutingContext>(new RoutingContext(config));
+	h->ctx->setConditionalTime(config->routeCalculationTime);
+	h->router.setUseGeometryBasedApproximation(useGeo);
+	h->stream = std::make_shared<GpxStreamingApproximation>(
+		&h->router, h->ctx.get(), lagDistance, [h](const vector<SHARED_PTR<RouteSegmentResult>>& segments) {
+			h->emitted.insert(h->emitted.end(), segments.begin(), segments.end());
+		});
+	return (jlong)h;
+}
+
+// Adds points to stream, returns route segments settled by them
+extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeAddGpxStreamPoints(
+	JNIEnv* ienv, jobject obj, jlong handle, jdoubleArray jLats, jdoubleArray jLons, jobjectArray regions) {
+	GpxStreamHandle* h = (GpxStreamHandle*)handle;
+	jsize size = ienv->GetArrayLength(jLats);
+	jdouble* lats = ienv->GetDoubleArrayElements(jLats, NULL);
+	jdouble* lons = ienv->GetDoubleArrayElements(jLons, NULL);
+	for (jsize i = 0; i < size; i++) {
+		h->stream->addPoint(lats[i], lons[i]);
+	}
+	ienv->ReleaseDoubleArrayElements(jLats, lats, JNI_ABORT);
+	ienv->ReleaseDoubleArrayElements(jLons, lons, JNI_ABORT);
+	return convertGpxStreamSegmentsToJava(ienv, h, regions);
+}
+
+// Returns the rest of route and deletes native stream
+extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeFinishGpxStreamApproximation(
+	JNIEnv* ienv, jobject obj, jlong handle, jobjectArray regions) {
+	GpxStreamHandle* h = (GpxStreamHandle*)handle;
+	h->stream->finish();
+	jobjectArray res = convertGpxStreamSegmentsToJava(ienv, h, regions);
+	delete h;
+	return res;
+}
+
+// Calculates route (HH or BRP) and updates progress of Java routing context
+vector<SHARED_PTR<RouteSegmentResult>> calculateNativeRoute(JNIEnv* ienv, jobject jCtx, jobject jHHConfig,
+															jfloat initDirection, bool basemap) {
 	jobject precalculatedRoute = ienv->GetObjectField(jCtx, jfield_RoutingContext_precalculatedRouteDirection);
 	jobject progress = ienv->GetObjectField(jCtx, jfield_RoutingContext_calculationProgress);
 
@@ -1984,22 +2238,8 @@ extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeRo
 	} else {
 		r = searchRouteInternal(c, false); // BRP-cpp: do direct call to binaryRoutePlanner.cpp
 	}
-	UNORDERED(map)<int64_t, int> indexes;
-	for (int t = 0; t < ienv->GetArrayLength(regions); t++) {
-		jobject oreg = ienv->GetObjectArrayElement(regions, t);
-		int64_t fp = ienv->GetLongField(oreg, jfield_RouteRegion_filePointer);
-		int64_t ln = ienv->GetLongField(oreg, jfield_RouteRegion_length);
-		ienv->DeleteLocalRef(oreg);
-		indexes[(fp << 31) + ln] = t;
-	}
-
-	// convert results
-	jobjectArray res = ienv->NewObjectArray(r.size(), jclass_RouteSegmentResult, NULL);
 	for (uint i = 0; i < r.size(); i++) {
 		clearDirectionPointFromRouteResult(r[i]);
-		jobject resobj = convertRouteSegmentResultToJava(ienv, r[i], indexes, regions);
-		ienv->SetObjectArrayElement(res, i, resobj);
-		ienv->DeleteLocalRef(resobj);
 	}
 	if (c->finalRouteSegment.get() != NULL) {
 		ienv->SetFloatField(progress, jfield_RouteCalculationProgress_routingCalculatedTime,
@@ -2045,13 +2285,96 @@ extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeRo
 	}
 	deleteRoutingContext(c, ienv, jCtx);
 	fflush(stdout);
+	return r;
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_nativeRouting(
+	JNIEnv* ienv, jobject obj, jobject jCtx, jobject jHHConfig, jfloat initDirection, jobjectArray regions, bool basemap) {
+	vector<SHARED_PTR<RouteSegmentResult>> r = calculateNativeRoute(ienv, jCtx, jHHConfig, initDirection, basemap);
+	UNORDERED(map)<int64_t, int> indexes = getRegionIndexes(ienv, regions);
+
+	// convert results
+	jobjectArray res = ienv->NewObjectArray(r.size(), jclass_RouteSegmentResult, NULL);
+	for (uint i = 0; i < r.size(); i++) {
+		jobject resobj = convertRouteSegmentResultToJava(ienv, r[i], indexes, regions);
+		ienv->SetObjectArrayElement(res, i, resobj);
+		ienv->DeleteLocalRef(resobj);
+	}
 	return res;
 }
 
+// Same as nativeRouting but result is written into one binary buffer (see routeResultBuffer.h) which Java decodes
+// lazily, returns handle of buffer (0 if route isn't found) which should be deleted by deleteRouteResultBuffer
+extern "C" JNIEXPORT jlong JNICALL Java_net_osmand_NativeLibrary_nativeRoutingBuffer(
+	JNIEnv* ienv, jobject obj, jobject jCtx, jobject jHHConfig, jfloat initDirection, jobjectArray regions, bool basemap) {
+	vector<SHARED_PTR<RouteSegmentResult>> r = calculateNativeRoute(ienv, jCtx, jHHConfig, initDirection, basemap);
+	if (r.size() == 0) {
+		return 0;
+	}
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+	RouteResultBuffer* buffer = new RouteResultBuffer();
+	buffer->write(r, getRegionIndexes(ienv, regions));
+	timer.Pause();
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Route result buffer %d segments, %d bytes, %.2f ms",
+					  (int)r.size(), (int)buffer->data.size(), timer.GetElapsedMicros() / 1000.0);
+	return (jlong)buffer;
+}
+
+// Direct buffer is valid until deleteRouteResultBuffer
+extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_getRouteResultBuffer(JNIEnv* ienv, jobject obj,
+																						  jlong handle) {
+	RouteResultBuffer* buffer = (RouteResultBuffer*)handle;
+	if (buffer == NULL || buffer->data.empty()) {
+		return NULL;
+	}
+	return ienv->NewDirectByteBuffer(&buffer->data[0], buffer->data.size());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_net_osmand_NativeLibrary_deleteRouteResultBuffer(JNIEnv* ienv, jobject obj,
+																					  jlong handle) {
+	RouteResultBuffer* buffer = (RouteResultBuffer*)handle;
+	if (buffer != NULL) {
+		delete buffer;
+	}
+}
+
+// Time-dependent sweep (see searchRouteSweep): route between start and target of context is calculated for every
+// departure time (ms), returns routing time in seconds for every departure (-1 if route isn't found)
+extern "C" JNIEXPORT jfloatArray JNICALL Java_net_osmand_NativeLibrary_nativeRoutingSweep(
+	JNIEnv* ienv, jobject obj, jobject jCtx, jfloat initDirection, jlongArray jDepartureTimes, bool basemap) {
+	jobject precalculatedRoute = ienv->GetObjectField(jCtx, jfield_RoutingContext_precalculatedRouteDirection);
+	jobject progress = ienv->GetObjectField(jCtx, jfield_RoutingContext_calculationProgress);
+
+	RoutingContext* c = getRoutingContext(ienv, jCtx, initDirection, basemap, progress);
+	parsePrecalculatedRoute(ienv, c, precalculatedRoute);
+
+	vector<time_t> departureTimes;
+	jsize sz = ienv->GetArrayLength(jDepartureTimes);
+	jlong* times = ienv->GetLongArrayElements(jDepartureTimes, NULL);
+	for (jsize i = 0; i < sz; i++) {
+		departureTimes.push_back(times[i] / 1000);
+	}
+	ienv->ReleaseLongArrayElements(jDepartureTimes, times, JNI_ABORT);
+
+	vector<float> routingTimes = searchRouteSweep(c, departureTimes);
+	jfloatArray res = ienv->NewFloatArray(routingTimes.size());
+	if (!routingTimes.empty()) {
+		ienv->SetFloatArrayRegion(res, 0, routingTimes.size(), &routingTimes[0]);
+	}
+	ienv->DeleteLocalRef(progress);
+	ienv->DeleteLocalRef(precalculatedRoute);
+	deleteRoutingContext(c, ienv, jCtx);
+	return res;
+}
+
+
 void deleteRoutingContext(RoutingContext* c, JNIEnv* ienv, jobject jCtx) {
 	if (c != NULL && !ienv->GetBooleanField(jCtx, jfield_RoutingContext_keepNativeRoutingContext)) {
 		ienv->SetLongField(jCtx, jfield_RoutingContext_nativeRoutingContext, 0);
-		delete c;
+		if (!RoutingContextPool::getInstance().release(c)) {
+			delete c;
+		}
 	}
 }
 
@@ -2089,6 +2412,13 @@ void parseTransportRoutingConfiguration(JNIEnv* ienv, shared_ptr<TransportRoutin
 	rConfig->router->defaultSpeed = ienv->GetFloatField(router, jfield_GeneralRouter_defaultSpeed);
 	rConfig->router->maxSpeed = ienv->GetFloatField(router, jfield_GeneralRouter_maxSpeed);
 	rConfig->router->maxVehicleSpeed = ienv->GetFloatField(router, jfield_GeneralRouter_maxVehicleSpeed);
+	vector<string> params = convertJArrayToStrings(
+		ienv, (jobjectArray)ienv->GetObjectField(router, jfield_GeneralRouter_hhNativeParameterValues));
+	for (int i = 0; i + 1 < params.size(); i += 2) {
+		if (params[i] == "useRaptor") {
+			rConfig->useRaptor = params[i + 1] == "true";
+		}
+	}
 
 	jobjectArray objectAttributes = (jobjectArray)ienv->GetObjectField(router, jfield_GeneralRouter_objectAttributes);
 	for (int i = 0; i < ienv->GetArrayLength(objectAttributes); i++) {
@@ -2382,8 +2712,8 @@ extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_getRoute
 																							jobject reg, jlong ref,
 																							jint x31, jint y31) {
 	NativeRoutingTile* t = (NativeRoutingTile*)ref;
-	uint64_t lr = ((uint64_t)x31 << 31) + y31;
-	std::vector<RouteDataObject*> collected = t->cachedByLocations[lr];
+	std::vector<RouteDataObject*> collected;
+	t->getObjectsAt(x31, y31, collected);
 	jobjectArray res = ienv->NewObjectArray(collected.size(), jclass_RouteDataObject, NULL);
 	for (jint i = 0; i < (int)collected.size(); i++) {
 		jobject robj = convertRouteDataObjectToJava(ienv, collected[i], reg);
@@ -2392,6 +2722,78 @@ extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_getRoute
 	}
 	return res;
 }
+
+//	protected static native RouteDataObject getRoutingTileObject(RouteRegion reg, long ref, int index);
+extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_getRoutingTileObject(JNIEnv* ienv, jobject obj,
+																						jobject reg, jlong ref,
+																						jint index) {
+	NativeRoutingTile* t = (NativeRoutingTile*)ref;
+	if (t == NULL || index < 0 || index >= (jint)t->result.size()) {
+		return NULL;
+	}
+	return convertRouteDataObjectToJava(ienv, t->result[index], reg);
+}
+
+// Returns for every point (x31[i], y31[i]) count of segments at it followed by pairs of road index and point index
+// (null if lengths of x31 and y31 differ)
+//	protected static native int[] getRoutingTileSegmentsAt(long ref, int[] x31, int[] y31);
+extern "C" JNIEXPORT jintArray JNICALL Java_net_osmand_NativeLibrary_getRoutingTileSegmentsAt(
+	JNIEnv* ienv, jobject obj, jlong ref, jintArray jx31, jintArray jy31) {
+	NativeRoutingTile* t = (NativeRoutingTile*)ref;
+	jsize size = ienv->GetArrayLength(jx31);
+	if (ienv->GetArrayLength(jy31) != size) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Routing tile segments: %d x31 and %d y31 coordinates",
+						  (int)size, (int)ienv->GetArrayLength(jy31));
+		return NULL;
+	}
+	jint* x31 = ienv->GetIntArrayElements(jx31, NULL);
+	jint* y31 = ienv->GetIntArrayElements(jy31, NULL);
+	std::vector<int32_t> segments;
+	for (jsize i = 0; i < size; i++) {
+		size_t countIndex = segments.size();
+		segments.push_back(0);
+		if (t != NULL) {
+			t->getSegmentsAt(x31[i], y31[i], segments);
+		}
+		segments[countIndex] = (segments.size() - countIndex - 1) / 2;
+	}
+	ienv->ReleaseIntArrayElements(jx31, x31, JNI_ABORT);
+	ienv->ReleaseIntArrayElements(jy31, y31, JNI_ABORT);
+	jintArray res = ienv->NewIntArray(segments.size());
+	if (segments.size() > 0) {
+		ienv->SetIntArrayRegion(res, 0, segments.size(), (jint*)&segments[0]);
+	}
+	return res;
+}
+
+// Returns road index, point index (segment is point - 1, point), x31, y31 of projection and distance in
+// centimeters or null if there is no segment within radius
+//	protected static native int[] findRoutingTileNearestSegment(long ref, int x31, int y31, double radius);
+extern "C" JNIEXPORT jintArray JNICALL Java_net_osmand_NativeLibrary_findRoutingTileNearestSegment(
+	JNIEnv* ienv, jobject obj, jlong ref, jint x31, jint y31, jdouble radius) {
+	NativeRoutingTile* t = (NativeRoutingTile*)ref;
+	jint r[5];
+	double distance;
+	if (t == NULL || !t->findNearestSegment(x31, y31, radius, r[0], r[1], r[2], r[3], distance)) {
+		return NULL;
+	}
+	r[4] = (jint)(distance * 100);
+	jintArray res = ienv->NewIntArray(5);
+	ienv->SetIntArrayRegion(res, 0, 5, r);
+	return res;
+}
+
+// Geometry of all roads of tile (see NativeRoutingTile::writeGeometry), valid until deleteRouteSearchResult
+//	protected static native ByteBuffer getRoutingTileGeometry(long ref);
+extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_getRoutingTileGeometry(JNIEnv* ienv, jobject obj,
+																						  jlong ref) {
+	NativeRoutingTile* t = (NativeRoutingTile*)ref;
+	if (t == NULL) {
+		return NULL;
+	}
+	const std::vector<int32_t>& geometry = t->writeGeometry();
+	return ienv->NewDirectByteBuffer((void*)&geometry[0], geometry.size() * sizeof(int32_t));
+}
 // protected static native boolean searchRenderedObjects(RenderingContext context, int x, int y, boolean notvisible);
 extern "C" JNIEXPORT jobjectArray JNICALL Java_net_osmand_NativeLibrary_searchRenderedObjects(JNIEnv* ienv, jobject obj,
 																							  jobject context, jint x,
@@ -2481,17 +2883,7 @@ extern "C" JNIEXPORT jobject JNICALL Java_net_osmand_NativeLibrary_loadRoutingDa
 		return ienv->NewObject(jclass_NativeRouteSearchResult, jmethod_NativeRouteSearchResult_init, ((jlong)0), res);
 	} else {
 		NativeRoutingTile* r = new NativeRoutingTile();
-		for (jint i = 0; i < (int)result.size(); i++) {
-			if (result[i] != NULL) {
-				r->result.push_back(result[i]);
-				for (jint j = 0; j < (int)result[i]->pointsX.size(); j++) {
-					jint x = result[i]->pointsX[j];
-					jint y = result[i]->pointsY[j];
-					uint64_t lr = ((uint64_t)x << 31) + y;
-					r->cachedByLocations[lr].push_back(result[i]);
-				}
-			}
-		}
+		r->init(result);
 		jlong ref = (jlong)r;
 		if (r->result.size() == 0) {
 			ref = 0;
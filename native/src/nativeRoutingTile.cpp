@@ -0,0 +1,161 @@
+#ifndef _OSMAND_NATIVE_ROUTING_TILE_CPP
+#define _OSMAND_NATIVE_ROUTING_TILE_CPP
+#include "nativeRoutingTile.h"
+
+#include <algorithm>
+
+#include "binaryRead.h"
+
+// length of x31 (and y31) unit at equator in meters
+static const double METERS_IN_TILE_UNIT_31 = 40075016.686 / (1u << 31);
+
+NativeRoutingTile::~NativeRoutingTile() {
+	for (uint32_t i = 0; i < result.size(); i++) {
+		delete result[i];
+		result[i] = NULL;
+	}
+}
+
+void NativeRoutingTile::init(std::vector<RouteDataObject*>& objects) {
+	size_t points = 0;
+	for (RouteDataObject* o : objects) {
+		if (o != NULL) {
+			result.push_back(o);
+			points += o->pointsX.size();
+		}
+	}
+	objects.clear();
+	pointsIndex.reserve(points);
+	bboxes.reserve(result.size() * 4);
+	for (uint32_t i = 0; i < result.size(); i++) {
+		RouteDataObject* o = result[i];
+		uint32_t left = UINT32_MAX, top = UINT32_MAX, right = 0, bottom = 0;
+		for (uint32_t j = 0; j < o->pointsX.size(); j++) {
+			uint32_t x = o->pointsX[j];
+			uint32_t y = o->pointsY[j];
+			pointsIndex.push_back({toLocation(x, y), i, j});
+			left = std::min(left, x);
+			right = std::max(right, x);
+			top = std::min(top, y);
+			bottom = std::max(bottom, y);
+		}
+		bboxes.push_back(left);
+		bboxes.push_back(top);
+		bboxes.push_back(right);
+		bboxes.push_back(bottom);
+		size_t gridSize = segmentGrid.roads.size();
+		segmentGrid.addRoad(SHARED_PTR<RouteDataObject>(o, [](RouteDataObject*) {}));
+		if (segmentGrid.roads.size() > gridSize) {
+			gridRoads.push_back(i);
+		} else {
+			otherRoads.push_back(i);
+		}
+	}
+	std::sort(pointsIndex.begin(), pointsIndex.end());
+}
+
+void NativeRoutingTile::getObjectsAt(uint32_t x31, uint32_t y31, std::vector<RouteDataObject*>& objects) {
+	PointEntry key = {toLocation(x31, y31), 0, 0};
+	auto it = std::lower_bound(pointsIndex.begin(), pointsIndex.end(), key);
+	int64_t last = -1;
+	for (; it != pointsIndex.end() && it->location == key.location; it++) {
+		if (it->object != last) {
+			objects.push_back(result[it->object]);
+			last = it->object;
+		}
+	}
+}
+
+void NativeRoutingTile::getSegmentsAt(uint32_t x31, uint32_t y31, std::vector<int32_t>& segments) {
+	PointEntry key = {toLocation(x31, y31), 0, 0};
+	auto it = std::lower_bound(pointsIndex.begin(), pointsIndex.end(), key);
+	for (; it != pointsIndex.end() && it->location == key.location; it++) {
+		segments.push_back(it->object);
+		segments.push_back(it->point);
+	}
+}
+
+void NativeRoutingTile::checkSegment(uint32_t x31, uint32_t y31, uint32_t object, uint32_t point, bool& found,
+									 double& distance, int32_t& nearestObject, int32_t& nearestPoint,
+									 int32_t& projX31, int32_t& projY31) {
+	RouteDataObject* o = result[object];
+	std::pair<int, int> p;
+	if (o->pointsX.size() == 1) {
+		p = std::make_pair((int)o->pointsX[0], (int)o->pointsY[0]);
+	} else {
+		p = getProjectionPoint(x31, y31, o->pointsX[point - 1], o->pointsY[point - 1], o->pointsX[point],
+							   o->pointsY[point]);
+	}
+	double dist = squareRootDist31(x31, y31, p.first, p.second);
+	if (dist <= distance) {
+		found = true;
+		distance = dist;
+		nearestObject = object;
+		nearestPoint = point;
+		projX31 = p.first;
+		projY31 = p.second;
+	}
+}
+
+bool NativeRoutingTile::findNearestSegment(uint32_t x31, uint32_t y31, double radius, int32_t& object,
+										   int32_t& point, int32_t& projX31, int32_t& projY31, double& distance) {
+	// both x31 and y31 units get shorter by cos(lat) in mercator
+	double radius31 = radius / (METERS_IN_TILE_UNIT_31 * cos(get31LatitudeY(y31) / 180 * M_PI)) + 1;
+	bool found = false;
+	distance = radius;
+	// grid query finds all roads closer than 3/4 of cell
+	if (radius31 <= (1 << (31 - RouteSegmentGrid::ZOOM)) * 3 / 4) {
+		UNORDERED(map)<uint32_t, std::pair<int, double>> nearest;
+		segmentGrid.findNearestSegments(x31, y31, nearest);
+		for (const auto& n : nearest) {
+			checkSegment(x31, y31, gridRoads[n.first], n.second.first, found, distance, object, point, projX31,
+						 projY31);
+		}
+		for (uint32_t i : otherRoads) {
+			RouteDataObject* o = result[i];
+			for (uint32_t j = o->pointsX.size() == 1 ? 0 : 1; j < o->pointsX.size(); j++) {
+				checkSegment(x31, y31, i, j, found, distance, object, point, projX31, projY31);
+			}
+		}
+		return found;
+	}
+	int64_t left = (int64_t)x31 - (int64_t)radius31;
+	int64_t right = (int64_t)x31 + (int64_t)radius31;
+	int64_t top = (int64_t)y31 - (int64_t)radius31;
+	int64_t bottom = (int64_t)y31 + (int64_t)radius31;
+	for (uint32_t i = 0; i < result.size(); i++) {
+		const uint32_t* bbox = &bboxes[i * 4];
+		if (bbox[0] > right || bbox[2] < left || bbox[1] > bottom || bbox[3] < top) {
+			continue;
+		}
+		RouteDataObject* o = result[i];
+		for (uint32_t j = o->pointsX.size() == 1 ? 0 : 1; j < o->pointsX.size(); j++) {
+			checkSegment(x31, y31, i, j, found, distance, object, point, projX31, projY31);
+		}
+	}
+	return found;
+}
+
+const std::vector<int32_t>& NativeRoutingTile::writeGeometry() {
+	if (!geometry.empty()) {
+		return geometry;
+	}
+	size_t size = 1;
+	for (RouteDataObject* o : result) {
+		size += 4 + o->types.size() + 2 * o->pointsX.size();
+	}
+	geometry.reserve(size);
+	geometry.push_back((int32_t)result.size());
+	for (RouteDataObject* o : result) {
+		geometry.push_back((int32_t)(o->id & 0xffffffff));
+		geometry.push_back((int32_t)((uint64_t)o->id >> 32));
+		geometry.push_back((int32_t)o->types.size());
+		geometry.insert(geometry.end(), o->types.begin(), o->types.end());
+		geometry.push_back((int32_t)o->pointsX.size());
+		geometry.insert(geometry.end(), o->pointsX.begin(), o->pointsX.end());
+		geometry.insert(geometry.end(), o->pointsY.begin(), o->pointsY.end());
+	}
+	return geometry;
+}
+
+#endif /*_OSMAND_NATIVE_ROUTING_TILE_CPP*/
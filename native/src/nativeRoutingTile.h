@@ -0,0 +1,67 @@
+#ifndef _OSMAND_NATIVE_ROUTING_TILE_H
+#define _OSMAND_NATIVE_ROUTING_TILE_H
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+#include "routeSegmentGrid.h"
+
+struct RouteDataObject;
+
+// Roads of routing subregion loaded for Java-side routing. Roads stay native and are found by
+// sorted index of their points (exact location) or by grid of segments (nearest segment), so only
+// requested roads are converted to Java objects.
+class NativeRoutingTile {
+	struct PointEntry {
+		uint64_t location;
+		uint32_t object;
+		uint32_t point;
+
+		bool operator<(const PointEntry& other) const {
+			return location < other.location || (location == other.location && object < other.object) ||
+				   (location == other.location && object == other.object && point < other.point);
+		}
+	};
+
+	std::vector<PointEntry> pointsIndex;
+	// left, top, right, bottom of every road (radius is larger than grid covers)
+	std::vector<uint32_t> bboxes;
+	// segments of roads (grid doesn't own roads), index of road in result for every road of grid
+	RouteSegmentGrid segmentGrid;
+	std::vector<uint32_t> gridRoads;
+	// roads which are not in grid (single point or the same id)
+	std::vector<uint32_t> otherRoads;
+
+	static uint64_t toLocation(uint32_t x31, uint32_t y31) {
+		return ((uint64_t)x31 << 31) + y31;
+	}
+
+	// Checks segment (point - 1, point) or the only point of road and keeps it if it is the nearest one
+	void checkSegment(uint32_t x31, uint32_t y31, uint32_t object, uint32_t point, bool& found, double& distance,
+					  int32_t& nearestObject, int32_t& nearestPoint, int32_t& projX31, int32_t& projY31);
+
+   public:
+	std::vector<RouteDataObject*> result;
+	// x31, y31 of all points of all roads (see writeGeometry), built on first request
+	std::vector<int32_t> geometry;
+
+	~NativeRoutingTile();
+
+	// Takes ownership of roads and builds index
+	void init(std::vector<RouteDataObject*>& objects);
+
+	// Roads which have point exactly at x31, y31 (every road once)
+	void getObjectsAt(uint32_t x31, uint32_t y31, std::vector<RouteDataObject*>& objects);
+
+	// Pairs of road index and point index at x31, y31
+	void getSegmentsAt(uint32_t x31, uint32_t y31, std::vector<int32_t>& segments);
+
+	// Finds segment (point - 1, point) of road nearest to x31, y31 within radius (meters),
+	// returns false if there is no such segment
+	bool findNearestSegment(uint32_t x31, uint32_t y31, double radius, int32_t& object, int32_t& point,
+							int32_t& projX31, int32_t& projY31, double& distance);
+
+	// Geometry of all roads (native order int32): count of roads, for every road low and high part of id,
+	// count of types, types, count of points, x31 of points, y31 of points
+	const std::vector<int32_t>& writeGeometry();
+};
+
+#endif /*_OSMAND_NATIVE_ROUTING_TILE_H*/
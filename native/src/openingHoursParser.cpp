@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <cstring>
 #include <set>
 
@@ -10,6 +11,8 @@
 static const int LOW_TIME_LIMIT = 120;
 static const int WITHOUT_TIME_LIMIT = -1;
 static const int CURRENT_DAY_TIME_LIMIT = -2;
+// dates kept by CompiledOpeningHours for rules which aren't weekly
+static const int MAX_COMPILED_DATES = 366;
 
 static StringsHolder stringsHolder;
 
@@ -934,6 +937,18 @@ int OpeningHoursParser::BasicOpeningHourRule::calculate(const tm& dateTime) cons
 	return 0;
 }
 
+bool OpeningHoursParser::BasicOpeningHourRule::isWeekly() const {
+	if (hasYears() || hasDayMonths() || _year != 0) {
+		return false;
+	}
+	for (int i = 0; i < 12; i++) {
+		if (!_months[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool OpeningHoursParser::BasicOpeningHourRule::isOpened(int year, int month, int dmonth) const {
 	bool opened = hasDayMonths() && _dayMonths[month][dmonth];
 	if (hasYears()) {
@@ -1982,6 +1997,119 @@ std::shared_ptr<OpeningHoursParser::OpeningHours> OpeningHoursParser::parseOpene
 	return rs->getRules().size() > 0 ? rs : nullptr;
 }
 
+OpeningHoursParser::CompiledOpeningHours::CompiledOpeningHours(const std::shared_ptr<OpeningHours>& hours)
+	: _hours(hours), _weekly(true) {
+	std::set<int> boundaries;
+	boundaries.insert(0);
+	for (const auto& r : hours->getRules()) {
+		if (typeid(*r) != typeid(BasicOpeningHourRule)) {
+			continue;
+		}
+		const auto& rule = std::static_pointer_cast<BasicOpeningHourRule>(r);
+		_weekly = _weekly && rule->isWeekly();
+		// start and end time are inclusive
+		for (int t : rule->getStartTimes()) {
+			boundaries.insert(t);
+		}
+		for (int t : rule->getEndTimes()) {
+			boundaries.insert(t);
+			boundaries.insert(t + 1);
+		}
+	}
+	for (int t : boundaries) {
+		if (t >= 0 && t < 24 * 60) {
+			_dayBoundaries.push_back(t);
+		}
+	}
+	if (_weekly) {
+		// any week, 1 Jan 2024 is Monday
+		tm monday;
+		memset(&monday, 0, sizeof(monday));
+		monday.tm_year = 2024 - 1900;
+		monday.tm_mon = 0;
+		_week.openedAtStart = false;
+		bool opened = false;
+		for (int d = 0; d < 7; d++) {
+			monday.tm_mday = d + 1;
+			monday.tm_wday = (d + 1) % 7;
+			DayChanges day = calculateDay(monday, d * 24 * 60);
+			if (d == 0) {
+				_week.openedAtStart = day.openedAtStart;
+				opened = day.openedAtStart;
+			} else if (day.openedAtStart != opened) {
+				_week.changes.push_back(d * 24 * 60);
+				opened = day.openedAtStart;
+			}
+			for (int c : day.changes) {
+				_week.changes.push_back(c);
+				opened = !opened;
+			}
+		}
+	}
+}
+
+OpeningHoursParser::CompiledOpeningHours::~CompiledOpeningHours() {
+}
+
+OpeningHoursParser::CompiledOpeningHours::DayChanges OpeningHoursParser::CompiledOpeningHours::calculateDay(
+	const tm& dateTime, int dayOffset) const {
+	DayChanges day;
+	day.openedAtStart = false;
+	tm cal;
+	memcpy(&cal, &dateTime, sizeof(cal));
+	cal.tm_sec = 0;
+	bool opened = false;
+	for (int i = 0; i < _dayBoundaries.size(); i++) {
+		int t = _dayBoundaries[i];
+		cal.tm_hour = t / 60;
+		cal.tm_min = t % 60;
+		bool o = _hours->isOpenedForTime(cal);
+		if (i == 0) {
+			day.openedAtStart = o;
+		} else if (o != opened) {
+			day.changes.push_back(dayOffset + t);
+		}
+		opened = o;
+	}
+	return day;
+}
+
+bool OpeningHoursParser::CompiledOpeningHours::isOpened(const DayChanges& changes, int minute) {
+	auto it = std::upper_bound(changes.changes.begin(), changes.changes.end(), minute);
+	return changes.openedAtStart != (((it - changes.changes.begin()) & 1) == 1);
+}
+
+bool OpeningHoursParser::CompiledOpeningHours::isWeekly() const {
+	return _weekly;
+}
+
+bool OpeningHoursParser::CompiledOpeningHours::isOpenedForTime(const tm& dateTime) const {
+	int minute = dateTime.tm_hour * 60 + dateTime.tm_min;
+	if (_weekly) {
+		// day number 0 is Monday
+		int day = (dateTime.tm_wday + 6) % 7;
+		return isOpened(_week, day * 24 * 60 + minute);
+	}
+	int key = ((dateTime.tm_year * 12 + dateTime.tm_mon) * 32 + dateTime.tm_mday) * 7 + dateTime.tm_wday;
+	std::lock_guard<std::mutex> lock(_datesMutex);
+	auto it = _dates.find(key);
+	if (it == _dates.end()) {
+		if (_dates.size() > MAX_COMPILED_DATES) {
+			_dates.clear();
+		}
+		it = _dates.insert({key, calculateDay(dateTime, 0)}).first;
+	}
+	return isOpened(it->second, minute);
+}
+
+void OpeningHoursParser::CompiledOpeningHours::isOpenedForTimes(const std::vector<tm>& dateTimes,
+																  std::vector<bool>& opened) const {
+	opened.resize(dateTimes.size());
+	for (size_t i = 0; i < dateTimes.size(); i++) {
+		opened[i] = isOpenedForTime(dateTimes[i]);
+	}
+}
+
 /**
  * parse time string
  *
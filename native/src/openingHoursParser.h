@@ -5,7 +5,9 @@
 //  git revision 577a5bf03975880f8214a71a7b86d21e590d66ef
 
 #include <ctime>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -467,6 +469,13 @@ struct OpeningHoursParser {
 		void deleteTimeRange(int position);
 
 		int calculate(const tm& dateTime) const;
+
+		/**
+		 * Check if rule depends only on week day (no months, days of month or years)
+		 *
+		 * @return true if rule is the same for every week
+		 */
+		bool isWeekly() const;
 	};
 
 	struct UnparseableRule : public OpeningHoursRule {
@@ -634,6 +643,55 @@ struct OpeningHoursParser {
 		std::string getOriginal() const;
 	};
 
+	/**
+	 * Opening hours compiled for fast checks. Opened state changes only at start and end times of rules,
+	 * so it is calculated by OpeningHours at these times once: for the whole week if all rules are weekly,
+	 * otherwise for every requested date (dates are cached).
+	 */
+	struct CompiledOpeningHours {
+	   private:
+		struct DayChanges {
+			bool openedAtStart;
+			// minutes where opened state changes
+			std::vector<int> changes;
+		};
+
+		std::shared_ptr<OpeningHours> _hours;
+		bool _weekly;
+		// minutes of day where opened state could change
+		std::vector<int> _dayBoundaries;
+		// minutes of week (0 is Monday 00:00) where opened state changes
+		DayChanges _week;
+
+		mutable std::mutex _datesMutex;
+		mutable std::map<int, DayChanges> _dates;
+
+		DayChanges calculateDay(const tm& dateTime, int dayOffset) const;
+		static bool isOpened(const DayChanges& changes, int minute);
+
+	   public:
+		CompiledOpeningHours(const std::shared_ptr<OpeningHours>& hours);
+		virtual ~CompiledOpeningHours();
+
+		bool isWeekly() const;
+
+		/**
+		 * check if the feature is opened at time "dateTime", same as OpeningHours::isOpenedForTime
+		 *
+		 * @param dateTime the time to check
+		 * @return true if feature is open
+		 */
+		bool isOpenedForTime(const tm& dateTime) const;
+
+		/**
+		 * check if the feature is opened at every time of "dateTimes"
+		 *
+		 * @param dateTimes times to check
+		 * @param opened    result for every time
+		 */
+		void isOpenedForTimes(const std::vector<tm>& dateTimes, std::vector<bool>& opened) const;
+	};
+
    private:
 	std::string openingHours;
 
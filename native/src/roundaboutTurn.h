@@ -14,7 +14,7 @@ public:
     bool isRoundaboutExist();
     SHARED_PTR<TurnType> getRoundaboutType();
 private:
-    vector<SHARED_PTR<RouteSegmentResult>> routeSegmentResults;
+    vector<SHARED_PTR<RouteSegmentResult>>& routeSegmentResults;
     SHARED_PTR<RouteSegmentResult> current;
     SHARED_PTR<RouteSegmentResult> prev;
     int iteration;
@@ -24,7 +24,20 @@ SHARED_PTR<RouteCalculationProgress> RouteCalculationProgress::capture(SHARED_PT
 	p->distinctLoadedTiles = cp->distinctLoadedTiles;
 	p->maxLoadedTiles = cp->maxLoadedTiles;
 	p->loadedPrevUnloadedTiles = cp->loadedPrevUnloadedTiles;
+	p->prefetchRequestedTiles = cp->prefetchRequestedTiles;
+	p->prefetchedTiles = cp->prefetchedTiles;
+	p->timeToLoadHiddenNanos = cp->timeToLoadHiddenNanos;
+	p->gcRuns = cp->gcRuns;
+	p->thrashedTiles = cp->thrashedTiles;
+	p->gcPinnedTiles = cp->gcPinnedTiles;
+	p->landmarkEstimates = cp->landmarkEstimates;
 	p->timeExtra = cp->timeExtra;
+	p->timeToPrepareAreaRouting = cp->timeToPrepareAreaRouting;
+	p->timeToAttachRoads = cp->timeToAttachRoads;
+	p->timeToCalculateTimeSpeed = cp->timeToCalculateTimeSpeed;
+	p->timeToPrepareTurns = cp->timeToPrepareTurns;
+	p->rerouteSpliceSegment = cp->rerouteSpliceSegment;
+	p->rerouteReusedFraction = cp->rerouteReusedFraction;
 	cp->maxLoadedTiles = 0;
 	return p;
 }
@@ -42,8 +55,19 @@ UNORDERED(map) < string, UNORDERED(map) < string, string >>
 	tiles.insert({"loadedTilesPrevUnloaded",
 				  std::to_string(this->loadedPrevUnloadedTiles - firstPhase->loadedPrevUnloadedTiles)});
 	tiles.insert({"loadedTilesMax", std::to_string(max(this->maxLoadedTiles, this->distinctLoadedTiles))});
+	if (this->prefetchRequestedTiles > 0) {
+		tiles.insert({"prefetchRequestedTiles",
+					  std::to_string(this->prefetchRequestedTiles - firstPhase->prefetchRequestedTiles)});
+		tiles.insert({"prefetchedTiles", std::to_string(this->prefetchedTiles - firstPhase->prefetchedTiles)});
+	}
 	map.insert({"tiles", tiles});
 
+	UNORDERED(map)<string, string> gc;
+	gc.insert({"runs", std::to_string(this->gcRuns - firstPhase->gcRuns)});
+	gc.insert({"thrashedTiles", std::to_string(this->thrashedTiles - firstPhase->thrashedTiles)});
+	gc.insert({"pinnedTiles", std::to_string(this->gcPinnedTiles - firstPhase->gcPinnedTiles)});
+	map.insert({"gc", gc});
+
 	UNORDERED(map)<string, string> segms;
 	segms.insert({"visited", std::to_string(this->visitedSegments - firstPhase->visitedSegments)});
 	segms.insert({"queueDirectSize", std::to_string(this->directQueueSize - firstPhase->directQueueSize)});
@@ -55,6 +79,7 @@ UNORDERED(map) < string, UNORDERED(map) < string, string >>
 				  std::to_string(this->visitedOppositeSegments - firstPhase->visitedOppositeSegments)});
     segms.insert({"finalSegmentsFound",
             std::to_string(this->finalSegmentsFound -  firstPhase->finalSegmentsFound)});
+	segms.insert({"landmarkEstimates", std::to_string(this->landmarkEstimates - firstPhase->landmarkEstimates)});
 	map.insert({"segments", segms});
 
 	UNORDERED(map)<string, string> time;
@@ -72,6 +97,25 @@ UNORDERED(map) < string, UNORDERED(map) < string, string >>
 	time.insert({"timeToFindInitialSegments", std::to_string(timeToFindInitialSegments)});
 	float timeExtra = (float)(((this->timeExtra).GetElapsedMs() - (firstPhase->timeExtra).GetElapsedMs()) / 1.0e3);
 	time.insert({"timeExtra", std::to_string(timeExtra)});
+	float timeToPrepareAreaRouting = (float)(((this->timeToPrepareAreaRouting).GetElapsedMs() -
+											  (firstPhase->timeToPrepareAreaRouting).GetElapsedMs()) /
+											 1.0e3);
+	time.insert({"timeToPrepareAreaRouting", std::to_string(timeToPrepareAreaRouting)});
+	float timeToAttachRoads =
+		(float)(((this->timeToAttachRoads).GetElapsedMs() - (firstPhase->timeToAttachRoads).GetElapsedMs()) / 1.0e3);
+	time.insert({"timeToAttachRoads", std::to_string(timeToAttachRoads)});
+	float timeToCalculateTimeSpeed = (float)(((this->timeToCalculateTimeSpeed).GetElapsedMs() -
+											  (firstPhase->timeToCalculateTimeSpeed).GetElapsedMs()) /
+											 1.0e3);
+	time.insert({"timeToCalculateTimeSpeed", std::to_string(timeToCalculateTimeSpeed)});
+	float timeToPrepareTurns =
+		(float)(((this->timeToPrepareTurns).GetElapsedMs() - (firstPhase->timeToPrepareTurns).GetElapsedMs()) / 1.0e3);
+	time.insert({"timeToPrepareTurns", std::to_string(timeToPrepareTurns)});
+	if (this->prefetchRequestedTiles > 0) {
+		float timeToLoadHidden =
+			(float)((this->timeToLoadHiddenNanos - firstPhase->timeToLoadHiddenNanos) / 1.0e9);
+		time.insert({"timeToLoadHidden", std::to_string(timeToLoadHidden)});
+	}
 	map.insert({"time", time});
 
 	UNORDERED(map)<string, string> metrics;
@@ -87,6 +131,13 @@ UNORDERED(map) < string, UNORDERED(map) < string, string >>
 		metrics.insert({"segmentsPerSec", std::to_string((float)0)});
 	}
 	map.insert({"metrics", metrics});
+
+	if (this->rerouteSpliceSegment >= 0) {
+		UNORDERED(map)<string, string> reroute;
+		reroute.insert({"spliceSegment", std::to_string(this->rerouteSpliceSegment)});
+		reroute.insert({"reusedFraction", std::to_string(this->rerouteReusedFraction)});
+		map.insert({"reroute", reroute});
+	}
 	return map;
 }
 
@@ -98,6 +149,22 @@ void RouteCalculationProgress::updateStatus(float distanceFromBegin, int directS
 	this->reverseSegmentQueueSize = reverseSegmentQueueSize;
 }
 
+void RouteCalculationProgress::resetSearchStatus() {
+	segmentNotFound = -1;
+	distanceFromBegin = 0;
+	distanceFromEnd = 0;
+	directSegmentQueueSize = 0;
+	reverseSegmentQueueSize = 0;
+	visitedSegments = 0;
+	visitedDirectSegments = 0;
+	visitedOppositeSegments = 0;
+	directQueueSize = 0;
+	oppositeQueueSize = 0;
+	finalSegmentsFound = 0;
+	rerouteSpliceSegment = -1;
+	rerouteReusedFraction = 0;
+}
+
 float RouteCalculationProgress::getLinearProgressHH() {
 	float progress = 0;
 
@@ -16,6 +16,11 @@ class RouteCalculationProgress {
 	OsmAnd::ElapsedTimer timeToLoadHeaders;
 	OsmAnd::ElapsedTimer timeToFindInitialSegments;
 	OsmAnd::ElapsedTimer timeExtra;
+	// stages of route result preparation
+	OsmAnd::ElapsedTimer timeToPrepareAreaRouting;
+	OsmAnd::ElapsedTimer timeToAttachRoads;
+	OsmAnd::ElapsedTimer timeToCalculateTimeSpeed;
+	OsmAnd::ElapsedTimer timeToPrepareTurns;
 
 	int segmentNotFound;
 	float distanceFromBegin;
@@ -39,6 +44,17 @@ class RouteCalculationProgress {
 	int unloadedTiles;
 	int loadedPrevUnloadedTiles;
 	int distinctLoadedTiles;
+	// tiles requested from background prefetcher and tiles actually taken from it
+	int prefetchRequestedTiles;
+	int prefetchedTiles;
+	// part of tile decoding time which was done in background while search was running
+	uint64_t timeToLoadHiddenNanos;
+	// GC runs, tiles loaded again after they were unloaded and tiles kept by GC because of search frontier
+	int gcRuns;
+	int thrashedTiles;
+	int gcPinnedTiles;
+	// heuristic estimates where landmark (ALT) bound was better than straight line
+	int landmarkEstimates;
 
 	int totalIterations;
 	int iteration;
@@ -48,6 +64,11 @@ class RouteCalculationProgress {
 	int maxLoadedTiles;
 	bool requestPrivateAccessRouting;
 
+	// incremental reroute: index of previous route segment where new prefix was spliced (-1 if not used)
+	int rerouteSpliceSegment;
+	// share of previous route distance reused as is
+	float rerouteReusedFraction;
+
    public:
 	RouteCalculationProgress()
 		: segmentNotFound(-1), distanceFromBegin(0), directSegmentQueueSize(0), distanceFromEnd(0),
@@ -55,8 +76,10 @@ class RouteCalculationProgress {
 		  approximatedDistance(0), routingCalculatedTime(0), visitedSegments(0),
 		  visitedDirectSegments(0), visitedOppositeSegments(0), directQueueSize(0), oppositeQueueSize(0),
           finalSegmentsFound(0), loadedTiles(0), unloadedTiles(0), loadedPrevUnloadedTiles(0), distinctLoadedTiles(0),
+          prefetchRequestedTiles(0), prefetchedTiles(0), timeToLoadHiddenNanos(0),
+          gcRuns(0), thrashedTiles(0), gcPinnedTiles(0), landmarkEstimates(0),
           totalIterations(1), iteration(-1), cancelled(false), maxLoadedTiles(0),
-          requestPrivateAccessRouting(false),
+          requestPrivateAccessRouting(false), rerouteSpliceSegment(-1), rerouteReusedFraction(0),
           hhIterationStep(HH_NOT_STARTED), hhCurrentStepProgress(0), hhTargetsDone(0), hhTargetsTotal(0)
 		{
 	}
@@ -74,6 +97,8 @@ class RouteCalculationProgress {
 	virtual void updateApproximatedDistance(float distance) { approximatedDistance = distance; }
 	virtual void updateStatus(float distanceFromBegin, int directSegmentQueueSize, float distanceFromEnd,
 							  int reverseSegmentQueueSize);
+	// Clears search status before the same route is searched again (fallback of incremental reroute)
+	virtual void resetSearchStatus();
 	virtual float getLinearProgressHH();
 	virtual float getLinearProgress();
 	virtual float getApproximationProgress();
@@ -16,23 +16,34 @@ RouteDataBundle::RouteDataBundle(SHARED_PTR<RouteDataResources>& resources) : re
 }
 
 RouteDataBundle::RouteDataBundle(SHARED_PTR<RouteDataResources>& resources, SHARED_PTR<RouteDataBundle> bundle)
-	: resources(resources), data(bundle->data) {
+	: resources(resources), data(bundle->data), vectors(bundle->vectors), intIntVectors(bundle->intIntVectors) {
 }
 
 void RouteDataBundle::put(string key, string value) {
+	vectors.erase(key);
+	intIntVectors.erase(key);
 	data[key] = value;
 }
 
 void RouteDataBundle::putVector(string key, vector<uint32_t> value) {
-	put(key, intVectorToString(value));
+	data.erase(key);
+	intIntVectors.erase(key);
+	vectors[key] = std::move(value);
 }
 
 void RouteDataBundle::putVectors(string key, vector<vector<uint32_t>> value) {
-	put(key, intIntVectorToString(value));
+	data.erase(key);
+	vectors.erase(key);
+	intIntVectors[key] = std::move(value);
 }
 
 string RouteDataBundle::getString(string key, string def) {
-	if (data.count(key) == 1) return data[key];
+	const auto it = data.find(key);
+	if (it != data.end()) return it->second;
+	const auto itVector = vectors.find(key);
+	if (itVector != vectors.end()) return intVectorToString(itVector->second);
+	const auto itVectors = intIntVectors.find(key);
+	if (itVectors != intIntVectors.end()) return intIntVectorToString(itVectors->second);
 	return def;
 }
 
@@ -66,6 +77,8 @@ int64_t RouteDataBundle::getLong(string key, int64_t def) {
 }
 
 vector<uint32_t> RouteDataBundle::getIntVector(string key, vector<uint32_t> def) {
+	const auto it = vectors.find(key);
+	if (it != vectors.end()) return it->second;
 	if (data.count(key) == 1) {
 		auto str = data[key];
 		return stringToIntVector(str);
@@ -74,6 +87,8 @@ vector<uint32_t> RouteDataBundle::getIntVector(string key, vector<uint32_t> def)
 }
 
 vector<vector<uint32_t>> RouteDataBundle::getIntIntVector(string key, vector<vector<uint32_t>> def) {
+	const auto it = intIntVectors.find(key);
+	if (it != intIntVectors.end()) return it->second;
 	if (data.count(key) == 1) {
 		auto str = data[key];
 		return stringToIntIntVector(str);
@@ -81,7 +96,7 @@ vector<vector<uint32_t>> RouteDataBundle::getIntIntVector(string key, vector<vec
 	return def;
 }
 
-string RouteDataBundle::intVectorToString(vector<uint32_t>& vec) {
+string RouteDataBundle::intVectorToString(const vector<uint32_t>& vec) {
 	std::ostringstream oss;
 	if (!vec.empty()) {
 		if (vec.size() > 1) {
@@ -92,13 +107,13 @@ string RouteDataBundle::intVectorToString(vector<uint32_t>& vec) {
 	return oss.str();
 }
 
-string RouteDataBundle::intIntVectorToString(vector<vector<uint32_t>>& vec) {
+string RouteDataBundle::intIntVectorToString(const vector<vector<uint32_t>>& vec) {
 	string b;
 	for (int i = 0; i < vec.size(); i++) {
 		if (i > 0) {
 			b += ";";
 		}
-		vector<uint32_t> arr = vec[i];
+		const vector<uint32_t>& arr = vec[i];
 		if (arr.size() > 0) {
 			b += intVectorToString(arr);
 		}
@@ -134,4 +149,139 @@ vector<vector<uint32_t>> RouteDataBundle::stringToIntIntVector(string& a) {
 	return res;
 }
 
+void RouteDataBundle::writeVarint(vector<uint8_t>& out, uint32_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+bool RouteDataBundle::readVarint(const vector<uint8_t>& in, size_t& pos, uint32_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (pos >= in.size()) {
+			return false;
+		}
+		uint8_t b = in[pos++];
+		value |= (uint32_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void writeVarintVector(vector<uint8_t>& out, const vector<uint32_t>& vec) {
+	RouteDataBundle::writeVarint(out, (uint32_t)vec.size());
+	for (uint32_t v : vec) {
+		RouteDataBundle::writeVarint(out, v);
+	}
+}
+
+static bool readVarintVector(const vector<uint8_t>& in, size_t& pos, vector<uint32_t>& vec) {
+	uint32_t size;
+	// every item takes at least one byte
+	if (!RouteDataBundle::readVarint(in, pos, size) || size > in.size() - pos) {
+		return false;
+	}
+	vec.resize(size);
+	for (uint32_t i = 0; i < size; i++) {
+		if (!RouteDataBundle::readVarint(in, pos, vec[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RouteDataBundle::writeBinary(vector<uint8_t>& out) {
+	writeVarint(out, (uint32_t)(data.size() + vectors.size() + intIntVectors.size()));
+	for (const auto& it : data) {
+		writeVarint(out, resources->getStringIndex(it.first));
+		out.push_back(BINARY_STRING);
+		writeVarint(out, resources->getStringIndex(it.second));
+	}
+	for (const auto& it : vectors) {
+		writeVarint(out, resources->getStringIndex(it.first));
+		out.push_back(BINARY_INT_VECTOR);
+		writeVarintVector(out, it.second);
+	}
+	for (const auto& it : intIntVectors) {
+		writeVarint(out, resources->getStringIndex(it.first));
+		out.push_back(BINARY_INT_INT_VECTOR);
+		writeVarint(out, (uint32_t)it.second.size());
+		for (const auto& vec : it.second) {
+			writeVarintVector(out, vec);
+		}
+	}
+}
+
+bool RouteDataBundle::readBinary(const vector<uint8_t>& in, size_t& pos, const vector<string>& strings) {
+	uint32_t count;
+	if (!readVarint(in, pos, count)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t key;
+		if (!readVarint(in, pos, key) || key >= strings.size() || pos >= in.size()) {
+			return false;
+		}
+		uint8_t type = in[pos++];
+		if (type == BINARY_STRING) {
+			uint32_t value;
+			if (!readVarint(in, pos, value) || value >= strings.size()) {
+				return false;
+			}
+			put(strings[key], strings[value]);
+		} else if (type == BINARY_INT_VECTOR) {
+			vector<uint32_t> vec;
+			if (!readVarintVector(in, pos, vec)) {
+				return false;
+			}
+			putVector(strings[key], std::move(vec));
+		} else if (type == BINARY_INT_INT_VECTOR) {
+			uint32_t size;
+			if (!readVarint(in, pos, size) || size > in.size() - pos) {
+				return false;
+			}
+			vector<vector<uint32_t>> vecs(size);
+			for (uint32_t k = 0; k < size; k++) {
+				if (!readVarintVector(in, pos, vecs[k])) {
+					return false;
+				}
+			}
+			putVectors(strings[key], std::move(vecs));
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RouteDataBundle::writeStringTable(const vector<string>& strings, vector<uint8_t>& out) {
+	writeVarint(out, (uint32_t)strings.size());
+	for (const string& s : strings) {
+		writeVarint(out, (uint32_t)s.size());
+		out.insert(out.end(), s.begin(), s.end());
+	}
+}
+
+bool RouteDataBundle::readStringTable(const vector<uint8_t>& in, size_t& pos, vector<string>& strings) {
+	uint32_t count;
+	if (!readVarint(in, pos, count) || count > in.size() - pos) {
+		return false;
+	}
+	strings.clear();
+	strings.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t length;
+		if (!readVarint(in, pos, length) || length > in.size() - pos) {
+			return false;
+		}
+		strings.push_back(string(in.begin() + pos, in.begin() + pos + length));
+		pos += length;
+	}
+	return true;
+}
+
 #endif /*_OSMAND_ROUTE_DATA_BUNDLE_CPP*/
@@ -9,6 +9,9 @@ struct RouteDataBundle {
    public:
 	SHARED_PTR<RouteDataResources> resources;
 	UNORDERED_map<string, string> data;
+	// Typed values, vectors aren't converted to strings (getString converts them for compatibility)
+	UNORDERED_map<string, vector<uint32_t>> vectors;
+	UNORDERED_map<string, vector<vector<uint32_t>>> intIntVectors;
 
 	RouteDataBundle();
 	RouteDataBundle(SHARED_PTR<RouteDataResources>& resources);
@@ -26,9 +29,26 @@ struct RouteDataBundle {
 	vector<vector<uint32_t>> getIntIntVector(string key, vector<vector<uint32_t>> def);
 	string getString(string key, string def);
 
+	// Binary form of bundle: varint count of values, for every value varint key (index in string table of
+	// resources), type byte and value - varint string index, varint size with varint items or varint count of
+	// such vectors. String table is shared by all bundles of route and is complete only after they are written,
+	// bundles are read with string table read separately (strings of resources are not changed by reading).
+	void writeBinary(vector<uint8_t>& out);
+	bool readBinary(const vector<uint8_t>& in, size_t& pos, const vector<string>& strings);
+	static void writeStringTable(const vector<string>& strings, vector<uint8_t>& out);
+	static bool readStringTable(const vector<uint8_t>& in, size_t& pos, vector<string>& strings);
+	static void writeVarint(vector<uint8_t>& out, uint32_t value);
+	static bool readVarint(const vector<uint8_t>& in, size_t& pos, uint32_t& value);
+
    private:
-	string intVectorToString(vector<uint32_t>& vec);
-	string intIntVectorToString(vector<vector<uint32_t>>& vec);
+	enum BinaryValueType : uint8_t {
+		BINARY_STRING = 0,
+		BINARY_INT_VECTOR = 1,
+		BINARY_INT_INT_VECTOR = 2
+	};
+
+	string intVectorToString(const vector<uint32_t>& vec);
+	string intIntVectorToString(const vector<vector<uint32_t>>& vec);
 	
 	vector<uint32_t> stringToIntVector(string& a);
 	vector<vector<uint32_t>> stringToIntIntVector(string& a);
@@ -48,4 +48,15 @@ void RouteDataResources::updateNextSegmentStartLocation(int currentSegmentLength
 	currentSegmentStartLocationIndex += overlappingNextRouteSegment ? currentSegmentLength - 1 : currentSegmentLength;
 }
 
+uint32_t RouteDataResources::getStringIndex(const string& value) {
+	auto it = stringIndexes.find(value);
+	if (it != stringIndexes.end()) {
+		return it->second;
+	}
+	uint32_t ind = (uint32_t)strings.size();
+	strings.push_back(value);
+	stringIndexes[value] = ind;
+	return ind;
+}
+
 #endif /*_OSMAND_ROUTE_DATA_RESOURCES_CPP*/
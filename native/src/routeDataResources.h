@@ -31,6 +31,9 @@ public:
     vector<Location> locations;
     UNORDERED_map<SHARED_PTR<RouteDataObject>, vector<vector<uint32_t>>> pointNamesMap;
     vector<int> routePointIndexes;
+    // String table shared by binary bundles of route (keys and string values)
+    vector<string> strings;
+    UNORDERED_map<string, uint32_t> stringIndexes;
     
     RouteDataResources();
     RouteDataResources(vector<Location> locations, vector<int>& routePointIndexes);
@@ -38,6 +41,7 @@ public:
     Location getCurrentSegmentLocation(int offset);
     int getCurrentSegmentStartLocationIndex();
     void updateNextSegmentStartLocation(int currentSegmentLength);
+    uint32_t getStringIndex(const string& value);
 };
 
 #endif /*_OSMAND_ROUTE_DATA_RESOURCES_H*/
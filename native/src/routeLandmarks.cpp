@@ -0,0 +1,239 @@
+#ifndef _OSMAND_ROUTE_LANDMARKS_CPP
+#define _OSMAND_ROUTE_LANDMARKS_CPP
+
+#include "routeLandmarks.h"
+
+#include <math.h>
+
+#include <mutex>
+
+#include "Logging.h"
+#include "binaryRoutePlanner.h"
+#include "routingContext.h"
+
+double RouteLandmarks::lowerBound(int fromX, int fromY, int toX, int toY) {
+	int p = findCell(fromX, fromY);
+	int q = findCell(toX, toY);
+	if (p < 0 || q < 0 || p == q) {
+		return 0;
+	}
+	double res = 0;
+	for (uint l = 0; l < landmarks.size(); l++) {
+		uint16_t* bp = getBounds(p, l);
+		uint16_t* bq = getBounds(q, l);
+		if (bq[FROM_MIN] != UNREACHABLE && bp[FROM_MAX] != UNREACHABLE) {
+			res = std::max(res, (double)bq[FROM_MIN] - bp[FROM_MAX]);
+		}
+		if (bp[TO_MIN] != UNREACHABLE && bq[TO_MAX] != UNREACHABLE) {
+			res = std::max(res, (double)bp[TO_MIN] - bq[TO_MAX]);
+		}
+	}
+	return res * unit;
+}
+
+void RouteLandmarks::indexCells() {
+	cellIndex.clear();
+	cellIndex.reserve(cells.size());
+	for (uint i = 0; i < cells.size(); i++) {
+		cellIndex[cells[i]] = i;
+	}
+}
+
+std::string getRouteLandmarksFileName(const std::string& obfFileName, const std::string& routerName) {
+	return obfFileName + "." + routerName + ".alt";
+}
+
+bool writeRouteLandmarks(const std::string& fileName, RouteLandmarks& lm) {
+	FILE* file = fopen(fileName.c_str(), "wb");
+	if (!file) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Landmarks file could not be open to write: %s",
+						  fileName.c_str());
+		return false;
+	}
+	uint32_t magic = RouteLandmarks::MAGIC;
+	uint32_t version = RouteLandmarks::VERSION;
+	int32_t zoom = lm.zoom;
+	uint32_t nameLength = lm.routerName.size();
+	uint32_t landmarksCount = lm.landmarks.size();
+	uint32_t cellsCount = lm.cells.size();
+	bool ok = fwrite(&magic, sizeof(magic), 1, file) == 1 && fwrite(&version, sizeof(version), 1, file) == 1 &&
+			  fwrite(&zoom, sizeof(zoom), 1, file) == 1 && fwrite(&lm.unit, sizeof(lm.unit), 1, file) == 1 &&
+			  fwrite(&nameLength, sizeof(nameLength), 1, file) == 1 &&
+			  fwrite(lm.routerName.data(), 1, nameLength, file) == nameLength &&
+			  fwrite(&landmarksCount, sizeof(landmarksCount), 1, file) == 1;
+	for (uint i = 0; ok && i < landmarksCount; i++) {
+		int32_t xy[2] = {lm.landmarks[i].first, lm.landmarks[i].second};
+		ok = fwrite(xy, sizeof(int32_t), 2, file) == 2;
+	}
+	ok = ok && fwrite(&cellsCount, sizeof(cellsCount), 1, file) == 1 &&
+		 fwrite(lm.cells.data(), sizeof(int64_t), cellsCount, file) == cellsCount &&
+		 fwrite(lm.bounds.data(), sizeof(uint16_t), lm.bounds.size(), file) == lm.bounds.size();
+	fclose(file);
+	if (!ok) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Landmarks file was not written: %s", fileName.c_str());
+	}
+	return ok;
+}
+
+SHARED_PTR<RouteLandmarks> readRouteLandmarks(const std::string& fileName) {
+	SHARED_PTR<RouteLandmarks> lm;
+	FILE* file = fopen(fileName.c_str(), "rb");
+	if (!file) {
+		return lm;
+	}
+	lm = std::make_shared<RouteLandmarks>();
+	uint32_t magic = 0, version = 0, nameLength = 0, landmarksCount = 0, cellsCount = 0;
+	int32_t zoom = 0;
+	bool ok = fread(&magic, sizeof(magic), 1, file) == 1 && magic == RouteLandmarks::MAGIC &&
+			  fread(&version, sizeof(version), 1, file) == 1 && version == RouteLandmarks::VERSION &&
+			  fread(&zoom, sizeof(zoom), 1, file) == 1 && zoom > 0 && zoom < 31 &&
+			  fread(&lm->unit, sizeof(lm->unit), 1, file) == 1 &&
+			  fread(&nameLength, sizeof(nameLength), 1, file) == 1 && nameLength < 1024;
+	if (ok) {
+		lm->zoom = zoom;
+		lm->routerName.resize(nameLength);
+		ok = fread(&lm->routerName[0], 1, nameLength, file) == nameLength &&
+			 fread(&landmarksCount, sizeof(landmarksCount), 1, file) == 1 && landmarksCount < 1024;
+	}
+	for (uint i = 0; ok && i < landmarksCount; i++) {
+		int32_t xy[2];
+		ok = fread(xy, sizeof(int32_t), 2, file) == 2;
+		lm->landmarks.push_back(int_pair(xy[0], xy[1]));
+	}
+	ok = ok && fread(&cellsCount, sizeof(cellsCount), 1, file) == 1;
+	if (ok) {
+		lm->cells.resize(cellsCount);
+		lm->bounds.resize((size_t)cellsCount * landmarksCount * 4);
+		ok = fread(lm->cells.data(), sizeof(int64_t), cellsCount, file) == cellsCount &&
+			 fread(lm->bounds.data(), sizeof(uint16_t), lm->bounds.size(), file) == lm->bounds.size();
+	}
+	fclose(file);
+	if (!ok) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Error, "Landmarks file is corrupted: %s", fileName.c_str());
+		return SHARED_PTR<RouteLandmarks>();
+	}
+	lm->indexCells();
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Landmarks %s loaded: %d landmarks, %d cells",
+					  fileName.c_str(), landmarksCount, cellsCount);
+	return lm;
+}
+
+static std::mutex landmarksCacheMutex;
+static UNORDERED(map)<std::string, SHARED_PTR<RouteLandmarks>> landmarksCache;
+
+SHARED_PTR<RouteLandmarks> getRouteLandmarks(const std::string& fileName) {
+	std::lock_guard<std::mutex> lock(landmarksCacheMutex);
+	const auto it = landmarksCache.find(fileName);
+	if (it != landmarksCache.end()) {
+		return it->second;
+	}
+	SHARED_PTR<RouteLandmarks> lm = readRouteLandmarks(fileName);
+	landmarksCache[fileName] = lm;
+	return lm;
+}
+
+SHARED_PTR<RouteLandmarks> buildRouteLandmarks(RoutingContext* ctx, int startX31, int startY31, int landmarksCount,
+											   int zoom) {
+	SHARED_PTR<RouteLandmarks> lm = std::make_shared<RouteLandmarks>();
+	lm->routerName = ctx->config->routerName;
+	lm->zoom = zoom;
+	// seconds for every landmark (4 values as in RouteLandmarks::bounds), negative - not reached
+	UNORDERED(map)<int64_t, vector<float>> collected;
+	// nearest reached road point of the cell, used to pick next landmark
+	UNORDERED(map)<int64_t, int_pair> cellPoints;
+
+	int savedMaxVisited = ctx->config->MAX_VISITED;
+	int savedPlanRoadDirection = ctx->config->planRoadDirection;
+	float savedHeuristicCoefficient = ctx->config->heurCoefficient;
+	vector<BinaryMapFile*> filter = ctx->mapIndexReaderFilter;
+	int x31 = startX31;
+	int y31 = startY31;
+	for (int l = 0; l < landmarksCount && !ctx->isInterrupted(); l++) {
+		SHARED_PTR<RouteSegmentPoint> pnt;
+		for (int dir = 0; dir < 2; dir++) {
+			bool reverse = dir == 1;
+			pnt = findRouteSegment(x31, y31, ctx);
+			if (!pnt) {
+				break;
+			}
+			ctx->config->MAX_VISITED = -1;
+			ctx->config->planRoadDirection = reverse ? -1 : 1;
+			ctx->config->heurCoefficient = 0;  // dijkstra
+			ctx->unloadAllData();
+			ctx->mapIndexReaderFilter = filter;
+			ctx->visitor = [&](const SHARED_PTR<RouteSegment>& s, bool) {
+				int64_t cell = lm->getCellId(s->getStartPointX(), s->getStartPointY());
+				vector<float>& v = collected[cell];
+				if (v.empty()) {
+					v.resize(landmarksCount * 4, -1);
+					cellPoints[cell] = int_pair(s->getStartPointX(), s->getStartPointY());
+				}
+				float& mn = v[l * 4 + (reverse ? RouteLandmarks::TO_MIN : RouteLandmarks::FROM_MIN)];
+				float& mx = v[l * 4 + (reverse ? RouteLandmarks::TO_MAX : RouteLandmarks::FROM_MAX)];
+				if (mn < 0 || s->distanceFromStart < mn) {
+					mn = s->distanceFromStart;
+				}
+				mx = std::max(mx, s->distanceFromStart);
+			};
+			searchRouteInternal(ctx, reverse ? nullptr : pnt, reverse ? pnt : nullptr, {}, {});
+			ctx->visitor = nullptr;
+		}
+		if (!pnt) {
+			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Warning, "Landmark %d is not found near %d %d", l, x31, y31);
+			break;
+		}
+		lm->landmarks.push_back(int_pair(pnt->preciseX, pnt->preciseY));
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Landmark %d: %d %d, cells %d", l, pnt->preciseX,
+						  pnt->preciseY, (int)collected.size());
+		// next landmark is the reachable cell farthest from all selected landmarks
+		float farthest = -1;
+		for (auto& c : collected) {
+			float d = -1;
+			for (int k = 0; k <= l; k++) {
+				float f = c.second[k * 4 + RouteLandmarks::FROM_MIN];
+				if (f >= 0 && (d < 0 || f < d)) {
+					d = f;
+				}
+			}
+			if (d > farthest) {
+				farthest = d;
+				x31 = cellPoints[c.first].first;
+				y31 = cellPoints[c.first].second;
+			}
+		}
+	}
+	ctx->config->heurCoefficient = savedHeuristicCoefficient;
+	ctx->config->planRoadDirection = savedPlanRoadDirection;
+	ctx->config->MAX_VISITED = savedMaxVisited;
+	ctx->unloadAllData();
+	ctx->mapIndexReaderFilter = filter;
+
+	uint count = lm->landmarks.size();
+	for (auto& c : collected) {
+		lm->cells.push_back(c.first);
+	}
+	std::sort(lm->cells.begin(), lm->cells.end());
+	lm->bounds.resize(lm->cells.size() * count * 4, RouteLandmarks::UNREACHABLE);
+	for (uint i = 0; i < lm->cells.size(); i++) {
+		vector<float>& v = collected[lm->cells[i]];
+		for (uint l = 0; l < count; l++) {
+			uint16_t* b = lm->getBounds(i, l);
+			for (int k = 0; k < 4; k++) {
+				float d = v[l * 4 + k];
+				if (d < 0) {
+					continue;
+				}
+				// keep bounds admissible: round minimums down and maximums up
+				if (k == RouteLandmarks::FROM_MIN || k == RouteLandmarks::TO_MIN) {
+					b[k] = (uint16_t)std::min((double)floor(d / lm->unit), (double)RouteLandmarks::UNREACHABLE - 1);
+				} else if (ceil(d / lm->unit) < RouteLandmarks::UNREACHABLE) {
+					b[k] = (uint16_t)ceil(d / lm->unit);
+				}
+			}
+		}
+	}
+	lm->indexCells();
+	return lm;
+}
+
+#endif /*_OSMAND_ROUTE_LANDMARKS_CPP*/
@@ -0,0 +1,67 @@
+#ifndef _OSMAND_ROUTE_LANDMARKS_H
+#define _OSMAND_ROUTE_LANDMARKS_H
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct RoutingContext;
+
+// Landmark (ALT) lower bounds of routing time for A* heuristic.
+// For every landmark and every grid cell (zoom) sidecar keeps min / max time from landmark to road points of the cell
+// and from points of the cell to landmark. By triangle inequality for points p, q and landmark L:
+// time(p -> q) >= time(L -> q) - time(L -> p) and time(p -> q) >= time(p -> L) - time(q -> L).
+// Bounds are valid for the profile and maps they were built with (sidecar has to be rebuilt after maps update).
+struct RouteLandmarks {
+	const static uint32_t MAGIC = 0x544C414F;  // OALT
+	const static uint32_t VERSION = 1;
+	const static uint16_t UNREACHABLE = 0xFFFF;
+	const static int FROM_MIN = 0;
+	const static int FROM_MAX = 1;
+	const static int TO_MIN = 2;
+	const static int TO_MAX = 3;
+
+	string routerName;
+	int zoom;
+	// seconds per stored unit (min values are rounded down and max values up)
+	float unit;
+	vector<int_pair> landmarks;
+	vector<int64_t> cells;
+	// cells.size() * landmarks.size() * 4 values
+	vector<uint16_t> bounds;
+	UNORDERED(map)<int64_t, uint32_t> cellIndex;
+
+	RouteLandmarks() : zoom(14), unit(4) {}
+
+	int64_t getCellId(int x31, int y31) {
+		int shift = 31 - zoom;
+		return ((int64_t)(x31 >> shift) << zoom) + (y31 >> shift);
+	}
+
+	int findCell(int x31, int y31) {
+		const auto it = cellIndex.find(getCellId(x31, y31));
+		return it == cellIndex.end() ? -1 : (int)it->second;
+	}
+
+	uint16_t* getBounds(int cell, int landmark) { return &bounds[(cell * landmarks.size() + landmark) * 4]; }
+
+	// lower bound of time (seconds) from (fromX, fromY) to (toX, toY), 0 if unknown
+	double lowerBound(int fromX, int fromY, int toX, int toY);
+
+	void indexCells();
+};
+
+std::string getRouteLandmarksFileName(const std::string& obfFileName, const std::string& routerName);
+
+bool writeRouteLandmarks(const std::string& fileName, RouteLandmarks& landmarks);
+
+SHARED_PTR<RouteLandmarks> readRouteLandmarks(const std::string& fileName);
+
+// Loaded sidecars are shared between routing contexts, missing files are remembered as well
+SHARED_PTR<RouteLandmarks> getRouteLandmarks(const std::string& fileName);
+
+// Offline builder: picks landmarks (farthest from already selected starting from (startX31, startY31))
+// and runs full Dijkstra from and to each of them over maps available to the routing context
+SHARED_PTR<RouteLandmarks> buildRouteLandmarks(RoutingContext* ctx, int startX31, int startY31, int landmarksCount,
+											   int zoom);
+
+#endif /*_OSMAND_ROUTE_LANDMARKS_H*/
@@ -8,6 +8,7 @@
 #include "routeSegment.h"
 #include "routeSegmentResult.h"
 #include "routingConfiguration.h"
+#include "gpxChunkedApproximation.h"
 #include "gpxRouteApproximation.h"
 #include "gpxMultiSegmentsApproximation.h"
 #include "gpxSimplePointsMatchApproximation.h"
@@ -17,6 +18,30 @@ SHARED_PTR<RoutingContext> RoutePlannerFrontEnd::buildRoutingContext(
 	return std::make_shared<RoutingContext>(config, rm);
 }
 
+SHARED_PTR<RouteSegmentPoint> buildRecalculationEnd(vector<SHARED_PTR<RouteSegmentResult>>& rlist) {
+	SHARED_PTR<RouteSegmentPoint> recalculationEnd;
+	SHARED_PTR<RouteSegment> previous;
+	for (int i = 0; i < rlist.size(); i++) {
+		auto rr = rlist[i];
+		if (previous) {
+			SHARED_PTR<RouteSegment> segment =
+				std::make_shared<RouteSegment>(rr->object, rr->getStartPointIndex(), rr->getEndPointIndex());
+			previous->parentRoute = segment;
+			previous = segment;
+		} else {
+			recalculationEnd = std::make_shared<RouteSegmentPoint>(rr->object, rr->getStartPointIndex(), 0);
+			if (abs(rr->getEndPointIndex() - rr->getStartPointIndex()) > 1) {
+				SHARED_PTR<RouteSegment> segment = std::make_shared<RouteSegment>(rr->object, recalculationEnd->segmentEnd, rr->getEndPointIndex());
+				recalculationEnd->parentRoute = segment;
+				previous = segment;
+			} else {
+				previous = recalculationEnd;
+			}
+		}
+	}
+	return recalculationEnd;
+}
+
 SHARED_PTR<RouteSegmentPoint> RoutePlannerFrontEnd::getRecalculationEnd(RoutingContext* ctx) {
 	SHARED_PTR<RouteSegmentPoint> recalculationEnd;
 	bool runRecalculation = ctx->previouslyCalculatedRoute.size() > 0 && ctx->config->recalculateDistance != 0;
@@ -32,30 +57,72 @@ SHARED_PTR<RouteSegmentPoint> RoutePlannerFrontEnd::getRecalculationEnd(RoutingC
 		}
 
 		if (rlist.size() > 0) {
-			SHARED_PTR<RouteSegment> previous;
-			for (int i = 0; i < rlist.size(); i++) {
-				auto rr = rlist[i];
-				if (previous) {
-					SHARED_PTR<RouteSegment> segment =
-						std::make_shared<RouteSegment>(rr->object, rr->getStartPointIndex(), rr->getEndPointIndex());
-					previous->parentRoute = segment;
-					previous = segment;
-				} else {
-					recalculationEnd = std::make_shared<RouteSegmentPoint>(rr->object, rr->getStartPointIndex(), 0);
-					if (abs(rr->getEndPointIndex() - rr->getStartPointIndex()) > 1) {
-						SHARED_PTR<RouteSegment> segment = std::make_shared<RouteSegment>(rr->object, recalculationEnd->segmentEnd, rr->getEndPointIndex());
-						recalculationEnd->parentRoute = segment;
-						previous = segment;
-					} else {
-						previous = recalculationEnd;
-					}
-				}
-			}
+			recalculationEnd = buildRecalculationEnd(rlist);
 		}
 	}
 	return recalculationEnd;
 }
 
+SHARED_PTR<RouteSegmentPoint> RoutePlannerFrontEnd::getIncrementalRerouteEnd(RoutingContext* ctx) {
+	auto& prev = ctx->previouslyCalculatedRoute;
+	float radius = ctx->config->rerouteCorridorRadius;
+	if (prev.empty() || radius <= 0) {
+		return nullptr;
+	}
+	// 1. find previous route segment closest to the current position
+	int nearest = -1;
+	double minDist = 0;
+	for (int k = 0; k < prev.size(); k++) {
+		auto& rr = prev[k];
+		auto& o = rr->object;
+		bool plus = rr->getStartPointIndex() < rr->getEndPointIndex();
+		for (int i = rr->getStartPointIndex(); i != rr->getEndPointIndex(); i = plus ? i + 1 : i - 1) {
+			int n = plus ? i + 1 : i - 1;
+			std::pair<int, int> pp = getProjectionPoint(ctx->startX, ctx->startY, o->pointsX[i], o->pointsY[i],
+														o->pointsX[n], o->pointsY[n]);
+			double d = squareRootDist31(pp.first, pp.second, ctx->startX, ctx->startY);
+			if (nearest == -1 || d < minDist) {
+				nearest = k;
+				minDist = d;
+			}
+		}
+	}
+	if (nearest == -1 || minDist > radius) {
+		// driver left the previous route: full recalculation
+		return nullptr;
+	}
+	// 2. splice point is the first segment far enough ahead, keep everything after it untouched
+	float dist = 0;
+	int splice = -1;
+	for (int k = nearest; k < prev.size(); k++) {
+		if (dist >= ctx->config->rerouteSpliceDistance) {
+			splice = k;
+			break;
+		}
+		dist += prev[k]->distance;
+	}
+	if (splice == -1) {
+		// rest of the route is short: full search is cheap enough
+		return nullptr;
+	}
+	vector<SHARED_PTR<RouteSegmentResult>> rlist(prev.begin() + splice, prev.end());
+	float totalDist = 0;
+	float reusedDist = 0;
+	for (int k = 0; k < prev.size(); k++) {
+		totalDist += prev[k]->distance;
+		if (k >= splice) {
+			reusedDist += prev[k]->distance;
+		}
+	}
+	ctx->rerouteCorridor =
+		std::make_shared<RerouteCorridor>(prev, nearest, splice, ctx->startX, ctx->startY, radius);
+	if (ctx->progress) {
+		ctx->progress->rerouteSpliceSegment = splice;
+		ctx->progress->rerouteReusedFraction = totalDist > 0 ? reusedDist / totalDist : 0;
+	}
+	return buildRecalculationEnd(rlist);
+}
+
 void refreshProgressDistance(RoutingContext* ctx) {
 	if (ctx->progress) {
 		ctx->progress->distanceFromBegin = 0;
@@ -140,6 +207,48 @@ vector<SHARED_PTR<RouteSegmentResult>> runRouting(RoutingContext* ctx, SHARED_PT
 	return prepareResult(ctx, result);
 }
 
+vector<SHARED_PTR<RouteSegmentResult>> RoutePlannerFrontEnd::searchRouteIncremental(RoutingContext* ctx, int startX,
+																				   int startY, int endX, int endY) {
+	ctx->startX = startX;
+	ctx->startY = startY;
+	SHARED_PTR<RouteSegmentPoint> recalculationEnd = getIncrementalRerouteEnd(ctx);
+	if (!recalculationEnd) {
+		return {};
+	}
+	int splice = ctx->progress->rerouteSpliceSegment;
+	float reusedTime = 0;
+	for (int k = splice; k < ctx->previouslyCalculatedRoute.size(); k++) {
+		reusedTime += ctx->previouslyCalculatedRoute[k]->routingTime;
+	}
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "[Native] Incremental reroute: splice at segment %d of %d", splice,
+					  (int)ctx->previouslyCalculatedRoute.size());
+	int64_t targetRoadId = ctx->targetRoadId;
+	int targetSegmentInd = ctx->targetSegmentInd;
+	ctx->initTargetPoint(recalculationEnd);
+	refreshProgressDistance(ctx);
+	// tiles loaded by previous calculation stay in context and are reused by corridor search
+	vector<SHARED_PTR<RouteSegmentResult>> result = searchRouteInternal(ctx, false);
+	ctx->rerouteCorridor = nullptr;
+	if (result.empty()) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "[Native] Incremental reroute failed inside corridor");
+		ctx->targetX = endX;
+		ctx->targetY = endY;
+		ctx->targetRoadId = targetRoadId;
+		ctx->targetSegmentInd = targetSegmentInd;
+		// full search runs next with the same context: drop labels and counters of corridor search
+		ctx->resetSegmentsState();
+		ctx->progress->resetSearchStatus();
+		return result;
+	}
+	addPrecalculatedToResult(recalculationEnd, result);
+	copyAttachedToPreAttachedRoutes(result);
+	if (ctx->finalRouteSegment) {
+		// suffix costs are taken from previous calculation
+		ctx->progress->routingCalculatedTime += ctx->finalRouteSegment->distanceFromStart + reusedTime;
+	}
+	return prepareResult(ctx, result);
+}
+
 bool RoutePlannerFrontEnd::hasSegment(vector<SHARED_PTR<RouteSegmentResult>>& result, SHARED_PTR<RouteSegment>& current) {
 	for (SHARED_PTR<RouteSegmentResult> r : result) {
 		int64_t currentId = r->object->id;
@@ -381,6 +490,14 @@ vector<SHARED_PTR<RouteSegmentResult>> RoutePlannerFrontEnd::searchRoute(
 		}
 		ctx->unloadAllData();
 	}
+	if (intermediatesEmpty && useSmartRouteRecalculation && ctx->config->rerouteCorridorRadius > 0) {
+		auto res = searchRouteIncremental(ctx.get(), startX, startY, endX, endY);
+		if (!res.empty()) {
+			makeStartEndPointsPrecise(ctx.get(), res, startX, startY, endX, endY);
+			printResults(ctx.get(), startX, startY, endX, endY, res);
+			return res; // exit-point
+		}
+	}
 	double maxDistance = measuredDist31(startX, startY, endX, endY);
 	if (!intermediatesEmpty) {
 		int x31 = startX;
@@ -646,16 +763,9 @@ void RoutePlannerFrontEnd::setUseGeometryBasedApproximation(bool enabled) {
 	useGeometryBasedApproximation = enabled;
 }
 
-// JNI/iOS entry point for all types of GPX Approximation algorithms
-void RoutePlannerFrontEnd::searchGpxRoute(SHARED_PTR<GpxRouteApproximation>& gctx,
-                                          vector<SHARED_PTR<GpxPoint>>& gpxPoints,
-                                          GpxRouteApproximationCallback acceptor) {
-	gctx->setRouter(this);
-
-	if (!gctx->ctx->progress) {
-		gctx->ctx->progress = std::make_shared<RouteCalculationProgress>();
-	}
-
+// Runs selected algorithm, results are kept in gpxPoints (routeToTarget / targetInd)
+void RoutePlannerFrontEnd::approximateGpxPoints(SHARED_PTR<GpxRouteApproximation>& gctx,
+                                                vector<SHARED_PTR<GpxPoint>>& gpxPoints) {
 	if (useGeometryBasedApproximation) {
 		switch (GPX_SEGMENT_ALGORITHM) {
 			case GPX_OSM_POINTS_MATCH_ALGORITHM:
@@ -669,6 +779,23 @@ void RoutePlannerFrontEnd::searchGpxRoute(SHARED_PTR<GpxRouteApproximation>& gct
 	else {
 		gctx->searchGpxRouteByRouting(gctx, gpxPoints);
 	}
+}
+
+// JNI/iOS entry point for all types of GPX Approximation algorithms
+void RoutePlannerFrontEnd::searchGpxRoute(SHARED_PTR<GpxRouteApproximation>& gctx,
+                                          vector<SHARED_PTR<GpxPoint>>& gpxPoints,
+                                          GpxRouteApproximationCallback acceptor) {
+	gctx->setRouter(this);
+
+	if (!gctx->ctx->progress) {
+		gctx->ctx->progress = std::make_shared<RouteCalculationProgress>();
+	}
+
+	if (gctx->ctx->config->gpxApproximationThreads > 1) {
+		GpxChunkedApproximation(this, gctx, gpxPoints).gpxApproximation();
+	} else {
+		approximateGpxPoints(gctx, gpxPoints);
+	}
 
 	gctx->calculateGpxRouteResult(gctx, gpxPoints);
 	gctx->reconstructFinalPointsFromFullRoute();
@@ -43,6 +43,9 @@ public:
     SHARED_PTR<RoutingContext> buildRoutingContext(SHARED_PTR<RoutingConfiguration> config, RouteCalculationMode rm = RouteCalculationMode::NORMAL);
 
     SHARED_PTR<RouteSegmentPoint> getRecalculationEnd(RoutingContext* ctx);
+    SHARED_PTR<RouteSegmentPoint> getIncrementalRerouteEnd(RoutingContext* ctx);
+    vector<SHARED_PTR<RouteSegmentResult> > searchRouteIncremental(RoutingContext* ctx, int startX, int startY,
+                                                                   int endX, int endY);
 
     vector<SHARED_PTR<RouteSegmentResult> > searchRoute(SHARED_PTR<RoutingContext> ctx,
                                            int startX, int startY,
@@ -56,6 +59,7 @@ public:
 
     vector<SHARED_PTR<GpxPoint>> generateGpxPoints(SHARED_PTR<GpxRouteApproximation>& gctx, const vector<pair<double, double>>& locationsHolder);
     void searchGpxRoute(SHARED_PTR<GpxRouteApproximation>& gctx, vector<SHARED_PTR<GpxPoint>>& gpxPoints, GpxRouteApproximationCallback acceptor = nullptr);
+    void approximateGpxPoints(SHARED_PTR<GpxRouteApproximation>& gctx, vector<SHARED_PTR<GpxPoint>>& gpxPoints);
     static bool hasSegment(vector<SHARED_PTR<RouteSegmentResult>>& result, SHARED_PTR<RouteSegment>& current);
     HHRoutingConfig* setDefaultRoutingConfig();
 
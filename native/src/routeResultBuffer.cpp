@@ -0,0 +1,197 @@
+#ifndef _OSMAND_ROUTE_RESULT_BUFFER_CPP
+#define _OSMAND_ROUTE_RESULT_BUFFER_CPP
+#include "routeResultBuffer.h"
+
+#include <cstring>
+
+#include "binaryRead.h"
+#include "routeSegmentResult.h"
+#include "turnType.h"
+
+void RouteResultBuffer::writeInt(std::vector<uint8_t>& out, int32_t value) {
+	uint32_t v = (uint32_t)value;
+	out.push_back(v & 0xff);
+	out.push_back((v >> 8) & 0xff);
+	out.push_back((v >> 16) & 0xff);
+	out.push_back((v >> 24) & 0xff);
+}
+
+void RouteResultBuffer::writeLong(std::vector<uint8_t>& out, int64_t value) {
+	writeInt(out, (int32_t)(value & 0xffffffff));
+	writeInt(out, (int32_t)((uint64_t)value >> 32));
+}
+
+void RouteResultBuffer::writeFloat(std::vector<uint8_t>& out, float value) {
+	int32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	writeInt(out, bits);
+}
+
+int32_t RouteResultBuffer::getStringIndex(const std::string& value) {
+	auto it = stringIndexes.find(value);
+	if (it != stringIndexes.end()) {
+		return it->second;
+	}
+	int32_t ind = (int32_t)strings.size();
+	strings.push_back(value);
+	stringIndexes[value] = ind;
+	return ind;
+}
+
+int32_t RouteResultBuffer::addObject(RouteDataObject* object) {
+	auto it = objectIndexes.find(object);
+	if (it != objectIndexes.end()) {
+		return it->second;
+	}
+	int32_t ind = (int32_t)objects.size();
+	objects.push_back(object);
+	objectIndexes[object] = ind;
+	return ind;
+}
+
+// Collects segment with its attached routes (segments are numbered in order of collection)
+int32_t RouteResultBuffer::addSegment(const SHARED_PTR<RouteSegmentResult>& segment) {
+	auto it = segmentIndexes.find(segment.get());
+	if (it != segmentIndexes.end()) {
+		return it->second;
+	}
+	int32_t ind = (int32_t)segments.size();
+	segments.push_back(segment);
+	segmentIndexes[segment.get()] = ind;
+	addObject(segment->object.get());
+	for (const auto& attached : segment->attachedRoutes) {
+		for (const auto& s : attached) {
+			addSegment(s);
+		}
+	}
+	return ind;
+}
+
+void RouteResultBuffer::writeObject(RouteDataObject* object, const UNORDERED(map)<int64_t, int>& regionIndexes) {
+	writeLong(body, object->id);
+	int32_t region = -1;
+	if (object->region) {
+		auto it = regionIndexes.find((object->region->filePointer << 31) + object->region->length);
+		region = it != regionIndexes.end() ? it->second : -1;
+	}
+	writeInt(body, region);
+	writeInt(body, (int32_t)object->types.size());
+	for (uint32_t t : object->types) {
+		writeInt(body, t);
+	}
+	writeInt(body, (int32_t)object->pointsX.size());
+	for (uint32_t x : object->pointsX) {
+		writeInt(body, x);
+	}
+	for (uint32_t y : object->pointsY) {
+		writeInt(body, y);
+	}
+	writeInt(body, (int32_t)object->names.size());
+	for (const auto& name : object->names) {
+		writeInt(body, name.first);
+		writeInt(body, getStringIndex(name.second));
+	}
+	writeInt(body, (int32_t)object->restrictions.size());
+	for (const auto& r : object->restrictions) {
+		writeLong(body, r.to);
+		writeLong(body, r.via);
+		writeInt(body, r.type);
+	}
+	writeInt(body, (int32_t)object->pointTypes.size());
+	for (const auto& types : object->pointTypes) {
+		writeInt(body, (int32_t)types.size());
+		for (uint32_t t : types) {
+			writeInt(body, t);
+		}
+	}
+	// Point name types and names are written independently (as in per-object export), sizes could differ
+	writeInt(body, (int32_t)object->pointNameTypes.size());
+	for (const auto& types : object->pointNameTypes) {
+		writeInt(body, (int32_t)types.size());
+		for (uint32_t t : types) {
+			writeInt(body, t);
+		}
+	}
+	writeInt(body, (int32_t)object->pointNames.size());
+	for (const auto& names : object->pointNames) {
+		writeInt(body, (int32_t)names.size());
+		for (const auto& name : names) {
+			writeInt(body, getStringIndex(name));
+		}
+	}
+}
+
+void RouteResultBuffer::writeSegment(RouteSegmentResult* segment) {
+	writeInt(body, objectIndexes[segment->object.get()]);
+	writeInt(body, segment->getStartPointIndex());
+	writeInt(body, segment->getEndPointIndex());
+	writeFloat(body, segment->segmentTime);
+	writeFloat(body, segment->routingTime);
+	writeFloat(body, segment->segmentSpeed);
+	writeFloat(body, segment->distance);
+	writeInt(body, segment->getGpxPointIndex());
+	const auto& tt = segment->turnType;
+	writeInt(body, tt ? 1 : 0);
+	if (tt) {
+		writeInt(body, tt->getValue());
+		writeInt(body, tt->getExitOut());
+		writeFloat(body, tt->getTurnAngle());
+		writeInt(body, tt->isSkipToSpeak() ? 1 : 0);
+		writeInt(body, tt->isPossibleLeftTurn() ? 1 : 0);
+		writeInt(body, tt->isPossibleRightTurn() ? 1 : 0);
+		const auto& lanes = tt->getLanes();
+		writeInt(body, (int32_t)lanes.size());
+		for (int lane : lanes) {
+			writeInt(body, lane);
+		}
+	}
+	writeInt(body, (int32_t)segment->attachedRoutes.size());
+	for (const auto& attached : segment->attachedRoutes) {
+		writeInt(body, (int32_t)attached.size());
+		for (const auto& s : attached) {
+			writeInt(body, segmentIndexes[s.get()]);
+		}
+	}
+}
+
+void RouteResultBuffer::write(const std::vector<SHARED_PTR<RouteSegmentResult>>& route,
+							  const UNORDERED(map)<int64_t, int>& regionIndexes) {
+	for (const auto& segment : route) {
+		addSegment(segment);
+	}
+	writeInt(body, (int32_t)objects.size());
+	for (RouteDataObject* object : objects) {
+		writeObject(object, regionIndexes);
+	}
+	writeInt(body, (int32_t)segments.size());
+	for (const auto& segment : segments) {
+		writeSegment(segment.get());
+	}
+	writeInt(body, (int32_t)route.size());
+	for (const auto& segment : route) {
+		writeInt(body, segmentIndexes[segment.get()]);
+	}
+
+	size_t stringsLength = 0;
+	for (const std::string& s : strings) {
+		stringsLength += s.size();
+	}
+	data.clear();
+	data.reserve(16 + 4 * strings.size() + stringsLength + body.size());
+	writeInt(data, ROUTE_RESULT_BUFFER_MAGIC);
+	writeInt(data, ROUTE_RESULT_BUFFER_VERSION);
+	writeInt(data, (int32_t)strings.size());
+	int32_t offset = 0;
+	for (const std::string& s : strings) {
+		writeInt(data, offset);
+		offset += (int32_t)s.size();
+	}
+	writeInt(data, offset);
+	for (const std::string& s : strings) {
+		data.insert(data.end(), s.begin(), s.end());
+	}
+	data.insert(data.end(), body.begin(), body.end());
+	body.clear();
+}
+
+#endif /*_OSMAND_ROUTE_RESULT_BUFFER_CPP*/
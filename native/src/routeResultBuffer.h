@@ -0,0 +1,60 @@
+#ifndef _OSMAND_ROUTE_RESULT_BUFFER_H
+#define _OSMAND_ROUTE_RESULT_BUFFER_H
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct RouteDataObject;
+struct RouteSegmentResult;
+
+// Compact binary form of route result which is passed to Java in one direct buffer and decoded there
+// lazily (instead of creating Java objects field by field). Numbers are little endian, strings are stored
+// once in dictionary (UTF-8) and referenced by index, road objects are stored once and referenced
+// by segments (including attached routes).
+//
+// header:   int32 magic (ROUTE_RESULT_BUFFER_MAGIC), int32 version
+// strings:  int32 count, int32 offsets[count + 1] (from the start of string bytes), bytes
+// objects:  int32 count, for every object:
+//           int64 id, int32 region (index in regions, -1 unknown),
+//           int32 n, int32 types[n], int32 n, int32 x31[n], int32 y31[n],
+//           int32 n, (int32 nameType, int32 string)[n],
+//           int32 n, (int64 to, int64 via, int32 type)[n] (restrictions),
+//           int32 points, for every point: int32 n, int32 pointTypes[n],
+//           int32 points, for every point: int32 n, int32 pointNameTypes[n],
+//           int32 points, for every point: int32 n, int32 pointNames[n] (strings)
+// segments: int32 count, for every segment:
+//           int32 object, int32 startPointIndex, int32 endPointIndex,
+//           float segmentTime, float routingTime, float segmentSpeed, float distance, int32 gpxPointIndex,
+//           int32 hasTurn, if hasTurn: int32 value, int32 exitOut, float turnAngle, int32 skipToSpeak,
+//           int32 possibleLeftTurn, int32 possibleRightTurn, int32 n, int32 lanes[n],
+//           int32 points, for every point: int32 n, int32 attachedSegments[n]
+// route:    int32 n, int32 segments[n]
+class RouteResultBuffer {
+	std::vector<uint8_t> body;
+	std::vector<std::string> strings;
+	UNORDERED(map)<std::string, int32_t> stringIndexes;
+	UNORDERED(map)<RouteDataObject*, int32_t> objectIndexes;
+	std::vector<RouteDataObject*> objects;
+	UNORDERED(map)<RouteSegmentResult*, int32_t> segmentIndexes;
+	std::vector<SHARED_PTR<RouteSegmentResult>> segments;
+
+	void writeInt(std::vector<uint8_t>& out, int32_t value);
+	void writeLong(std::vector<uint8_t>& out, int64_t value);
+	void writeFloat(std::vector<uint8_t>& out, float value);
+	int32_t getStringIndex(const std::string& value);
+	int32_t addObject(RouteDataObject* object);
+	int32_t addSegment(const SHARED_PTR<RouteSegmentResult>& segment);
+	void writeObject(RouteDataObject* object, const UNORDERED(map)<int64_t, int>& regionIndexes);
+	void writeSegment(RouteSegmentResult* segment);
+
+   public:
+	const static int32_t ROUTE_RESULT_BUFFER_MAGIC = 0x4252524F;  // "ORRB"
+	const static int32_t ROUTE_RESULT_BUFFER_VERSION = 2;
+
+	std::vector<uint8_t> data;
+
+	// regionIndexes: index in Java regions by (filePointer << 31) + length of routing index
+	void write(const std::vector<SHARED_PTR<RouteSegmentResult>>& route,
+			   const UNORDERED(map)<int64_t, int>& regionIndexes);
+};
+
+#endif /*_OSMAND_ROUTE_RESULT_BUFFER_H*/
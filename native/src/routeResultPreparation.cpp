@@ -10,10 +10,15 @@
 #include "roadSplitStructure.h"
 #include "roundaboutTurn.h"
 
+#include <functional>
+#include <thread>
+
 const int MAX_SPEAK_PRIORITY = 5;
 const float TURN_DEGREE_MIN = 45;
 const float UNMATCHED_TURN_DEGREE_MINIMUM = 45;
 const float SPLIT_TURN_DEGREE_NOT_STRAIGHT = 100;
+// minimal number of route segments in chunk processed by separate thread
+const int PREPARE_RESULT_MIN_CHUNK = 64;
 
 const int TurnType::TURNS_ORDER[9] = {TU, TSHL, TL, TSLL, C, TSLR, TR, TSHR, TRU};
 
@@ -117,13 +122,16 @@ void validateAllPointsConnected(vector<SHARED_PTR<RouteSegmentResult> >& result)
     }
 }
 
+// Road segments at route points by location, loaded before roads are attached so attachment only reads them
+typedef UNORDERED(map)<int64_t, vector<SHARED_PTR<RouteSegment>>> RoutePointsSegments;
+
 // try to attach all segments except with current id
-void attachSegments(RoutingContext* ctx, const SHARED_PTR<RouteSegment>& routeSegment, const SHARED_PTR<RouteDataObject>& road, const SHARED_PTR<RouteSegmentResult>& rr, int64_t previousRoadId, int pointInd, int64_t prevL, int64_t nextL) {
+void attachSegments(GeneralRouter* router, const SHARED_PTR<RouteSegment>& routeSegment, const SHARED_PTR<RouteDataObject>& road, const SHARED_PTR<RouteSegmentResult>& rr, int64_t previousRoadId, int pointInd, int64_t prevL, int64_t nextL) {
     if (routeSegment->road->getId() != road->getId() && routeSegment->road->getId() != previousRoadId) {
         auto addRoad = routeSegment->road;
         //checkAndInitRouteRegion(ctx, addRoad); ? TODO
         // Future: restrictions can be considered as well
-        int oneWay = ctx->config->router->isOneWay(addRoad);
+        int oneWay = router->isOneWay(addRoad);
         if (oneWay >= 0 && routeSegment->getSegmentStart() < addRoad->getPointsLength() - 1) {
             int64_t pointL = getPoint(addRoad, routeSegment->getSegmentStart() + 1);
             if (pointL != nextL && pointL != prevL) {
@@ -143,7 +151,7 @@ void attachSegments(RoutingContext* ctx, const SHARED_PTR<RouteSegment>& routeSe
     }
 }
 
-void attachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result, int routeInd, int pointInd, bool plus) {
+void attachRoadSegments(GeneralRouter* router, const RoutePointsSegments& pointsSegments, vector<SHARED_PTR<RouteSegmentResult> >& result, int routeInd, int pointInd, bool plus) {
     auto rr = result[routeInd];
     auto road = rr->object;
     int64_t nextL = pointInd < road->getPointsLength() - 1 ? getPoint(road, pointInd + 1) : 0;
@@ -171,18 +179,67 @@ void attachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResul
         const auto& list = rr->getPreAttachedRoutes(pointInd);
         for (auto r : list) {
             auto rs = std::make_shared<RouteSegment>(r->object, r->getStartPointIndex(), r->getEndPointIndex());
-            attachSegments(ctx, rs, road, rr, previousRoadId, pointInd, prevL, nextL);
+            attachSegments(router, rs, road, rr, previousRoadId, pointInd, prevL, nextL);
         }
     } else {
-        auto segments = ctx->loadRouteSegment(road->pointsX[pointInd], road->pointsY[pointInd]);
-		for (auto& segment : segments) {
-			attachSegments(ctx, segment, road, rr, previousRoadId, pointInd, prevL, nextL);
-		}
+        const auto it = pointsSegments.find(getPoint(road, pointInd));
+        if (it != pointsSegments.end()) {
+            for (auto& segment : it->second) {
+                attachSegments(router, segment, road, rr, previousRoadId, pointInd, prevL, nextL);
+            }
+        }
 	}
 }
 
-void splitRoadsAndAttachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result) {
-    for (int i = 0; i < result.size(); i++) {
+// Loads segments at all route points where roads could be attached, tiles loaded by search are reused
+// and every location is looked up once (ends of route segments are shared with next ones)
+void loadRoutePointsSegments(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result, RoutePointsSegments& pointsSegments) {
+    for (auto& rr : result) {
+        auto& road = rr->object;
+        bool plus = rr->getStartPointIndex() < rr->getEndPointIndex();
+        for (int j = rr->getStartPointIndex(); j != rr->getEndPointIndex(); j = plus ? j + 1 : j - 1) {
+            if (!rr->getPreAttachedRoutes(j).empty()) {
+                continue;
+            }
+            int64_t l = getPoint(road, j);
+            if (pointsSegments.find(l) == pointsSegments.end()) {
+                pointsSegments[l] = ctx->loadRouteSegment(road->pointsX[j], road->pointsY[j]);
+            }
+        }
+    }
+}
+
+int getPrepareResultChunks(RoutingContext* ctx, size_t size) {
+    int threads = ctx->config->prepareResultThreads;
+    if (threads < 2) {
+        return 1;
+    }
+    return std::max(1, std::min(threads, (int)(size / PREPARE_RESULT_MIN_CHUNK)));
+}
+
+// Runs task for every chunk in separate thread
+void runPrepareResultChunks(const vector<SHARED_PTR<RouteSegmentResult> >& result, int chunks,
+                            const std::function<void(int)>& task) {
+    // decoding rules of regions are built lazily (searchRouteEncodingRule), build them before chunks start
+    UNORDERED(set)<RoutingIndex*> regions;
+    for (auto& r : result) {
+        if (r->object->region && regions.insert(r->object->region.get()).second) {
+            r->object->region->initDecodingRules();
+        }
+    }
+    std::vector<std::thread> workers;
+    for (int c = 1; c < chunks; c++) {
+        workers.push_back(std::thread(task, c));
+    }
+    task(0);
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+// Splits and attaches route segments from first (previous segments are only read)
+void splitRoadsAndAttachRoadSegments(GeneralRouter* router, const RoutePointsSegments& pointsSegments, vector<SHARED_PTR<RouteSegmentResult> >& result, int first) {
+    for (int i = first; i < result.size(); i++) {
         //ctx->unloadUnusedTiles(ctx->config->memoryLimitation);
         
         auto rr = result[i];
@@ -194,10 +251,10 @@ void splitRoadsAndAttachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<Rout
         for (int j = rr->getStartPointIndex(); j != rr->getEndPointIndex(); j = next) {
             next = plus ? j + 1 : j - 1;
             if (j == rr->getStartPointIndex()) {
-                attachRoadSegments(ctx, result, i, j, plus);
+                attachRoadSegments(router, pointsSegments, result, i, j, plus);
             }
             if (next != rr->getEndPointIndex()) {
-                attachRoadSegments(ctx, result, i, next, plus);
+                attachRoadSegments(router, pointsSegments, result, i, next, plus);
             }
             const auto& attachedRoutes = rr->getAttachedRoutes(next);
             bool tryToSplit = next != rr->getEndPointIndex() && !rr->object->roundabout();
@@ -246,6 +303,37 @@ void splitRoadsAndAttachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<Rout
     }
 }
 
+void splitRoadsAndAttachRoadSegments(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result) {
+    RoutePointsSegments pointsSegments;
+    loadRoutePointsSegments(ctx, result, pointsSegments);
+    int chunks = getPrepareResultChunks(ctx, result.size());
+    if (chunks < 2) {
+        splitRoadsAndAttachRoadSegments(ctx->config->router.get(), pointsSegments, result, 0);
+        return;
+    }
+    // chunks are processed separately and joined in order, so result is the same as sequential one
+    vector<vector<SHARED_PTR<RouteSegmentResult>>> parts(chunks);
+    vector<SHARED_PTR<GeneralRouter>> routers(chunks);
+    for (int c = 0; c < chunks; c++) {
+        size_t begin = result.size() * c / chunks;
+        size_t end = result.size() * (c + 1) / chunks;
+        if (c > 0) {
+            // copy of previous segment (it is changed by split in other chunk, but its direction and end are kept)
+            auto& prev = result[begin - 1];
+            parts[c].push_back(std::make_shared<RouteSegmentResult>(prev->object, prev->getStartPointIndex(), prev->getEndPointIndex()));
+        }
+        parts[c].insert(parts[c].end(), result.begin() + begin, result.begin() + end);
+        routers[c] = ctx->config->router->clone();
+    }
+    runPrepareResultChunks(result, chunks, [&](int c) {
+        splitRoadsAndAttachRoadSegments(routers[c].get(), pointsSegments, parts[c], c > 0 ? 1 : 0);
+    });
+    result.clear();
+    for (int c = 0; c < chunks; c++) {
+        result.insert(result.end(), parts[c].begin() + (c > 0 ? 1 : 0), parts[c].end());
+    }
+}
+
 void calculateTimeSpeed(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult>>& result) {
     for (int i = 0; i < result.size(); i++) {
         calculateTimeSpeed(ctx, result[i]);
@@ -2052,10 +2140,41 @@ void muteAndRemoveTurns(vector<SHARED_PTR<RouteSegmentResult> >& result) {
     }
 }
 
+bool sameTurnLanes(const SHARED_PTR<TurnType>& t1, const SHARED_PTR<TurnType>& t2) {
+    if (!t1 || !t2) {
+        return (!t1 || t1->getLanes().empty()) && (!t2 || t2->getLanes().empty());
+    }
+    return t1->getLanes() == t2->getLanes();
+}
+
 void prepareTurnResults(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result) {
-    for (int i = 0; i < result.size(); i ++) {
-        const auto& turnType = getTurnInfo(result, i, ctx->leftSideNavigation);
-        result[i]->turnType = turnType;
+    int chunks = getPrepareResultChunks(ctx, result.size());
+    if (chunks < 2) {
+        for (int i = 0; i < result.size(); i ++) {
+            const auto& turnType = getTurnInfo(result, i, ctx->leftSideNavigation);
+            result[i]->turnType = turnType;
+        }
+    } else {
+        // first segment of chunk isn't calculated in parallel (it is previous one for other chunk)
+        runPrepareResultChunks(result, chunks, [&](int c) {
+            int begin = (int)(result.size() * c / chunks) + (c > 0 ? 1 : 0);
+            int end = (int)(result.size() * (c + 1) / chunks);
+            for (int i = begin; i < end; i++) {
+                result[i]->turnType = getTurnInfo(result, i, ctx->leftSideNavigation);
+            }
+        });
+        // turn depends on lanes of previous turn, so turns from chunk start are recalculated
+        // in order until they match parallel ones
+        for (int c = 1; c < chunks; c++) {
+            for (int i = (int)(result.size() * c / chunks); i < result.size(); i++) {
+                const auto turnType = getTurnInfo(result, i, ctx->leftSideNavigation);
+                bool same = sameTurnLanes(turnType, result[i]->turnType);
+                result[i]->turnType = turnType;
+                if (same) {
+                    break;
+                }
+            }
+        }
     }
     
     determineTurnsToMerge(ctx->leftSideNavigation, result);
@@ -2067,14 +2186,33 @@ void prepareTurnResults(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResul
 }
 
 vector<SHARED_PTR<RouteSegmentResult> > prepareResult(RoutingContext* ctx, vector<SHARED_PTR<RouteSegmentResult> >& result) {
+	SHARED_PTR<RouteCalculationProgress> progress = ctx->progress;
+	if (progress) {
+		progress->timeToPrepareAreaRouting.Start();
+	}
 	combineWayPointsForAreaRouting(ctx, result);
 	validateAllPointsConnected(result);
+	if (progress) {
+		progress->timeToPrepareAreaRouting.Pause();
+		progress->timeToAttachRoads.Start();
+	}
 	splitRoadsAndAttachRoadSegments(ctx, result);
 	for (auto it = result.begin(); it != result.end(); ++it) {
 		filterMinorStops(*it);
 	}
+	if (progress) {
+		progress->timeToAttachRoads.Pause();
+		progress->timeToCalculateTimeSpeed.Start();
+	}
 	calculateTimeSpeed(ctx, result);
+	if (progress) {
+		progress->timeToCalculateTimeSpeed.Pause();
+		progress->timeToPrepareTurns.Start();
+	}
 	prepareTurnResults(ctx, result);
+	if (progress) {
+		progress->timeToPrepareTurns.Pause();
+	}
 	return result;
 }
 
@@ -0,0 +1,82 @@
+#ifndef _OSMAND_ROUTE_SEGMENT_GRID_CPP
+#define _OSMAND_ROUTE_SEGMENT_GRID_CPP
+
+#include "routeSegmentGrid.h"
+
+#include "binaryRead.h"
+
+void RouteSegmentGrid::addRoad(const SHARED_PTR<RouteDataObject>& road) {
+	if (road->pointsX.size() < 2 || !indexedRoads.insert(road->id).second) {
+		return;
+	}
+	uint32_t roadInd = (uint32_t)roads.size();
+	roads.push_back(road);
+	const double step = (1 << (31 - ZOOM)) / 2.0;
+	for (uint j = 1; j < road->pointsX.size(); j++) {
+		double ax = road->pointsX[j - 1];
+		double ay = road->pointsY[j - 1];
+		double bx = road->pointsX[j];
+		double by = road->pointsY[j];
+		int samples = (int)(std::max(std::abs(bx - ax), std::abs(by - ay)) / step) + 1;
+		int64_t lastCell = -1;
+		for (int s = 0; s <= samples; s++) {
+			double c = s / (double)samples;
+			int64_t cellId = getCellId((int)(ax + (bx - ax) * c), (int)(ay + (by - ay) * c));
+			if (cellId == lastCell) {
+				continue;
+			}
+			lastCell = cellId;
+			Cell& cell = cells[cellId];
+			cell.ax.push_back(ax);
+			cell.ay.push_back(ay);
+			cell.bx.push_back(bx);
+			cell.by.push_back(by);
+			cell.road.push_back(roadInd);
+			cell.segment.push_back(j);
+		}
+	}
+}
+
+void RouteSegmentGrid::findNearestSegments(int px, int py,
+										   UNORDERED(map)<uint32_t, std::pair<int, double>>& nearest) {
+	nearest.clear();
+	int cx = px >> (31 - ZOOM);
+	int cy = py >> (31 - ZOOM);
+	std::vector<double> dist;
+	const double x = px;
+	const double y = py;
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			const auto it = cells.find(((int64_t)(cx + i) << ZOOM) + (cy + j));
+			if (it == cells.end()) {
+				continue;
+			}
+			const Cell& cell = it->second;
+			size_t n = cell.ax.size();
+			dist.resize(n);
+			const double* ax = cell.ax.data();
+			const double* ay = cell.ay.data();
+			const double* bx = cell.bx.data();
+			const double* by = cell.by.data();
+			double* d = dist.data();
+			// branchless projection on segment (vectorized)
+			for (size_t k = 0; k < n; k++) {
+				double dx = bx[k] - ax[k];
+				double dy = by[k] - ay[k];
+				double t = ((x - ax[k]) * dx + (y - ay[k]) * dy) / (dx * dx + dy * dy + 1e-9);
+				t = t < 0 ? 0 : (t > 1 ? 1 : t);
+				double qx = ax[k] + t * dx - x;
+				double qy = ay[k] + t * dy - y;
+				d[k] = qx * qx + qy * qy;
+			}
+			for (size_t k = 0; k < n; k++) {
+				auto r = nearest.insert(std::make_pair(cell.road[k], std::make_pair((int)cell.segment[k], d[k])));
+				if (!r.second && d[k] < r.first->second.second) {
+					r.first->second = std::make_pair((int)cell.segment[k], d[k]);
+				}
+			}
+		}
+	}
+}
+
+#endif /*_OSMAND_ROUTE_SEGMENT_GRID_CPP*/
@@ -0,0 +1,51 @@
+#ifndef _OSMAND_ROUTE_SEGMENT_GRID_H
+#define _OSMAND_ROUTE_SEGMENT_GRID_H
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct RouteDataObject;
+
+// Segments of roads loaded by context indexed by grid cells (zoom 17) to snap many points at once.
+// Cell keeps coordinates of segments as separate arrays, so distances to all segments of the cell
+// are calculated by one loop which compiler vectorizes.
+// Segment is added to cells of points sampled along it every half of cell, nearby cells are checked by query,
+// so roads closer than 3/4 of cell to the point are always found.
+struct RouteSegmentGrid {
+	const static int ZOOM = 17;
+
+	struct Cell {
+		std::vector<double> ax, ay, bx, by;
+		std::vector<uint32_t> road;
+		std::vector<uint32_t> segment;
+	};
+
+	// areas (cells) around which roads were loaded by loadTileData
+	UNORDERED(set)<int64_t> indexedAreas;
+	UNORDERED(set)<int64_t> indexedRoads;
+	std::vector<SHARED_PTR<RouteDataObject>> roads;
+	UNORDERED(map)<int64_t, Cell> cells;
+
+	static int64_t getCellId(int x31, int y31) {
+		return ((int64_t)(x31 >> (31 - ZOOM)) << ZOOM) + (y31 >> (31 - ZOOM));
+	}
+
+	bool isIndexed(int x31, int y31) { return indexedAreas.find(getCellId(x31, y31)) != indexedAreas.end(); }
+
+	void setIndexed(int x31, int y31) { indexedAreas.insert(getCellId(x31, y31)); }
+
+	void addRoad(const SHARED_PTR<RouteDataObject>& road);
+
+	// Nearest segment of every road in cells around point: road index -> (segment end index, square distance in 31
+	// coordinates)
+	void findNearestSegments(int px, int py, UNORDERED(map)<uint32_t, std::pair<int, double>>& nearest);
+
+	void clear() {
+		indexedAreas.clear();
+		indexedRoads.clear();
+		roads.clear();
+		cells.clear();
+	}
+};
+
+#endif /*_OSMAND_ROUTE_SEGMENT_GRID_H*/
@@ -353,6 +353,80 @@ void RouteSegmentResult::writeToBundle(SHARED_PTR<RouteDataBundle>& bundle) {
 	resources->updateNextSegmentStartLocation(length);
 }
 
+void RouteSegmentResult::writeRouteBinary(vector<SHARED_PTR<RouteSegmentResult>>& route,
+										  SHARED_PTR<RouteDataResources>& resources, vector<uint8_t>& out) {
+	for (auto& segment : route) {
+		segment->collectTypes(resources);
+	}
+	for (auto& segment : route) {
+		segment->collectNames(resources);
+	}
+	// segments add rules of point names, so rules are written after them and string table is written last
+	vector<uint8_t> body;
+	RouteDataBundle::writeVarint(body, (uint32_t)route.size());
+	for (auto& segment : route) {
+		auto bundle = std::make_shared<RouteDataBundle>(resources);
+		segment->writeToBundle(bundle);
+		bundle->writeBinary(body);
+	}
+	RouteDataBundle::writeVarint(body, (uint32_t)resources->insertOrder.size());
+	for (const auto& rule : resources->insertOrder) {
+		auto bundle = std::make_shared<RouteDataBundle>(resources);
+		rule.writeToBundle(bundle);
+		bundle->writeBinary(body);
+	}
+	RouteDataBundle::writeStringTable(resources->strings, out);
+	out.insert(out.end(), body.begin(), body.end());
+}
+
+bool RouteSegmentResult::readRouteBinary(const vector<uint8_t>& in, SHARED_PTR<RouteDataResources>& resources,
+										 vector<SHARED_PTR<RouteSegmentResult>>& route) {
+	size_t pos = 0;
+	vector<string> strings;
+	uint32_t count;
+	if (!RouteDataBundle::readStringTable(in, pos, strings) || !RouteDataBundle::readVarint(in, pos, count) ||
+		count > in.size() - pos) {
+		return false;
+	}
+	vector<SHARED_PTR<RouteDataBundle>> segmentBundles;
+	for (uint32_t i = 0; i < count; i++) {
+		auto bundle = std::make_shared<RouteDataBundle>(resources);
+		if (!bundle->readBinary(in, pos, strings)) {
+			return false;
+		}
+		segmentBundles.push_back(bundle);
+	}
+	if (!RouteDataBundle::readVarint(in, pos, count) || count > in.size() - pos) {
+		return false;
+	}
+	SHARED_PTR<RoutingIndex> region = std::make_shared<RoutingIndex>();
+	for (uint32_t i = 0; i < count; i++) {
+		RouteDataBundle bundle(resources);
+		if (!bundle.readBinary(in, pos, strings)) {
+			return false;
+		}
+		region->initRouteEncodingRule(i, bundle.getString("t", ""), bundle.getString("v", ""));
+	}
+	vector<SHARED_PTR<RouteSegmentResult>> segments;
+	try {
+		for (auto& bundle : segmentBundles) {
+			auto object = std::make_shared<RouteDataObject>();
+			object->region = region;
+			auto segment = std::make_shared<RouteSegmentResult>(object);
+			segment->readFromBundle(bundle);
+			segments.push_back(segment);
+		}
+	} catch (const std::invalid_argument& e) {
+		// less locations than segments need
+		return false;
+	}
+	for (auto& segment : segments) {
+		segment->fillNames(resources);
+	}
+	route.insert(route.end(), segments.begin(), segments.end());
+	return true;
+}
+
 void RouteSegmentResult::attachRoute(int roadIndex, SHARED_PTR<RouteSegmentResult> r) {
 	if (r->object->isRoadDeleted()) {
 		return;
@@ -76,6 +76,14 @@ struct RouteSegmentResult {
 
 	void readFromBundle(SHARED_PTR<RouteDataBundle>& bundle);
 	void writeToBundle(SHARED_PTR<RouteDataBundle>& bundle);
+
+	// Route saved as binary bundles (see RouteDataBundle::writeBinary): string table, varint count of segment
+	// bundles and bundles, varint count of rule bundles and bundles. Locations of route are not written, they are
+	// saved by caller (as track of GPX) and passed in resources to read route, which has region with saved rules.
+	static void writeRouteBinary(vector<SHARED_PTR<RouteSegmentResult>>& route,
+								 SHARED_PTR<RouteDataResources>& resources, vector<uint8_t>& out);
+	static bool readRouteBinary(const vector<uint8_t>& in, SHARED_PTR<RouteDataResources>& resources,
+								vector<SHARED_PTR<RouteSegmentResult>>& route);
 	LatLon getStartPoint();
 	LatLon getEndPoint();
 	LatLon getPoint(int i);
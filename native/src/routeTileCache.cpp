@@ -0,0 +1,39 @@
+#ifndef _OSMAND_ROUTE_TILE_CACHE_CPP
+#define _OSMAND_ROUTE_TILE_CACHE_CPP
+
+#include "routeTileCache.h"
+
+#include "Logging.h"
+
+void RouteTileCache::readTile(RouteSubregion& subregion, bool geocoding, std::vector<RouteDataObject*>& res) {
+	std::lock_guard<std::mutex> guard(readMutex);
+	int64_t key = ((int64_t)subregion.left << 31) + subregion.filePointer;
+	auto it = tiles.find(key);
+	if (it == tiles.end()) {
+		misses++;
+		std::vector<RouteDataObject*> decoded;
+		SearchQuery q;
+		searchRouteDataForSubRegion(&q, decoded, &subregion, geocoding);
+		if (size > maxSize) {
+			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Clear shared route tiles %d Mb (%d tiles)",
+							  (int)(size / (1024 * 1024)), (int)tiles.size());
+			tiles.clear();
+			size = 0;
+		}
+		std::vector<SHARED_PTR<RouteDataObject>>& objects = tiles[key];
+		for (RouteDataObject* o : decoded) {
+			if (o != NULL) {
+				size += o->getSize();
+				objects.push_back(SHARED_PTR<RouteDataObject>(o));
+			}
+		}
+		it = tiles.find(key);
+	} else {
+		hits++;
+	}
+	for (auto& o : it->second) {
+		res.push_back(new RouteDataObject(*o));
+	}
+}
+
+#endif /*_OSMAND_ROUTE_TILE_CACHE_CPP*/
@@ -0,0 +1,32 @@
+#ifndef _OSMAND_ROUTE_TILE_CACHE_H
+#define _OSMAND_ROUTE_TILE_CACHE_H
+
+#include <mutex>
+
+#include "CommonCollections.h"
+#include "binaryRead.h"
+#include "commonOsmAndCore.h"
+
+// Decoded route tiles shared by routing contexts running in parallel threads (chunked GPX approximation).
+// Map files (descriptors, route encoding rules) are shared as well, so everything
+// that reads them is done under readMutex. Contexts get own copies of cached objects
+// because objects are changed by conditional tags and by result preparation.
+class RouteTileCache {
+	UNORDERED(map)<int64_t, std::vector<SHARED_PTR<RouteDataObject>>> tiles;
+	long size;
+	long maxSize;
+
+   public:
+	std::mutex readMutex;
+	int hits;
+	int misses;
+
+	RouteTileCache(long memoryLimitMB) : size(0), maxSize(memoryLimitMB * 1024 * 1024), hits(0), misses(0) {}
+
+	// Copies objects of subregion to res (ownership goes to caller), decodes subregion if it is not cached yet
+	void readTile(RouteSubregion& subregion, bool geocoding, std::vector<RouteDataObject*>& res);
+
+	std::unique_lock<std::mutex> lock() { return std::unique_lock<std::mutex>(readMutex); }
+};
+
+#endif /*_OSMAND_ROUTE_TILE_CACHE_H*/
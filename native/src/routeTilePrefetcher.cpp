@@ -0,0 +1,156 @@
+#ifndef _OSMAND_ROUTE_TILE_PREFETCHER_CPP
+#define _OSMAND_ROUTE_TILE_PREFETCHER_CPP
+
+#include "routeTilePrefetcher.h"
+
+#include "ElapsedTimer.h"
+#include "Logging.h"
+
+RouteTilePrefetcher::RouteTilePrefetcher(int maxTiles)
+	: stopped(false), resultsHead(0), resultsTail(0), maxTiles(std::min(std::max(maxTiles, 1), RESULTS_CAPACITY)) {
+	worker = std::thread(&RouteTilePrefetcher::run, this);
+}
+
+RouteTilePrefetcher::~RouteTilePrefetcher() {
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		stopped = true;
+		requests.clear();
+	}
+	requestsCondition.notify_one();
+	if (worker.joinable()) {
+		worker.join();
+	}
+	drainResults();
+	for (auto& r : ready) {
+		discardResult(r.second);
+	}
+	ready.clear();
+}
+
+void RouteTilePrefetcher::run() {
+	while (true) {
+		std::unique_ptr<RouteTilePrefetchRequest> request;
+		{
+			std::unique_lock<std::mutex> lock(requestsMutex);
+			requestsCondition.wait(lock, [this] { return stopped || !requests.empty(); });
+			if (stopped) {
+				return;
+			}
+			request.reset(new RouteTilePrefetchRequest(requests.front()));
+			requests.pop_front();
+		}
+		OsmAnd::ElapsedTimer timer;
+		timer.Start();
+		RouteTilePrefetchResult* r = new RouteTilePrefetchResult(request->key);
+		readRouteSubRegionData(request->fd, r->objects, request->routingIndex, &request->subregion);
+		timer.Pause();
+		r->decodeNanos = timer.GetElapsedNanos();
+		// search thread never keeps more than maxTiles <= RESULTS_CAPACITY requested tiles, so ring can't overflow
+		uint32_t tail = resultsTail.load(std::memory_order_relaxed);
+		results[tail % RESULTS_CAPACITY] = r;
+		resultsTail.store(tail + 1, std::memory_order_release);
+	}
+}
+
+void RouteTilePrefetcher::drainResults() {
+	uint32_t head = resultsHead.load(std::memory_order_relaxed);
+	uint32_t tail = resultsTail.load(std::memory_order_acquire);
+	for (; head != tail; head++) {
+		RouteTilePrefetchResult* r = results[head % RESULTS_CAPACITY];
+		if (inFlight.erase(r->key) > 0) {
+			ready[r->key] = r;
+		} else {
+			discardResult(r);
+		}
+	}
+	resultsHead.store(head, std::memory_order_release);
+}
+
+void RouteTilePrefetcher::discardResult(RouteTilePrefetchResult* r) {
+	for (RouteDataObject* o : r->objects) {
+		if (o != NULL) {
+			delete o;
+		}
+	}
+	delete r;
+}
+
+bool RouteTilePrefetcher::submit(int64_t key, int fd, SHARED_PTR<RoutingIndex>& routingIndex,
+								 RouteSubregion& subregion) {
+	drainResults();
+	if (fd < 0 || isRequested(key)) {
+		return false;
+	}
+	if ((int)(inFlight.size() + ready.size()) >= maxTiles) {
+		if (ready.empty()) {
+			return false;
+		}
+		// prediction was not used yet, give place to fresher one
+		auto it = ready.begin();
+		discardResult(it->second);
+		ready.erase(it);
+	}
+	inFlight.insert(key);
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		requests.push_back(RouteTilePrefetchRequest(key, fd, routingIndex, subregion));
+	}
+	requestsCondition.notify_one();
+	return true;
+}
+
+RouteTilePrefetchResult* RouteTilePrefetcher::take(int64_t key, uint64_t& waitNanos) {
+	waitNanos = 0;
+	drainResults();
+	if (inFlight.find(key) != inFlight.end()) {
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(requestsMutex);
+			for (auto it = requests.begin(); it != requests.end(); it++) {
+				if (it->key == key) {
+					requests.erase(it);
+					queued = true;
+					break;
+				}
+			}
+		}
+		if (queued) {
+			// not started yet - it is cheaper to read it directly than to wait for the queue
+			inFlight.erase(key);
+			return NULL;
+		}
+		OsmAnd::ElapsedTimer timer;
+		timer.Start();
+		while (inFlight.find(key) != inFlight.end()) {
+			std::this_thread::yield();
+			drainResults();
+		}
+		timer.Pause();
+		waitNanos = timer.GetElapsedNanos();
+	}
+	const auto it = ready.find(key);
+	if (it == ready.end()) {
+		return NULL;
+	}
+	RouteTilePrefetchResult* r = it->second;
+	ready.erase(it);
+	return r;
+}
+
+void RouteTilePrefetcher::clear() {
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		for (auto& r : requests) {
+			inFlight.erase(r.key);
+		}
+		requests.clear();
+	}
+	drainResults();
+	for (auto& r : ready) {
+		discardResult(r.second);
+	}
+	ready.clear();
+}
+
+#endif /*_OSMAND_ROUTE_TILE_PREFETCHER_CPP*/
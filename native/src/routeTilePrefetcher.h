@@ -0,0 +1,81 @@
+#ifndef _OSMAND_ROUTE_TILE_PREFETCHER_H
+#define _OSMAND_ROUTE_TILE_PREFETCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "CommonCollections.h"
+#include "binaryRead.h"
+#include "commonOsmAndCore.h"
+
+struct RouteTilePrefetchRequest {
+	int64_t key;
+	int fd;
+	SHARED_PTR<RoutingIndex> routingIndex;
+	RouteSubregion subregion;
+
+	RouteTilePrefetchRequest(int64_t key, int fd, SHARED_PTR<RoutingIndex>& routingIndex, RouteSubregion& subregion)
+		: key(key), fd(fd), routingIndex(routingIndex), subregion(subregion) {}
+};
+
+struct RouteTilePrefetchResult {
+	int64_t key;
+	std::vector<RouteDataObject*> objects;
+	// time spent to decode tile on background thread
+	uint64_t decodeNanos;
+
+	RouteTilePrefetchResult(int64_t key) : key(key), decodeNanos(0) {}
+};
+
+// Decodes route tiles predicted by search on background thread.
+// Requests go to worker under mutex (worker sleeps when there is nothing to do),
+// decoded tiles come back through single producer / single consumer ring, so search thread never blocks on it.
+// All methods except worker loop must be called from search thread.
+class RouteTilePrefetcher {
+	static const int RESULTS_CAPACITY = 64;
+
+	// requests (shared with worker)
+	std::mutex requestsMutex;
+	std::condition_variable requestsCondition;
+	std::deque<RouteTilePrefetchRequest> requests;
+	bool stopped;
+
+	// results ring: written only by worker (tail), read only by search thread (head)
+	RouteTilePrefetchResult* results[RESULTS_CAPACITY];
+	std::atomic<uint32_t> resultsHead;
+	std::atomic<uint32_t> resultsTail;
+
+	// search thread only
+	int maxTiles;
+	UNORDERED(set)<int64_t> inFlight;
+	UNORDERED(map)<int64_t, RouteTilePrefetchResult*> ready;
+
+	std::thread worker;
+
+	void run();
+	void drainResults();
+	void discardResult(RouteTilePrefetchResult* r);
+
+   public:
+	RouteTilePrefetcher(int maxTiles);
+	~RouteTilePrefetcher();
+
+	int getMaxTiles() { return maxTiles; }
+
+	bool isRequested(int64_t key) { return inFlight.find(key) != inFlight.end() || ready.find(key) != ready.end(); }
+
+	bool submit(int64_t key, int fd, SHARED_PTR<RoutingIndex>& routingIndex, RouteSubregion& subregion);
+
+	// Returns decoded tile (ownership of objects goes to caller) or NULL if tile was not requested.
+	// If tile is being decoded right now waits for it, if it is still queued removes it from queue.
+	// waitNanos - time search thread was blocked waiting for the tile
+	RouteTilePrefetchResult* take(int64_t key, uint64_t& waitNanos);
+
+	// Drops queued requests and decoded tiles which were not taken
+	void clear();
+};
+
+#endif /*_OSMAND_ROUTE_TILE_PREFETCHER_H*/
@@ -7,7 +7,7 @@
 const uint32_t RouteTypeRule::conditionalValue(const tm& dateTime) {
 	if (!conditions.empty()) {
 		for (const auto& c : conditions) {
-			if (c.hours != nullptr && c.hours->isOpenedForTime(dateTime)) {
+			if (c.compiledHours != nullptr && c.compiledHours->isOpenedForTime(dateTime)) {
 				return c.ruleid;
 			}
 		}
@@ -59,6 +59,9 @@ void RouteTypeRule::analyze() {
 					cond.condition = trim(cond.condition.substr(0, cond.condition.length() - 1));
 				}
 				cond.hours = OpeningHoursParser::parseOpenedHours(cond.condition);
+				if (cond.hours != nullptr) {
+					cond.compiledHours = std::make_shared<OpeningHoursParser::CompiledOpeningHours>(cond.hours);
+				}
 				conditions.push_back(cond);
 			}
 		}
@@ -13,9 +13,11 @@ struct RouteDataBundle;
 struct RouteTypeCondition {
 	std::string condition;
 	std::shared_ptr<OpeningHoursParser::OpeningHours> hours;
+	// hours compiled for checks of many roads
+	std::shared_ptr<OpeningHoursParser::CompiledOpeningHours> compiledHours;
 	std::string value;
 	uint32_t ruleid;
-	RouteTypeCondition() : condition(""), hours(nullptr), value(""), ruleid(0) {
+	RouteTypeCondition() : condition(""), hours(nullptr), compiledHours(nullptr), value(""), ruleid(0) {
 	}
 };
 
@@ -97,6 +97,28 @@ struct RoutingConfiguration {
     // 1.7 Maximum visited segments
     int MAX_VISITED = -1;
 
+    // 1.8 Incremental reroute: search new route prefix only in corridor (m) around previous route (0 - disabled)
+    float rerouteCorridorRadius = 0;
+    // distance along previous route (ahead of current position) where new prefix is spliced to the old suffix
+    float rerouteSpliceDistance = 2000;
+
+    // 1.9 Number of route tiles decoded in background ahead of search frontier (0 - disabled)
+    int prefetchTiles = 0;
+
+    // 1.10 Route tiles closer than this distance (m) to search queue heads are not unloaded by GC if possible
+    float gcPinRadius = 1500;
+
+    // 1.11 Use landmark (ALT) lower bounds from sidecar files next to maps in A* heuristic
+    bool useLandmarks = false;
+
+    // 1.12 Threads to approximate long GPX tracks by chunks split at confidently matched points (0 - sequentially)
+    int gpxApproximationThreads = 0;
+    // approximate length (m) of GPX track chunk
+    float gpxApproximationChunkLength = 20000;
+
+    // 1.13 Threads to attach roads and infer turns of route result by chunks (0 - sequentially)
+    int prepareResultThreads = 0;
+
     RoutingConfiguration(float initDirection = NO_DIRECTION, int memLimit = DEFAULT_MEMORY_LIMIT) : router(new GeneralRouter()), memoryLimitation(memLimit), initialDirection(initDirection), zoomToLoad(16), heurCoefficient(1), planRoadDirection(0), routerName(""), recalculateDistance(20000.0f) {
     }
 
@@ -119,6 +141,14 @@ struct RoutingConfiguration {
         // don't use file limitations?
         memoryLimitation = (int)parseFloat(getAttribute(router, "nativeMemoryLimitInMB"), memoryLimitation);
         zoomToLoad = (int)parseFloat(getAttribute(router, "zoomToLoadTiles"), 16);
+        rerouteCorridorRadius = parseFloat(getAttribute(router, "rerouteCorridorRadius"), 0);
+        rerouteSpliceDistance = parseFloat(getAttribute(router, "rerouteSpliceDistance"), 2000);
+        prefetchTiles = (int)parseFloat(getAttribute(router, "nativePrefetchTiles"), 0);
+        gcPinRadius = parseFloat(getAttribute(router, "nativeGcPinRadius"), 1500);
+        useLandmarks = parseBool(getAttribute(router, "heuristicLandmarks"), false);
+        gpxApproximationThreads = (int)parseFloat(getAttribute(router, "nativeGpxApproximationThreads"), 0);
+        gpxApproximationChunkLength = parseFloat(getAttribute(router, "nativeGpxApproximationChunkLength"), 20000);
+        prepareResultThreads = (int)parseFloat(getAttribute(router, "nativePrepareResultThreads"), 0);
         //routerName = parseString(getAttribute(router, "name"), "default");
     }
 };
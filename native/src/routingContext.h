@@ -2,14 +2,19 @@
 #define _OSMAND_ROUTING_CONTEXT_H
 #include <algorithm>
 #include <ctime>
+#include <functional>
 
 #include "CommonCollections.h"
 #include "binaryRead.h"
 #include "commonOsmAndCore.h"
 #include "precalculatedRouteDirection.h"
 #include "routeCalculationProgress.h"
+#include "routeLandmarks.h"
 #include "routeSegment.h"
+#include "routeSegmentGrid.h"
 #include "routeSegmentResult.h"
+#include "routeTileCache.h"
+#include "routeTilePrefetcher.h"
 #include "routingConfiguration.h"
 
 #ifdef _IOS_BUILD
@@ -20,6 +25,8 @@
 
 enum class RouteCalculationMode { BASE, NORMAL, COMPLEX };
 
+typedef std::function<void(const SHARED_PTR<RouteSegment>& segment, bool reverseWaySearch)> RouteSegmentVisitor;
+
 struct RoutingSubregionTile {
 	RouteSubregion subregion;
 	// make it without get/set for fast access
@@ -29,6 +36,8 @@ struct RoutingSubregionTile {
 	// JAVA: UNORDERED(map)<int64_t, SHARED_PTR> routes;
 	UNORDERED(map)<int64_t, std::vector<SHARED_PTR<RouteSegment>>> routes;
 	UNORDERED(set)<int64_t> excludedIds;
+	// roads with conditional tags (kept only in conditional sweep mode)
+	std::vector<SHARED_PTR<RouteDataObject>> conditionalRoads;
 
 	RoutingSubregionTile(RouteSubregion& sub) : subregion(sub), access(0), loaded(0) {
 		size = sizeof(RoutingSubregionTile);
@@ -40,6 +49,7 @@ struct RoutingSubregionTile {
 
 	void unload() {
 		routes = UNORDERED(map)<int64_t, std::vector<SHARED_PTR<RouteSegment>>>();
+		conditionalRoads.clear();
 		size = 0;
 		loaded = -abs(loaded);
 	}
@@ -61,19 +71,71 @@ struct RoutingSubregionTile {
 
 static int64_t calcRouteId(SHARED_PTR<RouteDataObject>& o, int ind) { return ((int64_t)o->id << 10) + ind; }
 
-inline int intpow(int base, int pw) {
-	int r = 1;
-	for (int i = 0; i < pw; i++) {
-		r *= base;
+// GC clock: tile survives up to this number of sweeps after last access
+const static int TILE_CLOCK_MAX_WEIGHT = 3;
+
+// Corridor around part of previously calculated route used to bound incremental reroute search
+struct RerouteCorridor {
+	double radius;
+	std::vector<int> pointsX;
+	std::vector<int> pointsY;
+	quad_tree<int> quadTree;
+
+	RerouteCorridor(std::vector<SHARED_PTR<RouteSegmentResult>>& route, int fromSegment, int toSegment, int startX,
+					int startY, double radius)
+		: radius(radius), quadTree(SkIRect::MakeLTRB(0, 0, 0x7FFFFFFF, 0x7FFFFFFF), 14, 0.5) {
+		addPoint(startX, startY);
+		for (int k = fromSegment; k <= toSegment && k < (int)route.size(); k++) {
+			auto& s = route[k];
+			bool plus = s->getStartPointIndex() < s->getEndPointIndex();
+			int i = s->getStartPointIndex();
+			while (true) {
+				addPoint(s->object->pointsX[i], s->object->pointsY[i]);
+				if (i == s->getEndPointIndex()) {
+					break;
+				}
+				i = plus ? i + 1 : i - 1;
+			}
+		}
+	}
+
+	bool contains(int x31, int y31) {
+		int shift = (int)(radius / getTileWidth(y31)) + 1;
+		SkIRect rect = SkIRect::MakeLTRB(x31 - shift, y31 - shift, x31 + shift, y31 + shift);
+		std::vector<int> candidates;
+		quadTree.query_in_box(rect, candidates);
+		for (int ind : candidates) {
+			if (squareRootDist31(x31, y31, pointsX[ind], pointsY[ind]) <= radius) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+   private:
+	void addPoint(int x31, int y31) {
+		if (!pointsX.empty()) {
+			// densify geometry so that distance to the polyline is close to distance to nearest point
+			int px = pointsX.back();
+			int py = pointsY.back();
+			double dist = squareRootDist31(px, py, x31, y31);
+			int steps = (int)(dist / (radius / 2));
+			for (int k = 1; k <= steps; k++) {
+				double c = k / (steps + 1.0);
+				insertPoint(px + (int)((x31 - px) * c), py + (int)((y31 - py) * c));
+			}
+		}
+		insertPoint(x31, y31);
 	}
-	return r;
-}
 
-inline int compareRoutingSubregionTile(SHARED_PTR<RoutingSubregionTile>& o1, SHARED_PTR<RoutingSubregionTile>& o2) {
-	int v1 = (o1->access + 1) * intpow(10, o1->getUnloadCount() - 1);
-	int v2 = (o2->access + 1) * intpow(10, o2->getUnloadCount() - 1);
-	return v1 < v2;
-}
+	void insertPoint(int x31, int y31) {
+		int ind = (int)pointsX.size();
+		pointsX.push_back(x31);
+		pointsY.push_back(y31);
+		SkIRect rect = SkIRect::MakeLTRB(x31, y31, x31, y31);
+		quadTree.insert(ind, rect);
+	}
+};
 
 struct RoutingContext {
 	typedef UNORDERED(map)<int64_t, SHARED_PTR<RoutingSubregionTile>> MAP_SUBREGION_TILES;
@@ -106,9 +168,13 @@ struct RoutingContext {
 
 	time_t conditionalTime;
 	tm conditionalTimeStr;
+	// conditional tags of loaded roads are kept symbolic and re-applied on every setConditionalTime,
+	// so one context (tiles and router caches) serves many departure times
+	bool conditionalSweep = false;
 
 	vector<SHARED_PTR<RouteSegmentResult>> previouslyCalculatedRoute;
 	SHARED_PTR<PrecalculatedRouteDirection> precalcRoute;
+	SHARED_PTR<RerouteCorridor> rerouteCorridor;
 	SHARED_PTR<RouteSegment> finalRouteSegment;
 
 	vector<SHARED_PTR<RouteSegment>> segmentsToVisitNotForbidden;
@@ -117,6 +183,26 @@ struct RoutingContext {
 	MAP_SUBREGION_TILES subregionTiles;
 	UNORDERED(map)<int64_t, std::vector<SHARED_PTR<RoutingSubregionTile>>> indexedSubregions;
 	vector<BinaryMapFile *> mapIndexReaderFilter;
+	SHARED_PTR<RouteTilePrefetcher> prefetcher;
+	// decoded tiles shared with contexts working in other threads (null - map files are read directly)
+	SHARED_PTR<RouteTileCache> tileCache;
+
+	// roads around snapped points (findRouteSegments), cleared when tiles are unloaded
+	RouteSegmentGrid segmentGrid;
+
+	// sum of getSize() of all subregionTiles (kept incrementally to not iterate tiles on every GC check)
+	long tilesSize = 0;
+	// loaded tiles in order of loading, swept by GC clock hand
+	vector<SHARED_PTR<RoutingSubregionTile>> tilesClock;
+	uint tilesClockHand = 0;
+	// last known heads of search queues, tiles around them are not unloaded by GC
+	vector<int_pair> searchFrontier;
+
+	// ALT heuristic bounds of maps used by context (heuristicLandmarks profile attribute)
+	vector<SHARED_PTR<RouteLandmarks>> landmarks;
+	bool landmarksInitialized = false;
+	// called for every segment settled by search (used by offline tools)
+	RouteSegmentVisitor visitor;
 
 	int alertFasterRoadToVisitedSegments;
 	int alertSlowerSegmentedWasVisitedEarlier;
@@ -130,9 +216,11 @@ struct RoutingContext {
 		this->publicTransport = cp->publicTransport;
 		this->conditionalTime = cp->conditionalTime;
 		this->conditionalTimeStr = cp->conditionalTimeStr;
+		this->conditionalSweep = cp->conditionalSweep;
 		this->basemap = cp->basemap;
 		this->geocoding = cp->geocoding;
 		this->progress = cp->progress;
+		this->tileCache = cp->tileCache;
 		this->calculationProgressFirstPhase = std::make_shared<RouteCalculationProgress>();
 		this->alertFasterRoadToVisitedSegments = 0;
 		this->alertSlowerSegmentedWasVisitedEarlier = 0;
@@ -169,7 +257,15 @@ struct RoutingContext {
 				}
 			}
 		}
+		if (prefetcher) {
+			prefetcher->clear();
+		}
 		subregionTiles = MAP_SUBREGION_TILES();
+		tilesSize = 0;
+		tilesClock.clear();
+		tilesClockHand = 0;
+		searchFrontier.clear();
+		segmentGrid.clear();
 		indexedSubregions = UNORDERED(map)<int64_t, std::vector<SHARED_PTR<RoutingSubregionTile>>>();
 		mapIndexReaderFilter.clear();
 	}
@@ -198,13 +294,125 @@ struct RoutingContext {
         }
     }
 
+	// Prepares context to be reused for another query with the same configuration:
+	// per-query state is cleared while loaded tiles (and router caches in config) are kept
+	void resetSearchState() {
+		resetSegmentsState();
+		previouslyCalculatedRoute.clear();
+		precalcRoute = std::make_shared<PrecalculatedRouteDirection>();
+		intermediatesX.clear();
+		intermediatesY.clear();
+		progress = std::make_shared<RouteCalculationProgress>();
+		calculationProgressFirstPhase = std::make_shared<RouteCalculationProgress>();
+	}
+
+	// Clears state of the last search only: loaded tiles, previous route, intermediates and progress are kept
+	void resetSegmentsState() {
+		breakChain();
+		finalRouteSegment.reset();
+		segmentsToVisitNotForbidden.clear();
+		segmentsToVisitPrescripted.clear();
+		rerouteCorridor.reset();
+		searchFrontier.clear();
+		dijkstraMode = 0;
+		alertFasterRoadToVisitedSegments = 0;
+		alertSlowerSegmentedWasVisitedEarlier = 0;
+		// segments of loaded tiles keep A* state of previous search
+		for (auto& t : tilesClock) {
+			if (!t->isLoaded()) {
+				continue;
+			}
+			for (auto& r : t->routes) {
+				for (auto& segment : r.second) {
+					resetSegment(segment);
+					SHARED_PTR<RouteSegment> reverse = segment->reverseSearch.lock();
+					resetSegment(reverse);
+				}
+			}
+		}
+	}
+
+	static void resetSegment(SHARED_PTR<RouteSegment> segment) {
+		if (!segment) {
+			return;
+		}
+		clearSegmentState(segment);
+		clearSegmentState(segment->oppositeDirection.lock());
+	}
+
+	static void clearSegmentState(SHARED_PTR<RouteSegment> segment) {
+		if (segment) {
+			segment->parentRoute.reset();
+			segment->opposite.reset();
+			segment->distanceFromStart = 0;
+			segment->distanceToEnd = 0;
+			segment->isFinalSegment = false;
+			segment->reverseWaySearch = 0;
+		}
+	}
+
 	bool isInterrupted() { return progress != nullptr ? progress->isCancelled() : false; }
 
+	void initLandmarks() {
+		if (landmarksInitialized || !config->useLandmarks) {
+			return;
+		}
+		landmarksInitialized = true;
+		vector<BinaryMapFile*> files = mapIndexReaderFilter.empty() ? getOpenMapFiles() : mapIndexReaderFilter;
+		for (BinaryMapFile* file : files) {
+			SHARED_PTR<RouteLandmarks> lm =
+				getRouteLandmarks(getRouteLandmarksFileName(file->inputName, config->routerName));
+			if (lm && lm->routerName == config->routerName) {
+				landmarks.push_back(lm);
+			}
+		}
+	}
+
+	double landmarksLowerBound(int fromX, int fromY, int toX, int toY) {
+		double res = 0;
+		for (auto& lm : landmarks) {
+			res = std::max(res, lm->lowerBound(fromX, fromY, toX, toY));
+		}
+		return res;
+	}
+
+	bool isOutsideRerouteCorridor(int x31, int y31) {
+		return rerouteCorridor && !rerouteCorridor->contains(x31, y31);
+	}
+
 	void setConditionalTime(time_t tm) {
 		conditionalTime = tm;
 		if (conditionalTime != 0) {
 			conditionalTimeStr = *localtime(&conditionalTime);
 		}
+		if (conditionalSweep) {
+			// grid keeps roads accepted for previous time
+			segmentGrid.clear();
+			for (auto& t : tilesClock) {
+				if (!t->isLoaded()) {
+					continue;
+				}
+				for (auto& o : t->conditionalRoads) {
+					applyConditionalTags(o);
+				}
+			}
+		}
+	}
+
+	// Tiles loaded in other mode are unloaded, as their roads have conditional tags baked in
+	void setConditionalSweep(bool sweep) {
+		if (conditionalSweep != sweep) {
+			conditionalSweep = sweep;
+			unloadAllData();
+		}
+	}
+
+	void applyConditionalTags(SHARED_PTR<RouteDataObject>& o) {
+		o->restoreUnconditionalTypes();
+		if (conditionalTime != 0) {
+			o->processConditionalTags(conditionalTimeStr);
+		}
+		o->conditionallyRejected = !acceptLine(o);
 	}
 
 	int searchSubregionTile(RouteSubregion& subregion) {
@@ -234,14 +442,44 @@ struct RoutingContext {
 
 	long getSize() {
 		// multiply 2 for to maps
-		long sz = subregionTiles.size() * sizeof(pair<int64_t, SHARED_PTR<RoutingSubregionTile>>) * 2;
-		MAP_SUBREGION_TILES::iterator it = subregionTiles.begin();
-		for (; it != subregionTiles.end(); it++) {
-			sz += it->second->getSize();
+		return subregionTiles.size() * sizeof(pair<int64_t, SHARED_PTR<RoutingSubregionTile>>) * 2 + tilesSize;
+	}
+
+	void updateSearchFrontier(SHARED_PTR<RouteSegment> direct, SHARED_PTR<RouteSegment> reverse) {
+		searchFrontier.clear();
+		if (direct && direct->road) {
+			searchFrontier.push_back(int_pair(direct->road->pointsX[direct->getSegmentStart()],
+											  direct->road->pointsY[direct->getSegmentStart()]));
+		}
+		if (reverse && reverse->road) {
+			searchFrontier.push_back(int_pair(reverse->road->pointsX[reverse->getSegmentStart()],
+											  reverse->road->pointsY[reverse->getSegmentStart()]));
+		}
+	}
+
+	bool isPinnedTile(SHARED_PTR<RoutingSubregionTile>& tile) {
+		RouteSubregion& sub = tile->subregion;
+		for (auto& p : searchFrontier) {
+			int shift = (int)(config->gcPinRadius / getTileWidth(p.second));
+			if ((int64_t)p.first >= (int64_t)sub.left - shift && (int64_t)p.first <= (int64_t)sub.right + shift &&
+				(int64_t)p.second >= (int64_t)sub.top - shift && (int64_t)p.second <= (int64_t)sub.bottom + shift) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void unloadTile(SHARED_PTR<RoutingSubregionTile>& tile) {
+		long before = tile->getSize();
+		tile->unload();
+		tilesSize += tile->getSize() - before;
+		if (progress) {
+			progress->unloadedTiles++;
 		}
-		return sz;
 	}
 
+	// Generalized CLOCK: hand sweeps loaded tiles, accessed tiles lose weight and get another chance,
+	// tiles without weight are unloaded. Tiles around search queue heads are skipped while possible.
 	void unloadUnusedTiles(long memoryLimit) {
 		long sz = getSize();
 		float critical = 0.9f * memoryLimit * 1024 * 1024;
@@ -250,33 +488,53 @@ struct RoutingContext {
 		}
 		float occupiedBefore = sz / (1024. * 1024.);
 		float desirableSize = memoryLimit * 0.7f * 1024 * 1024;
-		vector<SHARED_PTR<RoutingSubregionTile>> list;
-		MAP_SUBREGION_TILES::iterator it = subregionTiles.begin();
-		int loaded = 0;
+		int loaded = (int)tilesClock.size();
 		int unloadedTiles = 0;
-		for (; it != subregionTiles.end(); it++) {
-			if (it->second->isLoaded()) {
-				list.push_back(it->second);
-				loaded++;
-			}
-		}
-		sort(list.begin(), list.end(), compareRoutingSubregionTile);
-		uint i = 0;
-		while (sz >= desirableSize && i < list.size()) {
-			SHARED_PTR<RoutingSubregionTile> unload = list[i];
-			i++;
-			sz -= unload->getSize();
-			unload->unload();
-			unloadedTiles++;
-			if (progress) {
-				progress->unloadedTiles++;
+		int pinnedTiles = 0;
+		bool ignorePins = false;
+		uint steps = 0;
+		uint maxSteps = (TILE_CLOCK_MAX_WEIGHT + 1) * tilesClock.size();
+		while (getSize() >= desirableSize && !tilesClock.empty()) {
+			if (steps++ >= maxSteps) {
+				if (ignorePins || getSize() < critical) {
+					break;
+				}
+				// frontier keeps too much memory, unload it as well
+				ignorePins = true;
+				steps = 0;
+			}
+			if (tilesClockHand >= tilesClock.size()) {
+				tilesClockHand = 0;
+			}
+			SHARED_PTR<RoutingSubregionTile>& tile = tilesClock[tilesClockHand];
+			if (!tile->isLoaded()) {
+				tilesClock.erase(tilesClock.begin() + tilesClockHand);
+				continue;
+			}
+			if (!ignorePins && isPinnedTile(tile)) {
+				pinnedTiles++;
+				tilesClockHand++;
+				continue;
+			}
+			if (tile->access > 0) {
+				tile->access = std::min(tile->access, TILE_CLOCK_MAX_WEIGHT) - 1;
+				tilesClockHand++;
+				continue;
 			}
+			unloadTile(tile);
+			unloadedTiles++;
+			tilesClock.erase(tilesClock.begin() + tilesClockHand);
+		}
+		if (unloadedTiles > 0) {
+			segmentGrid.clear();
 		}
-		for (i = 0; i < list.size(); i++) {
-			list[i]->access /= 3;
+		if (progress) {
+			progress->gcRuns++;
+			progress->gcPinnedTiles += pinnedTiles;
 		}
-		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Run GC (before %f Mb after %f Mb) unload %d of %d tiles",
-						  occupiedBefore, getSize() / (1024.0 * 1024.0), unloadedTiles, loaded);
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
+						  "Run GC (before %f Mb after %f Mb) unload %d of %d tiles (pinned skipped %d)", occupiedBefore,
+						  getSize() / (1024.0 * 1024.0), unloadedTiles, loaded, pinnedTiles);
 	}
 
 	void loadHeaderObjects(int64_t tileId) {
@@ -335,26 +593,51 @@ struct RoutingContext {
 						} else {
 							progress->distinctLoadedTiles++;
 						}
+						if (subregions[j]->getUnloadCount() > 0) {
+							progress->thrashedTiles++;
+						}
 						progress->loadedTiles++;
 					}
+					long sizeBefore = subregions[j]->getSize();
+					// tile which was already unloaded is likely to be needed again, give it more chances in GC
+					subregions[j]->access = subregions[j]->getUnloadCount();
 					subregions[j]->setLoaded();
-					SearchQuery q;
 					vector<RouteDataObject*> res;
-					searchRouteDataForSubRegion(&q, res, &subregions[j]->subregion, geocoding);
+					if (tileCache) {
+						tileCache->readTile(subregions[j]->subregion, geocoding, res);
+					} else if (!takePrefetchedTile(subregions[j]->subregion, res)) {
+						SearchQuery q;
+						searchRouteDataForSubRegion(&q, res, &subregions[j]->subregion, geocoding);
+					}
 					vector<RouteDataObject*>::iterator i = res.begin();
 					for (; i != res.end(); i++) {
 						if (*i != NULL) {
 							SHARED_PTR<RouteDataObject> o;
 							o.reset(*i);
-							if (conditionalTime != 0) {
+							// in sweep mode road stays in tile even if it isn't accepted for current time
+							bool sweepRoad = conditionalSweep && o->hasConditionalTags();
+							bool connect = !points.empty() && !config->router->checkAllowPrivateNeeded &&
+										   excludedIds.find(o->getId()) == excludedIds.end();
+							if (sweepRoad) {
+								// road could be accepted for later departure, so points are connected whether
+								// it is accepted now (before types are kept to restore them for every time)
+								if (connect) {
+									connectPoint(subregions[j], o, points);
+								}
+								o->keepUnconditionalTypes();
+								applyConditionalTags(o);
+							} else if (conditionalTime != 0) {
 								o->processConditionalTags(conditionalTimeStr);
 							}
-							if (acceptLine(o)) {
+							if (sweepRoad || acceptLine(o)) {
 								if (excludedIds.find(o->getId()) == excludedIds.end()) {
-									if (!points.empty() && !config->router->checkAllowPrivateNeeded) {
+									if (connect && !sweepRoad) {
 										connectPoint(subregions[j], o, points);
 									}
 									subregions[j]->add(o);
+									if (sweepRoad) {
+										subregions[j]->conditionalRoads.push_back(o);
+									}
 								}
 							}
 							if (o->getId() > 0) {
@@ -363,6 +646,8 @@ struct RoutingContext {
 							}
 						}
 					}
+					tilesSize += subregions[j]->getSize() - sizeBefore;
+					tilesClock.push_back(subregions[j]);
 				} else {
 					excludedIds.insert(subregions[j]->excludedIds.begin(), subregions[j]->excludedIds.end());
 				}
@@ -370,10 +655,116 @@ struct RoutingContext {
 		}
 	}
 
-	void loadHeaders(uint32_t xloc, uint32_t yloc) {
-		if (progress && progress.get()) {
+	// map files are shared with other threads only if tile cache is shared
+	std::unique_lock<std::mutex> lockTileCache() {
+		return tileCache ? tileCache->lock() : std::unique_lock<std::mutex>();
+	}
+
+	static int64_t subregionTileKey(RouteSubregion& rs) { return ((int64_t)rs.left << 31) + rs.filePointer; }
+
+	bool takePrefetchedTile(RouteSubregion& subregion, vector<RouteDataObject*>& res) {
+		if (!prefetcher) {
+			return false;
+		}
+		uint64_t waitNanos = 0;
+		RouteTilePrefetchResult* r = prefetcher->take(subregionTileKey(subregion), waitNanos);
+		if (r == NULL) {
+			return false;
+		}
+		res.swap(r->objects);
+		if (progress) {
+			progress->prefetchedTiles++;
+			if (r->decodeNanos > waitNanos) {
+				progress->timeToLoadHiddenNanos += r->decodeNanos - waitNanos;
+			}
+		}
+		delete r;
+		return true;
+	}
+
+	// Predicts tiles the search frontier enters next (toward the heuristic target and along the road
+	// being expanded) and requests them to be decoded in background, so loadHeaderObjects finds them ready
+	void prefetchTiles(SHARED_PTR<RouteSegment>& segment, bool reverseWaySearch) {
+		if (config->prefetchTiles <= 0 || geocoding || !segment || !segment->road) {
+			return;
+		}
+		if (!prefetcher) {
+			prefetcher = std::make_shared<RouteTilePrefetcher>(config->prefetchTiles);
+		}
+		SHARED_PTR<RouteDataObject>& road = segment->road;
+		int x = road->pointsX[segment->getSegmentEnd()];
+		int y = road->pointsY[segment->getSegmentEnd()];
+		double dx = (reverseWaySearch ? startX : targetX) - (double)x;
+		double dy = (reverseWaySearch ? startY : targetY) - (double)y;
+		double len = sqrt(dx * dx + dy * dy);
+		int z = config->zoomToLoad;
+		int tileSize = 1 << (31 - z);
+		if (len < tileSize) {
+			return;
+		}
+		dx /= len;
+		dy /= len;
+		double rx = x - (double)road->pointsX[segment->getSegmentStart()];
+		double ry = y - (double)road->pointsY[segment->getSegmentStart()];
+		double rlen = sqrt(rx * rx + ry * ry);
+		if (rlen > 0) {
+			dx = (dx + rx / rlen) / 2;
+			dy = (dy + ry / rlen) / 2;
+			len = sqrt(dx * dx + dy * dy);
+			if (len == 0) {
+				return;
+			}
+			dx /= len;
+			dy /= len;
+		}
+		for (int k = 1; k <= 2; k++) {
+			for (int side = -1; side <= 1; side++) {
+				double px = x + (dx * k - dy * side) * tileSize;
+				double py = y + (dy * k + dx * side) * tileSize;
+				if (px < 0 || py < 0 || px > 0x7FFFFFFF || py > 0x7FFFFFFF) {
+					continue;
+				}
+				if (!requestPrefetchTile(((uint32_t)px) >> (31 - z), ((uint32_t)py) >> (31 - z))) {
+					return;
+				}
+			}
+		}
+	}
+
+	// returns false if prefetcher has no more place for requests
+	bool requestPrefetchTile(uint32_t xloc, uint32_t yloc) {
+		int z = config->zoomToLoad;
+		int64_t tileId = (xloc << z) + yloc;
+		if (progress) {
 			progress->timeToLoadHeaders.Start();
 		}
+		loadSubregionHeaders(xloc, yloc);
+		if (progress) {
+			progress->timeToLoadHeaders.Pause();
+		}
+		auto& subregions = indexedSubregions[tileId];
+		for (uint j = 0; j < subregions.size(); j++) {
+			RouteSubregion& subregion = subregions[j]->subregion;
+			int64_t key = subregionTileKey(subregion);
+			if (subregions[j]->isLoaded() || prefetcher->isRequested(key)) {
+				continue;
+			}
+			SHARED_PTR<RoutingIndex> routingIndex;
+			BinaryMapFile* file = findRouteSubRegionFile(&subregion, routingIndex);
+			if (file == NULL) {
+				continue;
+			}
+			if (!prefetcher->submit(key, file->getPrefetchFD(), routingIndex, subregion)) {
+				return false;
+			}
+			if (progress) {
+				progress->prefetchRequestedTiles++;
+			}
+		}
+		return true;
+	}
+
+	void loadSubregionHeaders(uint32_t xloc, uint32_t yloc) {
 		int z = config->zoomToLoad;
 		int tz = 31 - z;
 		int64_t tileId = (xloc << z) + yloc;
@@ -381,18 +772,31 @@ struct RoutingContext {
 			SearchQuery q((uint32_t)(xloc << tz), (uint32_t)((xloc + 1) << tz), (uint32_t)(yloc << tz),
 						  (uint32_t)((yloc + 1) << tz));
 			std::vector<RouteSubregion> tempResult;
-			searchRouteSubregions(&q, tempResult, basemap, geocoding, mapIndexReaderFilter);
+			{
+				std::unique_lock<std::mutex> lock = lockTileCache();
+				searchRouteSubregions(&q, tempResult, basemap, geocoding, mapIndexReaderFilter);
+			}
 			std::vector<SHARED_PTR<RoutingSubregionTile>> collection;
 			for (uint i = 0; i < tempResult.size(); i++) {
 				RouteSubregion& rs = tempResult[i];
-				int64_t key = ((int64_t)rs.left << 31) + rs.filePointer;
+				int64_t key = subregionTileKey(rs);
 				if (subregionTiles.find(key) == subregionTiles.end()) {
 					subregionTiles[key] = std::make_shared<RoutingSubregionTile>(rs);
+					tilesSize += subregionTiles[key]->getSize();
 				}
 				collection.push_back(subregionTiles[key]);
 			}
 			indexedSubregions[tileId] = collection;
 		}
+	}
+
+	void loadHeaders(uint32_t xloc, uint32_t yloc) {
+		if (progress && progress.get()) {
+			progress->timeToLoadHeaders.Start();
+		}
+		int z = config->zoomToLoad;
+		int64_t tileId = (xloc << z) + yloc;
+		loadSubregionHeaders(xloc, yloc);
 		if (progress && progress.get()) {
 			progress->timeToLoadHeaders.Pause();
 		}
@@ -436,7 +840,8 @@ struct RoutingContext {
 							auto segments = s->second;
 							for (auto& segment : segments) {
 								SHARED_PTR<RouteDataObject> ro = segment->road;
-								if (!isExcluded(ro->id, j, subregions) && excludeDuplications.insert(ro->id).second) {
+								if (!ro->conditionallyRejected && !isExcluded(ro->id, j, subregions) &&
+									excludeDuplications.insert(ro->id).second) {
 									dataObjects.push_back(ro);
 								}
 							}
@@ -475,13 +880,18 @@ struct RoutingContext {
 		SHARED_PTR<RouteSegment> original;
 		for (uint j = 0; j < subregions.size(); j++) {
 			if (subregions[j]->isLoaded()) {
-				std::vector<SHARED_PTR<RouteSegment>> segments = subregions[j]->routes[l];
+				std::vector<SHARED_PTR<RouteSegment>> segments;
+				const auto itRoutes = subregions[j]->routes.find(l);
+				if (itRoutes != subregions[j]->routes.end()) {
+					segments = itRoutes->second;
+				}
 				subregions[j]->access++;
 				for (auto& segment : segments) {
 					SHARED_PTR<RouteDataObject> ro = segment->road;
 					SHARED_PTR<RouteDataObject> toCmp =
 						excludeDuplications[calcRouteId(ro, segment->getSegmentStart())];
-					if (!isExcluded(ro->id, j, subregions) && (!toCmp || toCmp->pointsX.size() < ro->pointsX.size())) {
+					if (!ro->conditionallyRejected && !isExcluded(ro->id, j, subregions) &&
+						(!toCmp || toCmp->pointsX.size() < ro->pointsX.size())) {
 						excludeDuplications[calcRouteId(ro, segment->getSegmentStart())] = ro;
 						if (reverseWaySearch) {
 							if (segment->reverseSearch.expired()) {
@@ -0,0 +1,105 @@
+#ifndef _OSMAND_ROUTING_CONTEXT_POOL_CPP
+#define _OSMAND_ROUTING_CONTEXT_POOL_CPP
+
+#include "routingContextPool.h"
+
+#include "Logging.h"
+#include "routingContext.h"
+
+RoutingContextPool::~RoutingContextPool() {
+	clear();
+}
+
+RoutingContextPool& RoutingContextPool::getInstance() {
+	static RoutingContextPool instance;
+	return instance;
+}
+
+void RoutingContextPool::setMaxSize(int size) {
+	std::vector<RoutingContext*> toDelete;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		maxSize = std::max(size, 0);
+		while ((int)idle.size() > maxSize) {
+			toDelete.push_back(idle.front().second);
+			idle.erase(idle.begin());
+		}
+	}
+	for (RoutingContext* c : toDelete) {
+		delete c;
+	}
+}
+
+bool RoutingContextPool::isEnabled() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return maxSize > 0;
+}
+
+RoutingContext* RoutingContextPool::acquire(const std::string& key) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (int i = (int)idle.size() - 1; i >= 0; i--) {
+		if (idle[i].first == key) {
+			RoutingContext* c = idle[i].second;
+			idle.erase(idle.begin() + i);
+			busy[c] = key;
+			return c;
+		}
+	}
+	return NULL;
+}
+
+void RoutingContextPool::attach(RoutingContext* ctx, const std::string& key) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (maxSize > 0) {
+		busy[ctx] = key;
+	}
+}
+
+bool RoutingContextPool::release(RoutingContext* ctx) {
+	std::string key;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto it = busy.find(ctx);
+		if (it == busy.end()) {
+			return false;
+		}
+		key = it->second;
+		busy.erase(it);
+		if (maxSize <= 0) {
+			return false;
+		}
+	}
+	// context is not visible to other threads here
+	ctx->resetSearchState();
+	RoutingContext* toDelete = NULL;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		idle.push_back(std::make_pair(key, ctx));
+		if ((int)idle.size() > maxSize) {
+			toDelete = idle.front().second;
+			idle.erase(idle.begin());
+		}
+	}
+	if (toDelete != NULL) {
+		delete toDelete;
+	}
+	return true;
+}
+
+void RoutingContextPool::clear() {
+	std::vector<std::pair<std::string, RoutingContext*>> toDelete;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		toDelete.swap(idle);
+		busy.clear();
+	}
+	for (auto& p : toDelete) {
+		delete p.second;
+	}
+	if (!toDelete.empty()) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Routing context pool cleared (%d contexts)",
+						  (int)toDelete.size());
+	}
+}
+
+#endif /*_OSMAND_ROUTING_CONTEXT_POOL_CPP*/
@@ -0,0 +1,44 @@
+#ifndef _OSMAND_ROUTING_CONTEXT_POOL_H
+#define _OSMAND_ROUTING_CONTEXT_POOL_H
+
+#include <mutex>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct RoutingContext;
+
+// Keeps routing contexts between queries (for request-per-thread servers) so that router evaluation caches
+// and loaded tiles are reused. Contexts are keyed by profile and all parameters which affect routing.
+// Pool is disabled while max size is 0.
+class RoutingContextPool {
+	std::mutex mutex;
+	int maxSize;
+	// idle contexts, most recently released are at the end
+	std::vector<std::pair<std::string, RoutingContext*>> idle;
+	UNORDERED(map)<RoutingContext*, std::string> busy;
+
+   public:
+	RoutingContextPool() : maxSize(0) {}
+	~RoutingContextPool();
+
+	static RoutingContextPool& getInstance();
+
+	void setMaxSize(int size);
+
+	bool isEnabled();
+
+	// Returns idle context with the same key or NULL
+	RoutingContext* acquire(const std::string& key);
+
+	// Registers new context created for the key, it will be returned to pool on release
+	void attach(RoutingContext* ctx, const std::string& key);
+
+	// Returns true if context was taken back by pool, otherwise caller should delete it
+	bool release(RoutingContext* ctx);
+
+	// Drops all idle contexts (for example when map files were changed), busy contexts are deleted on release
+	void clear();
+};
+
+#endif /*_OSMAND_ROUTING_CONTEXT_POOL_H*/
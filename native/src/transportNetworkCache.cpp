@@ -0,0 +1,136 @@
+#ifndef _OSMAND_TRANSPORT_NETWORK_CACHE_CPP
+#define _OSMAND_TRANSPORT_NETWORK_CACHE_CPP
+
+#include "transportNetworkCache.h"
+
+#include "Logging.h"
+#include "binaryRead.h"
+#include "transportRouteStopsReader.h"
+#include "transportRoutingContext.h"
+#include "transportRoutingObjects.h"
+
+TransportNetworkCache& TransportNetworkCache::getInstance() {
+	static TransportNetworkCache instance;
+	return instance;
+}
+
+void TransportNetworkCache::setMaxTiles(int size) {
+	std::lock_guard<std::mutex> lock(mutex);
+	maxTiles = std::max(size, 0);
+	if ((int)tiles.size() > maxTiles) {
+		tiles.clear();
+		reader.reset();
+	}
+}
+
+bool TransportNetworkCache::isEnabled() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return maxTiles > 0;
+}
+
+TransportNetworkCache::~TransportNetworkCache() {
+	stopPreload();
+}
+
+void TransportNetworkCache::startPreload(int zoom, int left31, int top31, int right31, int bottom31) {
+	std::lock_guard<std::mutex> lock(preloadMutex);
+	preloadCancelled = true;
+	if (preloadThread.joinable()) {
+		preloadThread.join();
+	}
+	preloadCancelled = false;
+	preloadThread = std::thread(&TransportNetworkCache::preload, this, zoom, left31, top31, right31, bottom31);
+}
+
+void TransportNetworkCache::stopPreload() {
+	std::lock_guard<std::mutex> lock(preloadMutex);
+	preloadCancelled = true;
+	if (preloadThread.joinable()) {
+		preloadThread.join();
+	}
+}
+
+void TransportNetworkCache::clear() {
+	stopPreload();
+	std::lock_guard<std::mutex> lock(mutex);
+	tiles.clear();
+	reader.reset();
+	filesKey = "";
+}
+
+void TransportNetworkCache::checkFiles() {
+	vector<BinaryMapFile*> files = getOpenMapFiles();
+	std::string key;
+	for (BinaryMapFile* f : files) {
+		if (f->transportIndexes.size() > 0) {
+			key += f->inputName + ";";
+		}
+	}
+	if (key != filesKey || reader == nullptr) {
+		if (!tiles.empty()) {
+			OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
+							  "Transport network cache cleared (%d tiles, read %d, shared %d)", (int)tiles.size(),
+							  misses, hits);
+		}
+		tiles.clear();
+		filesKey = key;
+		reader = std::make_shared<TransportRouteStopsReader>(files);
+	}
+}
+
+std::vector<SHARED_PTR<TransportStop>>& TransportNetworkCache::readTile(int zoom, uint32_t x, uint32_t y) {
+	int64_t tileId = ((int64_t)zoom << 58) + (((int64_t)x) << (zoom + 1)) + y;
+	auto it = tiles.find(tileId);
+	if (it != tiles.end()) {
+		hits++;
+		return it->second;
+	}
+	if ((int)tiles.size() >= maxTiles) {
+		// routes are shared by tiles, so they are dropped with all tiles
+		vector<BinaryMapFile*> files = getOpenMapFiles();
+		tiles.clear();
+		reader = std::make_shared<TransportRouteStopsReader>(files);
+	}
+	misses++;
+	TransportReadScope transportRead;
+	int pz = (31 - zoom);
+	vector<SHARED_PTR<TransportStop>> stops;
+	SearchQuery q;
+	TransportRoutingContext::buildSearchTransportRequest(&q, (x << pz), ((x + 1) << pz), (y << pz), ((y + 1) << pz),
+														 -1, stops);
+	stops = reader->readMergedTransportStops(&q);
+	for (SHARED_PTR<TransportStop>& s : stops) {
+		for (SHARED_PTR<TransportRoute>& r : s->routes) {
+			r->mergeForwardWays();
+		}
+	}
+	return tiles[tileId] = stops;
+}
+
+std::vector<SHARED_PTR<TransportStop>> TransportNetworkCache::getTileStops(int zoom, uint32_t x, uint32_t y) {
+	std::lock_guard<std::mutex> lock(mutex);
+	checkFiles();
+	return readTile(zoom, x, y);
+}
+
+void TransportNetworkCache::preload(int zoom, int left31, int top31, int right31, int bottom31) {
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+	int tilesCount = 0;
+	for (uint32_t x = left31 >> (31 - zoom); x <= (uint32_t)right31 >> (31 - zoom); x++) {
+		for (uint32_t y = top31 >> (31 - zoom); y <= (uint32_t)bottom31 >> (31 - zoom); y++) {
+			// lock is released between tiles, so routing is not blocked by preloading
+			std::lock_guard<std::mutex> lock(mutex);
+			if (preloadCancelled || maxTiles <= 0 || tilesCount >= maxTiles) {
+				return;
+			}
+			checkFiles();
+			readTile(zoom, x, y);
+			tilesCount++;
+		}
+	}
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Transport network preloaded %d tiles in %.2f s", tilesCount,
+					  (double)timer.GetElapsedMs() / 1000.0);
+}
+
+#endif /*_OSMAND_TRANSPORT_NETWORK_CACHE_CPP*/
@@ -0,0 +1,61 @@
+#ifndef _OSMAND_TRANSPORT_NETWORK_CACHE_H
+#define _OSMAND_TRANSPORT_NETWORK_CACHE_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct TransportStop;
+struct TransportRouteStopsReader;
+
+// Transport stops with assembled (combined) routes by tiles, shared by all transport routing contexts
+// so files are read and incomplete routes are merged once per process. Cached objects are not changed
+// after they are put to cache (ways of routes are merged in advance). Cache is dropped when set of open
+// files is changed and when it has more than max tiles. Cache is disabled while max tiles is 0.
+// Files are read with separate descriptor (BinaryMapFile::getTransportFD), reads are serialized by mutex.
+class TransportNetworkCache {
+	std::mutex mutex;
+	// background preload, it's stopped (joined) before files are opened or closed
+	std::mutex preloadMutex;
+	std::thread preloadThread;
+	std::atomic<bool> preloadCancelled;
+	int maxTiles;
+	std::string filesKey;
+	SHARED_PTR<TransportRouteStopsReader> reader;
+	UNORDERED(map)<int64_t, std::vector<SHARED_PTR<TransportStop>>> tiles;
+	int hits;
+	int misses;
+
+	void checkFiles();
+	std::vector<SHARED_PTR<TransportStop>>& readTile(int zoom, uint32_t x, uint32_t y);
+
+   public:
+	TransportNetworkCache() : preloadCancelled(false), maxTiles(0), hits(0), misses(0) {}
+
+	~TransportNetworkCache();
+
+	static TransportNetworkCache& getInstance();
+
+	void setMaxTiles(int size);
+
+	bool isEnabled();
+
+	std::vector<SHARED_PTR<TransportStop>> getTileStops(int zoom, uint32_t x, uint32_t y);
+
+	// Reads all tiles of area (31 coordinates) in advance, stops when preload is cancelled
+	void preload(int zoom, int left31, int top31, int right31, int bottom31);
+
+	// Runs preload in background thread (previous preload is stopped)
+	void startPreload(int zoom, int left31, int top31, int right31, int bottom31);
+
+	// Cancels background preload and waits until it's finished
+	void stopPreload();
+
+	// Stops preload and drops all tiles
+	void clear();
+};
+
+#endif /*_OSMAND_TRANSPORT_NETWORK_CACHE_H*/
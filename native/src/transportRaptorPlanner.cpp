@@ -0,0 +1,374 @@
+#ifndef _OSMAND_TRANSPORT_RAPTOR_PLANNER_CPP
+#define _OSMAND_TRANSPORT_RAPTOR_PLANNER_CPP
+#include "transportRaptorPlanner.h"
+
+#include "Logging.h"
+#include "routeCalculationProgress.h"
+#include "transportRouteResult.h"
+#include "transportRouteResultSegment.h"
+#include "transportRouteSegment.h"
+#include "transportRoutingConfiguration.h"
+#include "transportRoutingContext.h"
+#include "transportRoutingObjects.h"
+
+int32_t TransportRaptorPlanner::getStopIndex(SHARED_PTR<TransportStop>& stop) {
+	auto it = stopIndexes.find(stop->id);
+	if (it != stopIndexes.end()) {
+		return it->second;
+	}
+	int32_t ind = (int32_t)stops.size();
+	stopIndexes[stop->id] = ind;
+	stops.push_back(stop);
+	return ind;
+}
+
+void TransportRaptorPlanner::addRoute(unique_ptr<TransportRoutingContext>& ctx, SHARED_PTR<TransportRoute>& route,
+									  vector<vector<pair<int32_t, int32_t>>>& routesByStop) {
+	const float routeTravelSpeed = ctx->cfg->getSpeedByRouteType(route->type);
+	if (routeTravelSpeed == 0 || route->forwardStops.size() < 2) {
+		return;
+	}
+	TransportSchedule& schedule = route->schedule;
+	if (ctx->cfg->useSchedule && schedule.tripIntervals.empty()) {
+		return;
+	}
+	int32_t r = (int32_t)routes.size();
+	routes.push_back(route);
+	double time = 0;
+	double dist = 0;
+	SHARED_PTR<TransportStop> prevStop;
+	for (int32_t pos = 0; pos < route->forwardStops.size(); pos++) {
+		SHARED_PTR<TransportStop>& stop = route->forwardStops[pos];
+		if (prevStop) {
+			double segmentDist = getDistance(prevStop->lat, prevStop->lon, stop->lat, stop->lon);
+			dist += segmentDist;
+			if (ctx->cfg->useSchedule && pos - 1 < schedule.avgStopIntervals.size()) {
+				time += schedule.avgStopIntervals[pos - 1] * 10;
+			} else {
+				time += ctx->cfg->stopTime + segmentDist / routeTravelSpeed;
+			}
+		}
+		int32_t s = getStopIndex(stop);
+		if (s >= routesByStop.size()) {
+			routesByStop.resize(s + 1);
+		}
+		routesByStop[s].push_back(std::make_pair(r, pos));
+		routeStops.push_back(s);
+		routeStopTimes.push_back(time);
+		routeStopDists.push_back(dist);
+		prevStop = stop;
+	}
+	routeStopsStart.push_back((int32_t)routeStops.size());
+	if (ctx->cfg->useSchedule) {
+		int32_t t = 0;
+		for (int32_t interval : schedule.tripIntervals) {
+			t += interval;
+			tripDepartures.push_back(t);
+		}
+		std::sort(tripDepartures.begin() + routeTripsStart[r], tripDepartures.end());
+	}
+	routeTripsStart.push_back((int32_t)tripDepartures.size());
+}
+
+void TransportRaptorPlanner::buildTransfers(unique_ptr<TransportRoutingContext>& ctx) {
+	int32_t cell = std::max(ctx->walkChangeRadiusIn31, 1);
+	UNORDERED(map)<int64_t, vector<int32_t>> grid;
+	for (int32_t s = 0; s < stops.size(); s++) {
+		int64_t cx = stops[s]->x31 / cell;
+		int64_t cy = stops[s]->y31 / cell;
+		grid[(cx << 31) + cy].push_back(s);
+	}
+	transfersStart.push_back(0);
+	for (int32_t s = 0; s < stops.size(); s++) {
+		SHARED_PTR<TransportStop>& stop = stops[s];
+		int64_t cx = stop->x31 / cell;
+		int64_t cy = stop->y31 / cell;
+		for (int64_t i = -1; i <= 1; i++) {
+			for (int64_t j = -1; j <= 1; j++) {
+				auto it = grid.find(((cx + i) << 31) + cy + j);
+				if (it == grid.end()) {
+					continue;
+				}
+				for (int32_t t : it->second) {
+					double d = t == s ? 0 : getDistance(stop->lat, stop->lon, stops[t]->lat, stops[t]->lon);
+					if (d <= ctx->cfg->walkChangeRadius) {
+						transferStops.push_back(t);
+						transferDists.push_back(d);
+					}
+				}
+			}
+		}
+		transfersStart.push_back((int32_t)transferStops.size());
+	}
+}
+
+bool TransportRaptorPlanner::buildNetwork(unique_ptr<TransportRoutingContext>& ctx) {
+	int32_t z = ctx->cfg->zoomToLoadTiles;
+	int32_t d = ctx->walkRadiusIn31;
+	int32_t lx = (std::min(ctx->startX, ctx->targetX) - d) >> (31 - z);
+	int32_t rx = (std::max(ctx->startX, ctx->targetX) + d) >> (31 - z);
+	int32_t ty = (std::min(ctx->startY, ctx->targetY) - d) >> (31 - z);
+	int32_t by = (std::max(ctx->startY, ctx->targetY) + d) >> (31 - z);
+	if ((int64_t)(rx - lx + 1) * (by - ty + 1) > MAX_TILES) {
+		return false;
+	}
+	ctx->loadTime.Start();
+	UNORDERED(set)<int64_t> loadedRoutes;
+	vector<SHARED_PTR<TransportRoute>> areaRoutes;
+	for (int32_t x = lx; x <= rx; x++) {
+		for (int32_t y = ty; y <= by; y++) {
+			int64_t tileId = (((int64_t)x) << (z + 1)) + y;
+			auto it = ctx->quadTree.find(tileId);
+			if (it == ctx->quadTree.end()) {
+				it = ctx->quadTree.insert({tileId, ctx->loadTile(x, y)}).first;
+			}
+			for (SHARED_PTR<TransportRouteSegment>& s : it->second) {
+				if (loadedRoutes.insert(s->road->id).second) {
+					areaRoutes.push_back(s->road);
+				}
+			}
+		}
+	}
+	ctx->loadTime.Pause();
+
+	vector<vector<pair<int32_t, int32_t>>> routesByStop;
+	routeStopsStart.push_back(0);
+	routeTripsStart.push_back(0);
+	for (SHARED_PTR<TransportRoute>& route : areaRoutes) {
+		addRoute(ctx, route, routesByStop);
+	}
+	routesByStop.resize(stops.size());
+	stopRoutesStart.push_back(0);
+	for (vector<pair<int32_t, int32_t>>& rs : routesByStop) {
+		for (pair<int32_t, int32_t>& p : rs) {
+			stopRoutes.push_back(p.first);
+			stopRoutePositions.push_back(p.second);
+		}
+		stopRoutesStart.push_back((int32_t)stopRoutes.size());
+	}
+	buildTransfers(ctx);
+	return true;
+}
+
+// first trip which departs from position not earlier than ready (-1 if there is no such trip)
+int32_t TransportRaptorPlanner::findTrip(int32_t route, int32_t pos, double ready,
+										 unique_ptr<TransportRoutingContext>& ctx) {
+	int32_t lo = routeTripsStart[route];
+	int32_t hi = routeTripsStart[route + 1];
+	auto it = std::lower_bound(tripDepartures.begin() + lo, tripDepartures.begin() + hi, ready,
+							   [&](int32_t dep, double rd) { return getTripTime(route, dep, pos, ctx) < rd; });
+	if (it == tripDepartures.begin() + hi) {
+		return -1;
+	}
+	int32_t stopTime = *it + (int32_t)(routeStopTimes[routeStopsStart[route] + pos] / 10);
+	if (stopTime > ctx->cfg->scheduleTimeOfDay + ctx->cfg->scheduleMaxTime) {
+		return -1;
+	}
+	return *it;
+}
+
+// time from start of calculation when trip (departure from the first stop) is at position
+double TransportRaptorPlanner::getTripTime(int32_t route, int32_t departure, int32_t pos,
+										   unique_ptr<TransportRoutingContext>& ctx) {
+	return (departure - ctx->cfg->scheduleTimeOfDay) * 10 + routeStopTimes[routeStopsStart[route] + pos];
+}
+
+SHARED_PTR<TransportRouteResult> TransportRaptorPlanner::buildResult(unique_ptr<TransportRoutingContext>& ctx,
+																	 int32_t round, int32_t stop, double routeTime,
+																	 double finishWalkDist) {
+	SHARED_PTR<TransportRouteResult> route(new TransportRouteResult(ctx->cfg));
+	route->routeTime = routeTime;
+	route->finishWalkDist = finishWalkDist;
+	for (int32_t k = round; k > 0 && stop >= 0; k--) {
+		StopLabel& l = rounds[k][stop];
+		int32_t off = routeStopsStart[l.route];
+		int32_t boardStop = routeStops[off + l.boardPos];
+		StopLabel& b = rounds[k - 1][boardStop];
+		SHARED_PTR<TransportRouteResultSegment> sg(new TransportRouteResultSegment());
+		sg->route = routes[l.route];
+		sg->start = l.boardPos;
+		sg->end = l.alightPos;
+		sg->walkDist = b.walkDist;
+		sg->walkTime = sg->walkDist / ctx->cfg->walkSpeed;
+		sg->depTime = l.departure < 0 ? -1 : l.departure + (int32_t)(routeStopTimes[off + l.boardPos] / 10);
+		sg->travelDistApproximate = routeStopDists[off + l.alightPos] - routeStopDists[off + l.boardPos];
+		sg->travelTime = routeStopTimes[off + l.alightPos] - routeStopTimes[off + l.boardPos];
+		route->segments.insert(route->segments.begin(), sg);
+		stop = b.readyFrom;
+	}
+	return route;
+}
+
+bool TransportRaptorPlanner::buildTransportRoute(unique_ptr<TransportRoutingContext>& ctx,
+												 vector<SHARED_PTR<TransportRouteResult>>& res) {
+	OsmAnd::ElapsedTimer pt_timer;
+	pt_timer.Start();
+	ctx->loadTime.Enable();
+	ctx->searchTransportIndexTime.Enable();
+	ctx->readTime.Enable();
+	ctx->calcLatLons();
+	if (!buildNetwork(ctx)) {
+		OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "[NATIVE] PT area is too large for RAPTOR");
+		return false;
+	}
+	SHARED_PTR<RouteCalculationProgress> progress = ctx->calculationProgress;
+	const double INF = std::numeric_limits<double>::max();
+	const int32_t nstops = (int32_t)stops.size();
+	const float walkSpeed = ctx->cfg->walkSpeed;
+
+	double totalDistance = getDistance(ctx->startLat, ctx->startLon, ctx->endLat, ctx->endLon);
+	double finishTime = ctx->cfg->maxRouteTime;
+	if (totalDistance > ctx->cfg->maxRouteDistance && ctx->cfg->maxRouteIncreaseSpeed > 0) {
+		finishTime += (int)((totalDistance - ctx->cfg->maxRouteDistance) * 3.6 / ctx->cfg->maxRouteIncreaseSpeed);
+	}
+	double maxTravelTimeCmpToWalk = totalDistance / walkSpeed - ctx->cfg->changeTime / 2;
+
+	StopLabel empty;
+	empty.arrival = INF;
+	empty.ready = INF;
+	vector<double> bestArrival(nstops, INF);
+	vector<double> bestReady(nstops, INF);
+	vector<double> finishDist(nstops, -1);
+	vector<int32_t> marked;
+	vector<bool> isMarked(nstops, false);
+	rounds.push_back(vector<StopLabel>(nstops, empty));
+	for (int32_t s = 0; s < nstops; s++) {
+		SHARED_PTR<TransportStop>& stop = stops[s];
+		double d = getDistance(stop->lat, stop->lon, ctx->startLat, ctx->startLon);
+		if (d < ctx->cfg->walkRadius) {
+			rounds[0][s].ready = bestReady[s] = d / walkSpeed;
+			rounds[0][s].walkDist = d;
+			marked.push_back(s);
+		}
+		d = getDistance(stop->lat, stop->lon, ctx->endLat, ctx->endLon);
+		if (d < ctx->cfg->walkRadius) {
+			finishDist[s] = d;
+		}
+	}
+
+	double bestTarget = finishTime;
+	vector<int32_t> routeMarkedPos(routes.size(), INT_MAX);
+	vector<int32_t> markedRoutes;
+	for (int32_t k = 1; k <= ctx->cfg->maxNumberOfChanges + 1 && !marked.empty(); k++) {
+		if (progress != nullptr && progress->isCancelled()) {
+			progress->setSegmentNotFound(0);
+			return true;
+		}
+		vector<StopLabel>& prev = rounds[k - 1];
+		rounds.push_back(vector<StopLabel>(nstops, empty));
+		vector<StopLabel>& cur = rounds[k];
+
+		// routes serving stops improved by previous round from the earliest position
+		for (int32_t s : marked) {
+			for (int32_t i = stopRoutesStart[s]; i < stopRoutesStart[s + 1]; i++) {
+				int32_t r = stopRoutes[i];
+				if (routeMarkedPos[r] == INT_MAX) {
+					markedRoutes.push_back(r);
+				}
+				routeMarkedPos[r] = std::min(routeMarkedPos[r], stopRoutePositions[i]);
+			}
+		}
+		marked.clear();
+
+		for (int32_t r : markedRoutes) {
+			ctx->visitedRoutesCount++;
+			int32_t off = routeStopsStart[r];
+			int32_t len = routeStopsStart[r + 1] - off;
+			int32_t boardPos = -1;
+			int32_t departure = -1;
+			double boardTime = 0;
+			for (int32_t pos = routeMarkedPos[r]; pos < len; pos++) {
+				int32_t s = routeStops[off + pos];
+				if (boardPos >= 0) {
+					double arrival = ctx->cfg->useSchedule ? getTripTime(r, departure, pos, ctx)
+														   : boardTime + routeStopTimes[off + pos] -
+																 routeStopTimes[off + boardPos];
+					if (arrival < bestArrival[s] && arrival < bestTarget) {
+						bestArrival[s] = arrival;
+						StopLabel& l = cur[s];
+						l.arrival = arrival;
+						l.route = r;
+						l.boardPos = boardPos;
+						l.alightPos = pos;
+						l.departure = departure;
+						if (!isMarked[s]) {
+							isMarked[s] = true;
+							marked.push_back(s);
+						}
+					}
+				}
+				double ready = prev[s].ready;
+				if (ready == INF) {
+					continue;
+				}
+				if (ctx->cfg->useSchedule) {
+					// earlier trip could be caught here
+					if (boardPos < 0 || ready < getTripTime(r, departure, pos, ctx)) {
+						int32_t trip = findTrip(r, pos, ready, ctx);
+						if (trip >= 0 && (boardPos < 0 || trip < departure)) {
+							boardPos = pos;
+							departure = trip;
+						}
+					}
+				} else if (boardPos < 0 ||
+						   ready - routeStopTimes[off + pos] < boardTime - routeStopTimes[off + boardPos]) {
+					boardPos = pos;
+					boardTime = ready;
+				}
+			}
+			routeMarkedPos[r] = INT_MAX;
+		}
+		markedRoutes.clear();
+
+		// walk to target and changes to the next round
+		double roundTarget = INF;
+		int32_t roundStop = -1;
+		vector<int32_t> arrived;
+		arrived.swap(marked);
+		for (int32_t s : arrived) {
+			isMarked[s] = false;
+			ctx->visitedStops++;
+			double arrival = cur[s].arrival;
+			if (finishDist[s] >= 0 && arrival + finishDist[s] / walkSpeed < roundTarget) {
+				roundTarget = arrival + finishDist[s] / walkSpeed;
+				roundStop = s;
+			}
+			for (int32_t i = transfersStart[s]; i < transfersStart[s + 1]; i++) {
+				int32_t t = transferStops[i];
+				double ready = arrival + transferDists[i] / walkSpeed + ctx->cfg->getChangeTime() +
+							   ctx->cfg->getBoardingTime();
+				if (ready < bestReady[t] && ready < bestTarget) {
+					bestReady[t] = ready;
+					cur[t].ready = ready;
+					cur[t].readyFrom = s;
+					cur[t].walkDist = transferDists[i];
+					if (!isMarked[t]) {
+						isMarked[t] = true;
+						marked.push_back(t);
+					}
+				}
+			}
+		}
+		for (int32_t s : marked) {
+			isMarked[s] = false;
+		}
+		if (roundStop >= 0 && roundTarget < bestTarget) {
+			bestTarget = roundTarget;
+			if (roundTarget < maxTravelTimeCmpToWalk || res.size() == 0) {
+				res.push_back(buildResult(ctx, k, roundStop, roundTarget, finishDist[roundStop]));
+			}
+		}
+	}
+	// fastest first (with more changes)
+	std::reverse(res.begin(), res.end());
+	pt_timer.Pause();
+	OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info,
+					  "[NATIVE] PT RAPTOR calculation took %.3f s (%d rounds, %d results), network %d stops / %d "
+					  "routes, loading tiles: %.3f s, readTime : %.3f s",
+					  (double)pt_timer.GetElapsedMs() / 1000.0, (int)rounds.size() - 1, (int)res.size(), nstops,
+					  (int)routes.size(), (double)ctx->loadTime.GetElapsedMs() / 1000.0,
+					  (double)ctx->readTime.GetElapsedMs() / 1000.0);
+	return true;
+}
+
+#endif	//_OSMAND_TRANSPORT_RAPTOR_PLANNER_CPP
@@ -0,0 +1,69 @@
+#ifndef _OSMAND_TRANSPORT_RAPTOR_PLANNER_H
+#define _OSMAND_TRANSPORT_RAPTOR_PLANNER_H
+#include "CommonCollections.h"
+#include "commonOsmAndCore.h"
+
+struct TransportRoute;
+struct TransportStop;
+struct TransportRoutingContext;
+struct TransportRouteResult;
+
+// Round based public transport routing (RAPTOR), selected by TransportRoutingConfiguration::useRaptor.
+// Routes and stops of tiles around start and target are loaded once and laid out into flat arrays.
+// Round k scans only routes serving stops improved by round k - 1 (k - 1 changes), so every round
+// which arrives to target earlier than all previous rounds gives pareto optimal result (arrival time, changes).
+class TransportRaptorPlanner {
+	// area around start and target with more tiles is calculated by segments planner
+	const static int MAX_TILES = 4096;
+
+	struct StopLabel {
+		// arrival by route (round k)
+		double arrival;
+		int32_t route = -1;
+		int32_t boardPos = -1;
+		int32_t alightPos = -1;
+		int32_t departure = -1;
+		// time when route could be boarded after walk (from start or after change)
+		double ready;
+		int32_t readyFrom = -1;
+		double walkDist = 0;
+	};
+
+	// routes: stops, time and distance from the first stop by position
+	vector<SHARED_PTR<TransportRoute>> routes;
+	vector<int32_t> routeStopsStart;
+	vector<int32_t> routeStops;
+	vector<double> routeStopTimes;
+	vector<double> routeStopDists;
+	// departures from the first stop (schedule)
+	vector<int32_t> routeTripsStart;
+	vector<int32_t> tripDepartures;
+	// stops: routes (with position) serving stop and stops to change within walkChangeRadius
+	vector<SHARED_PTR<TransportStop>> stops;
+	UNORDERED(map)<int64_t, int32_t> stopIndexes;
+	vector<int32_t> stopRoutesStart;
+	vector<int32_t> stopRoutes;
+	vector<int32_t> stopRoutePositions;
+	vector<int32_t> transfersStart;
+	vector<int32_t> transferStops;
+	vector<double> transferDists;
+
+	vector<vector<StopLabel>> rounds;
+
+   public:
+	// returns false if network is too large (nothing is calculated)
+	bool buildTransportRoute(unique_ptr<TransportRoutingContext>& ctx, vector<SHARED_PTR<TransportRouteResult>>& res);
+
+   private:
+	bool buildNetwork(unique_ptr<TransportRoutingContext>& ctx);
+	int32_t getStopIndex(SHARED_PTR<TransportStop>& stop);
+	void addRoute(unique_ptr<TransportRoutingContext>& ctx, SHARED_PTR<TransportRoute>& route,
+				  vector<vector<pair<int32_t, int32_t>>>& routesByStop);
+	void buildTransfers(unique_ptr<TransportRoutingContext>& ctx);
+	int32_t findTrip(int32_t route, int32_t pos, double ready, unique_ptr<TransportRoutingContext>& ctx);
+	double getTripTime(int32_t route, int32_t trip, int32_t pos, unique_ptr<TransportRoutingContext>& ctx);
+	SHARED_PTR<TransportRouteResult> buildResult(unique_ptr<TransportRoutingContext>& ctx, int32_t round, int32_t stop,
+												 double routeTime, double finishWalkDist);
+};
+
+#endif	// _OSMAND_TRANSPORT_RAPTOR_PLANNER_H
@@ -3,6 +3,7 @@
 #include "transportRoutePlanner.h"
 
 #include "Logging.h"
+#include "transportRaptorPlanner.h"
 #include "transportRouteResult.h"
 #include "transportRouteResultSegment.h"
 #include "transportRouteSegment.h"
@@ -115,6 +116,9 @@ void TransportRoutePlanner::prepareResults(unique_ptr<TransportRoutingContext>&
 
 void TransportRoutePlanner::buildTransportRoute(unique_ptr<TransportRoutingContext>& ctx,
 												vector<SHARED_PTR<TransportRouteResult>>& res) {
+	if (ctx->cfg->useRaptor && TransportRaptorPlanner().buildTransportRoute(ctx, res)) {
+		return;
+	}
 	OsmAnd::ElapsedTimer pt_timer;
 	pt_timer.Start();
 	ctx->loadTime.Enable();
@@ -239,6 +239,7 @@ PT_STOPS_SEGMENT TransportRouteStopsReader::findAndDeleteMinDistance(double lat,
 		double dist = getDistance(s->lat, s->lon, lat, lon);
 		if (dist < minDist) {
 			minInd = i;
+			minDist = dist;
 		}
 	}
 	auto res = mergedSegments.at(minInd);
@@ -263,29 +264,73 @@ vector<PT_STOPS_SEGMENT> TransportRouteStopsReader::combineSegmentsOfSameRoute(v
 	return mergeSegments(tempResultSegments, resultSegments, true);
 }
 
+// Segments which could be merged with first segment are found by index: segments with common stop ids
+// or with missing end stop in the same / neighbor cell of grid (cell is larger than MISSING_STOP_SEARCH_RADIUS).
+// Candidates are checked in order of segments, so result is the same as checking all segments one by one.
 vector<PT_STOPS_SEGMENT> TransportRouteStopsReader::mergeSegments(vector<PT_STOPS_SEGMENT>& segments,
 																  vector<PT_STOPS_SEGMENT>& resultSegments,
 																  bool mergeMissingSegs) {
-	std::deque<PT_STOPS_SEGMENT> segQueue(segments.begin(), segments.end());  // check
-	while (!segQueue.empty()) {
-		auto firstSegment = segQueue.front();
-		segQueue.pop_front();
+	double cellSize = getMissingStopsCellSize(segments);
+	UNORDERED(map)<int64_t, vector<int32_t>> index;
+	for (int32_t i = 0; i < segments.size(); i++) {
+		PT_STOPS_SEGMENT& s = segments[i];
+		if (s.empty()) {
+			continue;
+		}
+		if (!mergeMissingSegs) {
+			for (auto& stop : s) {
+				if (stop->id > 0) {
+					index[stop->id].push_back(i);
+				}
+			}
+			continue;
+		}
+		if (s.front()->isMissingStop()) {
+			index[getMissingStopCell(s.front(), cellSize)].push_back(i);
+		}
+		if (s.back()->isMissingStop() && s.size() > 1) {
+			index[getMissingStopCell(s.back(), cellSize)].push_back(i);
+		}
+	}
+	vector<bool> used(segments.size(), false);
+	vector<int32_t> candidates;
+	for (int32_t i = 0; i < segments.size(); i++) {
+		if (used[i]) {
+			continue;
+		}
+		used[i] = true;
+		PT_STOPS_SEGMENT firstSegment = segments[i];
 		bool merged = true;
-		while (merged) {
+		while (merged && !firstSegment.empty()) {
 			merged = false;
-			deque<PT_STOPS_SEGMENT>::iterator it = segQueue.begin();
-			while (it != segQueue.end()) {
-				auto segmentToMerge = *it;
+			candidates.clear();
+			if (mergeMissingSegs) {
+				findMissingStopCandidates(firstSegment.front(), cellSize, index, used, candidates);
+				findMissingStopCandidates(firstSegment.back(), cellSize, index, used, candidates);
+			} else {
+				for (auto& stop : firstSegment) {
+					const auto it = stop->id > 0 ? index.find(stop->id) : index.end();
+					if (it == index.end()) {
+						continue;
+					}
+					for (int32_t j : it->second) {
+						if (!used[j]) {
+							candidates.push_back(j);
+						}
+					}
+				}
+			}
+			std::sort(candidates.begin(), candidates.end());
+			candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+			for (int32_t j : candidates) {
 				if (mergeMissingSegs) {
-					merged = tryToMergeMissingStops(firstSegment, segmentToMerge);
+					merged = tryToMergeMissingStops(firstSegment, segments[j]);
 				} else {
-					merged = tryToMerge(firstSegment, segmentToMerge);
+					merged = tryToMerge(firstSegment, segments[j]);
 				}
 				if (merged) {
-					it = segQueue.erase(it);
+					used[j] = true;
 					break;
-				} else if (it != segQueue.end()) {
-					it++;
 				}
 			}
 		}
@@ -294,24 +339,64 @@ vector<PT_STOPS_SEGMENT> TransportRouteStopsReader::mergeSegments(vector<PT_STOP
 	return resultSegments;
 }
 
+// cell (in 31 coordinates) which is larger than MISSING_STOP_SEARCH_RADIUS at the most northern / southern stop
+double TransportRouteStopsReader::getMissingStopsCellSize(vector<PT_STOPS_SEGMENT>& segments) {
+	double maxLat = 0;
+	for (auto& s : segments) {
+		for (auto& stop : s) {
+			maxLat = std::max(maxLat, std::abs(stop->lat));
+		}
+	}
+	double metersIn31 = 40075016.686 * cos(std::min(maxLat, 85.0) / 180.0 * M_PI) / 2147483648.0;
+	return MISSING_STOP_SEARCH_RADIUS / metersIn31;
+}
+
+int64_t TransportRouteStopsReader::getMissingStopCell(SHARED_PTR<TransportStop>& stop, double cellSize) {
+	int64_t x = (int64_t)(get31TileNumberX(stop->lon) / cellSize);
+	int64_t y = (int64_t)(get31TileNumberY(stop->lat) / cellSize);
+	return (x << 31) + y;
+}
+
+void TransportRouteStopsReader::findMissingStopCandidates(SHARED_PTR<TransportStop>& stop, double cellSize,
+														  UNORDERED(map) < int64_t, vector<int32_t> > &index,
+														  vector<bool>& used, vector<int32_t>& candidates) {
+	if (!stop->isMissingStop()) {
+		return;
+	}
+	int64_t cell = getMissingStopCell(stop, cellSize);
+	for (int64_t i = -1; i <= 1; i++) {
+		for (int64_t j = -1; j <= 1; j++) {
+			const auto it = index.find(cell + (i << 31) + j);
+			if (it == index.end()) {
+				continue;
+			}
+			for (int32_t k : it->second) {
+				if (!used[k]) {
+					candidates.push_back(k);
+				}
+			}
+		}
+	}
+}
+
 bool TransportRouteStopsReader::tryToMerge(PT_STOPS_SEGMENT& firstSegment, PT_STOPS_SEGMENT& segmentToMerge) {
 	if (firstSegment.size() < 2 || segmentToMerge.size() < 2) {
 		return false;
 	}
+	// first position of every stop id of second segment
+	UNORDERED(map)<int64_t, int> positions;
+	for (int i = segmentToMerge.size() - 1; i >= 0; i--) {
+		positions[segmentToMerge[i]->id] = i;
+	}
 	int commonStopFirst = 0;
 	int commonStopSecond = 0;
 	bool found = false;
 	for (; commonStopFirst < firstSegment.size(); commonStopFirst++) {
-		for (commonStopSecond = 0; commonStopSecond < segmentToMerge.size() && !found; commonStopSecond++) {
-			auto lid1 = firstSegment[commonStopFirst]->id;
-			auto lid2 = segmentToMerge[commonStopSecond]->id;
-			if (lid1 > 0 && lid2 == lid1) {
-				found = true;
-				break;
-			}
-		}
-		if (found) {
-			// important to increment break inside loop
+		auto lid1 = firstSegment[commonStopFirst]->id;
+		const auto it = lid1 > 0 ? positions.find(lid1) : positions.end();
+		if (it != positions.end()) {
+			commonStopSecond = it->second;
+			found = true;
 			break;
 		}
 	}
@@ -38,6 +38,11 @@ struct TransportRouteStopsReader {
 	vector<PT_STOPS_SEGMENT> mergeSegments(vector<PT_STOPS_SEGMENT>& segments, 
 											vector<PT_STOPS_SEGMENT>& resultSegments, 
 											bool mergeMissingSegs);
+	double getMissingStopsCellSize(vector<PT_STOPS_SEGMENT>& segments);
+	int64_t getMissingStopCell(SHARED_PTR<TransportStop>& stop, double cellSize);
+	void findMissingStopCandidates(SHARED_PTR<TransportStop>& stop, double cellSize,
+								   UNORDERED(map) < int64_t, vector<int32_t> > &index, vector<bool>& used,
+								   vector<int32_t>& candidates);
 	bool tryToMerge(PT_STOPS_SEGMENT& firstSegment, PT_STOPS_SEGMENT& segmentToMerge);
 	bool tryToMergeMissingStops(PT_STOPS_SEGMENT& firstSegment, PT_STOPS_SEGMENT& segmentToMerge);
 	vector<PT_STOPS_SEGMENT> parseRoutePartsToSegments(vector<SHARED_PTR<TransportRoute>> routeParts);
@@ -40,6 +40,7 @@ TransportRoutingConfiguration::TransportRoutingConfiguration(
 							 3.6f;
 		maxRouteIncreaseSpeed = router->getIntAttribute("maxRouteIncreaseSpeed", maxRouteIncreaseSpeed);
 		maxRouteDistance =  router->getIntAttribute("maxRouteDistance", maxRouteDistance);
+		useRaptor = router->getAttribute("useRaptor") == "true";
 
 		RouteAttributeContext &obstacles =
 			router->getObjContext(RouteDataObjectAttribute::ROUTING_OBSTACLES);
@@ -27,6 +27,8 @@ struct TransportRoutingConfiguration {
 	int32_t boardingTime = 180;
 
 	bool useSchedule = false;
+	// round based engine (TransportRaptorPlanner) instead of segments queue
+	bool useRaptor = false;
 
 	int32_t scheduleTimeOfDay = 12 * 60 * 6;
 	int32_t scheduleMaxTime = 50 * 6;
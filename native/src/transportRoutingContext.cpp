@@ -5,6 +5,7 @@
 #include "Logging.h"
 #include "binaryRead.h"
 #include "routeCalculationProgress.h"
+#include "transportNetworkCache.h"
 #include "transportRoutePlanner.h"
 #include "transportRouteSegment.h"
 #include "transportRouteStopsReader.h"
@@ -81,10 +82,14 @@ std::vector<SHARED_PTR<TransportRouteSegment>> TransportRoutingContext::loadTile
 	vector<SHARED_PTR<TransportRouteSegment>> lst;
 	int pz = (31 - cfg->zoomToLoadTiles);
 	vector<SHARED_PTR<TransportStop>> stops;
-	SearchQuery q;
-	buildSearchTransportRequest(&q, (x << pz), ((x + 1) << pz), (y << pz), ((y + 1) << pz), -1, stops);
-
-	stops = transportStopsReader->readMergedTransportStops(&q);
+	TransportNetworkCache &cache = TransportNetworkCache::getInstance();
+	if (cache.isEnabled()) {
+		stops = cache.getTileStops(cfg->zoomToLoadTiles, x, y);
+	} else {
+		SearchQuery q;
+		buildSearchTransportRequest(&q, (x << pz), ((x + 1) << pz), (y << pz), ((y + 1) << pz), -1, stops);
+		stops = transportStopsReader->readMergedTransportStops(&q);
+	}
 	loadTransportSegments(stops, lst);
 	readTime.Pause();
 	return lst;
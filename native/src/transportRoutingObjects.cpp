@@ -215,8 +215,12 @@ TransportSchedule& TransportRoute::getOrCreateSchedule() {
 }
 
 void TransportRoute::mergeForwardWays() {
+	if (waysMerged) {
+		return;
+	}
 	mergeForwardWays(forwardWays);
 	resortWaysToStopsOrder(forwardWays, forwardStops);
+	waysMerged = true;
 }
 
 void TransportRoute::mergeForwardWays(vector<shared_ptr<Way>>& ways) {
@@ -342,6 +346,7 @@ UNORDERED_map<shared_ptr<Way>, pair<int, int>> TransportRoute::resortWaysToStops
 
 void TransportRoute::addWay(shared_ptr<Way>& w) {
 	forwardWays.push_back(w);
+	waysMerged = false;
 }
 
 int32_t TransportRoute::getAvgBothDistance() {
@@ -136,6 +136,8 @@ struct TransportRoute : public MapObject {
 	string color;
 	vector<SHARED_PTR<Way>> forwardWays;
 	TransportSchedule schedule;
+	// forward ways are merged and sorted by stops once
+	bool waysMerged = false;
 
 	TransportRoute();
 	TransportRoute(SHARED_PTR<TransportRoute>& base, vector<SHARED_PTR<TransportStop>>& cforwardStops, vector<SHARED_PTR<Way>>& cforwardWays);
@@ -241,11 +241,11 @@ string TurnType::toString() {
 }
 
 vector<int> TurnType::lanesFromString(string lanesString) {
-	vector<int> lanes;
 	if (lanesString.empty()) {
-		return lanes;
+		return vector<int>();
 	}
 	auto lanesArr = split_string(lanesString, "|");
+	vector<int> lanes(lanesArr.size());
 	for (int l = 0; l < lanesArr.size(); l++) {
 		string lane = lanesArr[l];
 		vector<string> turns = split_string(lane, ",");
@@ -0,0 +1,180 @@
+// Checks that vectorized pixel kernels of terrain rasters (every dispatch level supported by CPU) give
+// the same result as scalar reference kernels on random values and edge cases (NaN, infinity, no-data,
+// values out of byte range, lengths which are not multiple of vector size, unaligned buffers).
+// Usage: heightmapKernelsTest [iterations]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "heightmapKernels.h"
+
+static const char* levelName(const KernelsLevel level) {
+	switch (level) {
+		case KernelsLevel::Scalar:
+			return "Scalar";
+		case KernelsLevel::SSE41:
+			return "SSE4.1";
+		case KernelsLevel::AVX2:
+			return "AVX2";
+		case KernelsLevel::NEON:
+			return "NEON";
+	}
+	return "?";
+}
+
+// Same bits, or both are NaN (payload of NaN is not part of result)
+static bool sameFloat(const float a, const float b) {
+	return std::memcmp(&a, &b, sizeof(float)) == 0 || (std::isnan(a) && std::isnan(b));
+}
+
+static float randomHeight(std::mt19937& rnd, const float noData) {
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	switch (rnd() % 16) {
+		case 0:
+		case 1:
+			return noData;
+		case 2:
+			return nan;
+		case 3:
+			return rnd() % 2 ? inf : -inf;
+		case 4:
+			return rnd() % 2 ? 0.0f : -0.0f;
+		default:
+			return std::uniform_real_distribution<float>(-500.0f, 9000.0f)(rnd);
+	}
+}
+
+static float randomByteValue(std::mt19937& rnd) {
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	static const float edges[] = {0.0f, -0.0f, 0.49999997f, 0.5f, 1.5f, 254.49998f, 254.5f, 255.0f, 255.5f,
+								  256.0f, -1.0f, -0.5f, 1e9f, -1e9f};
+	switch (rnd() % 8) {
+		case 0:
+			return nan;
+		case 1:
+			return rnd() % 2 ? inf : -inf;
+		case 2:
+			return edges[rnd() % (sizeof(edges) / sizeof(edges[0]))];
+		default:
+			return std::uniform_real_distribution<float>(-20.0f, 275.0f)(rnd);
+	}
+}
+
+static bool checkBlendHillshade(std::mt19937& rnd, const KernelsLevel level, const uint32_t offset,
+								const uint32_t count) {
+	std::vector<uint8_t> shade(offset + count), slope(offset + count);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		// zero shade is no-data, 255 is the largest product
+		const auto r = rnd() % 8;
+		shade[i] = r == 0 ? 0 : r == 1 ? 255 : static_cast<uint8_t>(rnd());
+		slope[i] = r == 2 ? 0 : r == 3 ? 255 : static_cast<uint8_t>(rnd());
+	}
+	std::vector<uint8_t> expected(offset + count, 0xAA), actual(offset + count, 0xAA);
+	setKernelsLevel(KernelsLevel::Scalar);
+	blendHillshadeKernel(shade.data() + offset, slope.data() + offset, expected.data() + offset, count);
+	setKernelsLevel(level);
+	blendHillshadeKernel(shade.data() + offset, slope.data() + offset, actual.data() + offset, count);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		if (expected[i] != actual[i]) {
+			printf("%s blendHillshade (count %u, offset %u): [%u] shade %u slope %u expected %u actual %u\n",
+				   levelName(level), count, offset, i, shade[i], slope[i], expected[i], actual[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool checkMergeHeights(std::mt19937& rnd, const KernelsLevel level, const uint32_t offset,
+							  const uint32_t count, const float noData, const bool forceReplace) {
+	std::vector<float> source(offset + count), destination(offset + count);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		source[i] = randomHeight(rnd, noData);
+		destination[i] = randomHeight(rnd, noData);
+	}
+	const float scaleFactor = rnd() % 4 == 0 ? 1.0f : std::uniform_real_distribution<float>(0.1f, 10.0f)(rnd);
+	auto expected = destination;
+	auto actual = destination;
+	setKernelsLevel(KernelsLevel::Scalar);
+	mergeHeightsKernel(expected.data() + offset, source.data() + offset, count, scaleFactor, forceReplace, noData);
+	setKernelsLevel(level);
+	mergeHeightsKernel(actual.data() + offset, source.data() + offset, count, scaleFactor, forceReplace, noData);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		if (!sameFloat(expected[i], actual[i])) {
+			printf("%s mergeHeights (count %u, offset %u, no-data %g, force %d): [%u] destination %g source %g "
+				   "expected %g actual %g\n",
+				   levelName(level), count, offset, noData, forceReplace, i, destination[i], source[i],
+				   expected[i], actual[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool checkConvertToBytes(std::mt19937& rnd, const KernelsLevel level, const uint32_t offset,
+								const uint32_t count) {
+	std::vector<float> values(offset + count);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		values[i] = randomByteValue(rnd);
+	}
+	std::vector<uint8_t> expected(offset + count, 0xAA), actual(offset + count, 0xAA);
+	setKernelsLevel(KernelsLevel::Scalar);
+	convertToBytesKernel(values.data() + offset, expected.data() + offset, count);
+	setKernelsLevel(level);
+	convertToBytesKernel(values.data() + offset, actual.data() + offset, count);
+	for (uint32_t i = 0; i < offset + count; i++) {
+		if (expected[i] != actual[i]) {
+			printf("%s convertToBytes (count %u, offset %u): [%u] value %g expected %u actual %u\n",
+				   levelName(level), count, offset, i, values[i], expected[i], actual[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	const int iterations = argc > 1 ? atoi(argv[1]) : 20;
+	const KernelsLevel supported = getKernelsLevel();
+	const float noDataValues[] = {-32768.0f, 0.0f, std::numeric_limits<float>::quiet_NaN()};
+	std::mt19937 rnd(7);
+	int failed = 0;
+	for (const auto level : {KernelsLevel::SSE41, KernelsLevel::AVX2, KernelsLevel::NEON}) {
+		setKernelsLevel(KernelsLevel::Scalar);
+		setKernelsLevel(level);
+		if (getKernelsLevel() != level) {
+			printf("%s: not supported\n", levelName(level));
+			continue;
+		}
+		int checks = 0;
+		bool ok = true;
+		for (int it = 0; it < iterations && ok; it++) {
+			// All tail lengths of vectors up to 32 values and a long row
+			for (uint32_t count = 0; count <= 70 && ok; count++) {
+				const uint32_t offset = rnd() % 4;
+				ok = ok && checkBlendHillshade(rnd, level, offset, count);
+				ok = ok && checkConvertToBytes(rnd, level, offset, count);
+				for (const auto noData : noDataValues) {
+					ok = ok && checkMergeHeights(rnd, level, offset, count, noData, false);
+					ok = ok && checkMergeHeights(rnd, level, offset, count, noData, true);
+				}
+				checks += 8;
+			}
+			ok = ok && checkBlendHillshade(rnd, level, 1, 4099);
+			ok = ok && checkConvertToBytes(rnd, level, 1, 4099);
+			ok = ok && checkMergeHeights(rnd, level, 1, 4099, noDataValues[0], false);
+			checks += 3;
+		}
+		printf("%s: %s (%d checks)\n", levelName(level), ok ? "same as scalar" : "DIFFERENT", checks);
+		if (!ok) {
+			failed++;
+		}
+	}
+	setKernelsLevel(supported);
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// Checks that compiled opening hours (OpeningHoursParser::CompiledOpeningHours) give the same result as
+// OpeningHours::isOpenedForTime for every minute of more than a year, on weekly rules and rules with months,
+// dates, years, holidays and times after midnight. Also compares time of both checks.
+// Usage: openingHoursCompiledTest [days]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "ElapsedTimer.h"
+#include "openingHoursParser.h"
+
+static const char* const FORMATS[] = {
+	"Mo-Fr 08:00-18:00",
+	"Mo-Fr 08:00-12:00,13:00-18:00; Sa 09:00-13:00",
+	"Mo-Sa 09:00-20:00; Su 10:00-18:00",
+	"Mo-Su 22:00-06:00",
+	"24/7",
+	"Mo-Fr 07:00-09:00,16:00-18:00",
+	"Mo-Fr 08:00-18:00; Dec 25 off",
+	"Nov-Mar Mo-Fr 07:00-19:00",
+	"Mo-Th 10:00-02:00; Fr 10:00-03:00; Sa off",
+	"We 07:00-07:00",
+	"Mo-Fr 06:00-22:00; PH off",
+	"2024 Mar-Jun Mo-Fr 09:00-17:00",
+	"Jan 01-Mar 15 08:00-12:00",
+	"Mo-Fr 18:00-24:00",
+	"sunrise-sunset",
+	"Mo 14:00-02:00; Tu off",
+	"Su,PH 10:00-12:00",
+	"Apr 10-Sep 20: Sa,Su 06:00-20:00",
+};
+
+// 29 Dec 2023 00:00 UTC, so checked days include change of year and a leap year
+static const time_t START = 1703808000;
+
+static tm minuteTime(int day, int minute) {
+	time_t t = START + (time_t)day * 24 * 3600 + minute * 60;
+	tm dateTime;
+	gmtime_r(&t, &dateTime);
+	return dateTime;
+}
+
+static bool checkFormat(const char* format, int days, double& hoursTime, double& compiledTime) {
+	auto hours = OpeningHoursParser::parseOpenedHours(format);
+	if (!hours) {
+		printf("%s: not parsed\n", format);
+		return false;
+	}
+	OpeningHoursParser::CompiledOpeningHours compiled(hours);
+	int differences = 0;
+	OsmAnd::ElapsedTimer hoursTimer, compiledTimer;
+	for (int day = 0; day < days; day++) {
+		for (int minute = 0; minute < 24 * 60; minute++) {
+			tm dateTime = minuteTime(day, minute);
+			hoursTimer.Start();
+			bool expected = hours->isOpenedForTime(dateTime);
+			hoursTimer.Pause();
+			compiledTimer.Start();
+			bool actual = compiled.isOpenedForTime(dateTime);
+			compiledTimer.Pause();
+			if (expected != actual && differences++ < 3) {
+				printf("%s: %04d-%02d-%02d %02d:%02d expected %d actual %d\n", format, dateTime.tm_year + 1900,
+					   dateTime.tm_mon + 1, dateTime.tm_mday, dateTime.tm_hour, dateTime.tm_min, expected, actual);
+			}
+		}
+	}
+	hoursTime += hoursTimer.GetElapsedMicros() / 1000.0;
+	compiledTime += compiledTimer.GetElapsedMicros() / 1000.0;
+	printf("%-45s weekly %d: %s\n", format, compiled.isWeekly(), differences == 0 ? "same" : "DIFFERENT");
+	return differences == 0;
+}
+
+int main(int argc, char** argv) {
+	int days = argc > 1 ? atoi(argv[1]) : 430;
+	int failed = 0;
+	double hoursTime = 0;
+	double compiledTime = 0;
+	for (const char* format : FORMATS) {
+		if (!checkFormat(format, days, hoursTime, compiledTime)) {
+			failed++;
+		}
+	}
+	printf("%d formats, %d days: isOpenedForTime %.2f ms, compiled %.2f ms\n",
+		   (int)(sizeof(FORMATS) / sizeof(FORMATS[0])), days, hoursTime, compiledTime);
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,285 @@
+// Checks that route saved as binary bundles (RouteSegmentResult::writeRouteBinary) is restored by
+// readRouteBinary with the same segments: geometry, types, point types, names, point names, times and turns.
+// Also compares size and time with text form of bundles (vectors converted to strings) and checks that reading
+// doesn't change string table of resources.
+// Usage: routeDataBundleTest [segments]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "ElapsedTimer.h"
+#include "binaryRead.h"
+#include "routeDataBundle.h"
+#include "routeDataResources.h"
+#include "routeSegmentResult.h"
+#include "turnType.h"
+
+static const int HIGHWAY_PRIMARY = 0;
+static const int NAME = 1;
+static const int REF = 2;
+static const int ONEWAY = 3;
+static const int MAXSPEED = 4;
+static const int TRAFFIC_SIGNALS = 5;
+static const int CROSSING = 6;
+
+static SHARED_PTR<RoutingIndex> createRegion() {
+	SHARED_PTR<RoutingIndex> region = std::make_shared<RoutingIndex>();
+	region->initRouteEncodingRule(HIGHWAY_PRIMARY, "highway", "primary");
+	region->initRouteEncodingRule(NAME, "name", "");
+	region->initRouteEncodingRule(REF, "ref", "");
+	region->initRouteEncodingRule(ONEWAY, "oneway", "yes");
+	region->initRouteEncodingRule(MAXSPEED, "maxspeed", "50");
+	region->initRouteEncodingRule(TRAFFIC_SIGNALS, "highway", "traffic_signals");
+	region->initRouteEncodingRule(CROSSING, "crossing", "zebra");
+	return region;
+}
+
+// Route points are continuous: segment starts at the last point of previous one (as locations of GPX track),
+// half of roads go against direction of route
+static vector<SHARED_PTR<RouteSegmentResult>> createRoute(int segments, std::mt19937& rnd,
+														  vector<Location>& locations) {
+	SHARED_PTR<RoutingIndex> region = createRegion();
+	vector<SHARED_PTR<RouteSegmentResult>> route;
+	uint32_t x = 1100000000;
+	uint32_t y = 700000000;
+	for (int i = 0; i < segments; i++) {
+		int length = 2 + rnd() % 10;
+		vector<uint32_t> px, py;
+		for (int k = 0; k < length; k++) {
+			if (k > 0 || i == 0) {
+				if (k > 0) {
+					x += 100 + rnd() % 2000;
+					y += rnd() % 2000;
+				}
+				locations.push_back(Location(get31LatitudeY(y), get31LongitudeX(x)));
+			}
+			// coordinates as they are restored from locations
+			px.push_back(get31TileNumberX(get31LongitudeX(x)));
+			py.push_back(get31TileNumberY(get31LatitudeY(y)));
+		}
+		bool reversed = rnd() % 2 == 0;
+		SHARED_PTR<RouteDataObject> o = std::make_shared<RouteDataObject>();
+		o->region = region;
+		o->id = (int64_t)(1000 + i) << 6;
+		o->types = {HIGHWAY_PRIMARY};
+		if (rnd() % 2) {
+			o->types.push_back(ONEWAY);
+		}
+		if (rnd() % 3 == 0) {
+			o->types.push_back(MAXSPEED);
+		}
+		o->names[NAME] = "Street " + std::to_string(i / 3);
+		o->namesIds.push_back({NAME, 0});
+		if (rnd() % 2) {
+			o->names[REF] = "A" + std::to_string(i / 10);
+			o->namesIds.push_back({REF, 0});
+		}
+		o->pointTypes.resize(length);
+		o->pointNameTypes.resize(length);
+		o->pointNames.resize(length);
+		for (int k = 1; k + 1 < length; k++) {
+			int ind = reversed ? length - 1 - k : k;
+			if (rnd() % 3 == 0) {
+				o->pointTypes[ind] = {TRAFFIC_SIGNALS, CROSSING};
+			}
+			if (rnd() % 4 == 0) {
+				o->pointNameTypes[ind] = {NAME};
+				o->pointNames[ind] = {"Crossing " + std::to_string(i) + "/" + std::to_string(k)};
+			}
+		}
+		if (reversed) {
+			std::reverse(px.begin(), px.end());
+			std::reverse(py.begin(), py.end());
+		}
+		o->pointsX = px;
+		o->pointsY = py;
+		SHARED_PTR<RouteSegmentResult> s =
+			std::make_shared<RouteSegmentResult>(o, reversed ? length - 1 : 0, reversed ? 0 : length - 1);
+		s->segmentTime = (rnd() % 10000) / 100.0f;
+		s->segmentSpeed = (rnd() % 3000) / 100.0f;
+		if (i % 4 == 0) {
+			int turn = i % 8 == 0 ? TurnType::TR : TurnType::TL;
+			s->turnType = std::make_shared<TurnType>(turn);
+			s->turnType->setLanes({TurnType::C << 1, (turn << 1) | 1});
+			s->turnType->setSkipToSpeak(i % 3 == 0);
+		}
+		route.push_back(s);
+	}
+	return route;
+}
+
+static string ruleString(const SHARED_PTR<RouteDataObject>& o, uint32_t type) {
+	RouteTypeRule& r = o->region->quickGetEncodingRule(type);
+	return r.getTag() + "=" + r.getValue();
+}
+
+static vector<string> typeStrings(const SHARED_PTR<RouteDataObject>& o, const vector<uint32_t>& types) {
+	vector<string> res;
+	for (uint32_t t : types) {
+		res.push_back(ruleString(o, t));
+	}
+	std::sort(res.begin(), res.end());
+	return res;
+}
+
+// Values of point in direction of route (restored segment is always forward)
+static int pointIndex(const SHARED_PTR<RouteSegmentResult>& s, int k) {
+	return s->getStartPointIndex() <= s->getEndPointIndex() ? s->getStartPointIndex() + k
+															: s->getStartPointIndex() - k;
+}
+
+template <typename T>
+static T pointValue(const vector<T>& values, int ind) {
+	return ind < (int)values.size() ? values[ind] : T();
+}
+
+static vector<string> pointNameStrings(const SHARED_PTR<RouteDataObject>& o, int ind) {
+	vector<string> res;
+	vector<uint32_t> types = pointValue(o->pointNameTypes, ind);
+	vector<string> names = pointValue(o->pointNames, ind);
+	for (uint32_t k = 0; k < types.size() && k < names.size(); k++) {
+		res.push_back(o->region->quickGetEncodingRule(types[k]).getTag() + "=" + names[k]);
+	}
+	return res;
+}
+
+static bool fail(int i, const char* what) {
+	printf("Segment %d: %s differs\n", i, what);
+	return false;
+}
+
+static bool compareSegment(int i, const SHARED_PTR<RouteSegmentResult>& a, const SHARED_PTR<RouteSegmentResult>& b) {
+	const auto& oa = a->object;
+	const auto& ob = b->object;
+	int length = std::abs(a->getEndPointIndex() - a->getStartPointIndex()) + 1;
+	if (b->getStartPointIndex() != 0 || b->getEndPointIndex() != length - 1) {
+		return fail(i, "length");
+	}
+	if ((oa->id >> 6) != (ob->id >> 6)) {
+		return fail(i, "id");
+	}
+	for (int k = 0; k < length; k++) {
+		int ia = pointIndex(a, k);
+		if (oa->pointsX[ia] != ob->pointsX[k] || oa->pointsY[ia] != ob->pointsY[k]) {
+			return fail(i, "point");
+		}
+		if (typeStrings(oa, pointValue(oa->pointTypes, ia)) != typeStrings(ob, pointValue(ob->pointTypes, k))) {
+			return fail(i, "point types");
+		}
+		if (pointNameStrings(oa, ia) != pointNameStrings(ob, k)) {
+			return fail(i, "point names");
+		}
+	}
+	if (typeStrings(oa, oa->types) != typeStrings(ob, ob->types)) {
+		return fail(i, "types");
+	}
+	string lang;
+	if (oa->getName() != ob->getName() || oa->getRef(lang, false, true) != ob->getRef(lang, false, true)) {
+		return fail(i, "names");
+	}
+	if (std::abs(a->segmentTime - b->segmentTime) > 0.001 || std::abs(a->segmentSpeed - b->segmentSpeed) > 0.001) {
+		return fail(i, "time");
+	}
+	if (!a->turnType != !b->turnType) {
+		return fail(i, "turn");
+	}
+	if (a->turnType && (a->turnType->getValue() != b->turnType->getValue() ||
+						a->turnType->getLanes() != b->turnType->getLanes() ||
+						a->turnType->isSkipToSpeak() != b->turnType->isSkipToSpeak())) {
+		return fail(i, "turn");
+	}
+	return true;
+}
+
+// Text form of bundles as it was stored before (every value as string)
+static size_t writeTextBundles(vector<SHARED_PTR<RouteSegmentResult>>& route, SHARED_PTR<RouteDataResources>& resources) {
+	for (auto& s : route) {
+		s->collectTypes(resources);
+	}
+	for (auto& s : route) {
+		s->collectNames(resources);
+	}
+	size_t size = 0;
+	auto countBundle = [&size](RouteDataBundle& bundle) {
+		vector<string> keys;
+		for (const auto& it : bundle.data) keys.push_back(it.first);
+		for (const auto& it : bundle.vectors) keys.push_back(it.first);
+		for (const auto& it : bundle.intIntVectors) keys.push_back(it.first);
+		for (const auto& key : keys) {
+			size += key.size() + bundle.getString(key, "").size();
+		}
+	};
+	for (auto& s : route) {
+		auto bundle = std::make_shared<RouteDataBundle>(resources);
+		s->writeToBundle(bundle);
+		countBundle(*bundle);
+	}
+	for (const auto& rule : resources->insertOrder) {
+		auto bundle = std::make_shared<RouteDataBundle>(resources);
+		rule.writeToBundle(bundle);
+		countBundle(*bundle);
+	}
+	return size;
+}
+
+int main(int argc, char** argv) {
+	int segments = argc > 1 ? atoi(argv[1]) : 500;
+	std::mt19937 rnd(7);
+	vector<Location> locations;
+	vector<SHARED_PTR<RouteSegmentResult>> route = createRoute(segments, rnd, locations);
+	vector<int> routePointIndexes;
+
+	OsmAnd::ElapsedTimer timer;
+	timer.Start();
+	auto textResources = std::make_shared<RouteDataResources>(locations, routePointIndexes);
+	size_t textSize = writeTextBundles(route, textResources);
+	timer.Pause();
+	double textTime = timer.GetElapsedMicros() / 1000.0;
+
+	timer.Restart();
+	auto writeResources = std::make_shared<RouteDataResources>(locations, routePointIndexes);
+	vector<uint8_t> data;
+	RouteSegmentResult::writeRouteBinary(route, writeResources, data);
+	timer.Pause();
+	double binaryTime = timer.GetElapsedMicros() / 1000.0;
+	printf("%d segments: text bundles %d bytes %.2f ms, binary %d bytes %.2f ms\n", segments, (int)textSize,
+		   textTime, (int)data.size(), binaryTime);
+
+	// resources of writer are used to read, their string table stays the same
+	size_t strings = writeResources->strings.size();
+	auto readResources = std::make_shared<RouteDataResources>(locations, routePointIndexes);
+	vector<SHARED_PTR<RouteSegmentResult>> restored;
+	if (!RouteSegmentResult::readRouteBinary(data, readResources, restored) || restored.size() != route.size()) {
+		printf("Route is not read\n");
+		return 1;
+	}
+	vector<SHARED_PTR<RouteSegmentResult>> restoredAgain;
+	auto sharedResources = std::make_shared<RouteDataResources>(locations, routePointIndexes);
+	sharedResources->strings = writeResources->strings;
+	sharedResources->stringIndexes = writeResources->stringIndexes;
+	if (!RouteSegmentResult::readRouteBinary(data, sharedResources, restoredAgain) ||
+		sharedResources->strings.size() != strings) {
+		printf("String table of resources is changed by reading\n");
+		return 1;
+	}
+	for (int i = 0; i < segments; i++) {
+		if (!compareSegment(i, route[i], restored[i])) {
+			return 1;
+		}
+	}
+	// truncated data is rejected
+	for (size_t length = 0; length < data.size(); length += 1 + data.size() / 50) {
+		vector<uint8_t> part(data.begin(), data.begin() + length);
+		auto resources = std::make_shared<RouteDataResources>(locations, routePointIndexes);
+		vector<SHARED_PTR<RouteSegmentResult>> partRoute;
+		if (RouteSegmentResult::readRouteBinary(part, resources, partRoute)) {
+			printf("Truncated data (%d bytes) is read\n", (int)length);
+			return 1;
+		}
+	}
+	printf("Restored route is the same\n");
+	return 0;
+}
@@ -0,0 +1,183 @@
+// Compares export of route result to Java as one binary buffer (RouteResultBuffer, nativeRoutingBuffer)
+// with per-object export (convertRouteSegmentResultToJava, nativeRouting) on synthetic route. JVM is started
+// in process with OsmAnd java classes, so both exports run the same JNI calls as in application.
+// Lazy decoding of buffer in Java is not part of measured time.
+// Usage: routeResultBufferBenchmark <classpath of OsmAnd java classes> [segments] [iterations]
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "ElapsedTimer.h"
+#include "binaryRead.h"
+#include "routeResultBuffer.h"
+#include "routeSegmentResult.h"
+#include "turnType.h"
+
+// java_wrap.cpp
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved);
+extern jclass jclass_RouteSegmentResult;
+jobject convertRouteSegmentResultToJava(JNIEnv* ienv, SHARED_PTR<RouteSegmentResult> r,
+										UNORDERED(map)<int64_t, int>& indexes, jobjectArray regions);
+
+static SHARED_PTR<RouteDataObject> createObject(int64_t id, const SHARED_PTR<RoutingIndex>& region,
+												std::mt19937& rnd) {
+	SHARED_PTR<RouteDataObject> o = std::make_shared<RouteDataObject>();
+	o->id = id;
+	o->region = region;
+	for (int k = 0; k < 6; k++) {
+		o->types.push_back(rnd() % 200);
+	}
+	int points = 2 + rnd() % 20;
+	uint32_t x = 1100000000 + rnd() % 1000000;
+	uint32_t y = 700000000 + rnd() % 1000000;
+	for (int k = 0; k < points; k++) {
+		o->pointsX.push_back(x += rnd() % 200);
+		o->pointsY.push_back(y += rnd() % 200);
+	}
+	// Names of roads repeat along route
+	o->names[1] = "Street " + std::to_string(id / 8);
+	o->names[2] = "E" + std::to_string(id / 32);
+	if (rnd() % 4 == 0) {
+		RestrictionInfo r;
+		r.to = id + 1;
+		r.type = 1;
+		o->restrictions.push_back(r);
+	}
+	o->pointTypes.resize(points);
+	o->pointTypes[points / 2].push_back(rnd() % 200);
+	if (rnd() % 3 == 0) {
+		// Names of the last point could be missing (sizes of point names and name types differ)
+		o->pointNameTypes.resize(points);
+		o->pointNames.resize(rnd() % 2 ? points : points - 1);
+		o->pointNameTypes[0].push_back(3);
+		o->pointNames[0].push_back("Crossing " + std::to_string(id));
+	}
+	return o;
+}
+
+static SHARED_PTR<RouteSegmentResult> createSegment(int64_t id, const SHARED_PTR<RoutingIndex>& region,
+													std::mt19937& rnd) {
+	SHARED_PTR<RouteDataObject> o = createObject(id, region, rnd);
+	int end = (int)o->pointsX.size() - 1;
+	SHARED_PTR<RouteSegmentResult> s = std::make_shared<RouteSegmentResult>(o, 0, end);
+	s->segmentTime = 1 + rnd() % 60;
+	s->routingTime = s->segmentTime;
+	s->segmentSpeed = 10 + rnd() % 20;
+	s->distance = s->segmentTime * s->segmentSpeed;
+	return s;
+}
+
+// Every 5th segment has turn with lanes, every 2nd has attached roads at some points
+static vector<SHARED_PTR<RouteSegmentResult>> createRoute(int segments, std::mt19937& rnd) {
+	SHARED_PTR<RoutingIndex> region = std::make_shared<RoutingIndex>();
+	region->filePointer = 0;
+	region->length = 0;
+	vector<SHARED_PTR<RouteSegmentResult>> route;
+	int64_t id = 1;
+	for (int i = 0; i < segments; i++) {
+		SHARED_PTR<RouteSegmentResult> s = createSegment(id++, region, rnd);
+		if (i % 5 == 0) {
+			int turn = TurnType::TR;
+			vector<int> lanes = {TurnType::C << 1, (TurnType::TR << 1) | 1};
+			s->turnType = std::make_shared<TurnType>(turn, 0, 90, false, lanes, false, false);
+		}
+		if (i % 2 == 0) {
+			s->attachedRoutes.resize(s->object->pointsX.size());
+			for (auto& attached : s->attachedRoutes) {
+				if (rnd() % 3 == 0) {
+					attached.push_back(createSegment(id++, region, rnd));
+				}
+			}
+		}
+		route.push_back(s);
+	}
+	return route;
+}
+
+static bool checkException(JNIEnv* env, const char* step) {
+	if (env->ExceptionCheck()) {
+		printf("Java exception: %s\n", step);
+		env->ExceptionDescribe();
+		env->ExceptionClear();
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: routeResultBufferBenchmark <classpath> [segments] [iterations]\n");
+		return 1;
+	}
+	int segments = argc > 2 ? atoi(argv[2]) : 2000;
+	int iterations = argc > 3 ? atoi(argv[3]) : 10;
+
+	std::string classPath = std::string("-Djava.class.path=") + argv[1];
+	JavaVMOption options[1];
+	options[0].optionString = (char*)classPath.c_str();
+	JavaVMInitArgs vmArgs;
+	vmArgs.version = JNI_VERSION_1_6;
+	vmArgs.nOptions = 1;
+	vmArgs.options = options;
+	vmArgs.ignoreUnrecognized = JNI_FALSE;
+	JavaVM* vm = NULL;
+	JNIEnv* env = NULL;
+	if (JNI_CreateJavaVM(&vm, (void**)&env, &vmArgs) != JNI_OK) {
+		printf("JVM is not started\n");
+		return 1;
+	}
+	if (JNI_OnLoad(vm, NULL) == JNI_ERR || !checkException(env, "classes are not loaded")) {
+		vm->DestroyJavaVM();
+		return 1;
+	}
+
+	std::mt19937 rnd(7);
+	vector<SHARED_PTR<RouteSegmentResult>> route = createRoute(segments, rnd);
+	// Regions are not passed (Java objects get null region as for unknown files)
+	UNORDERED(map)<int64_t, int> indexes;
+	jobjectArray regions = env->NewObjectArray(0, env->FindClass("java/lang/Object"), NULL);
+	printf("%d segments\n", segments);
+
+	bool ok = true;
+	double objectsTime = 0;
+	double bufferTime = 0;
+	size_t bufferSize = 0;
+	for (int it = 0; it < iterations && ok; it++) {
+		OsmAnd::ElapsedTimer timer;
+		env->PushLocalFrame(16);
+		timer.Start();
+		jobjectArray res = env->NewObjectArray(route.size(), jclass_RouteSegmentResult, NULL);
+		for (uint i = 0; i < route.size(); i++) {
+			jobject resobj = convertRouteSegmentResultToJava(env, route[i], indexes, regions);
+			env->SetObjectArrayElement(res, i, resobj);
+			env->DeleteLocalRef(resobj);
+		}
+		timer.Pause();
+		ok = checkException(env, "per-object export");
+		env->PopLocalFrame(NULL);
+		objectsTime += timer.GetElapsedMicros() / 1000.0;
+
+		env->PushLocalFrame(16);
+		timer.Restart();
+		RouteResultBuffer buffer;
+		buffer.write(route, indexes);
+		jobject byteBuffer = env->NewDirectByteBuffer(&buffer.data[0], buffer.data.size());
+		timer.Pause();
+		ok = ok && byteBuffer != NULL && checkException(env, "buffer export");
+		env->PopLocalFrame(NULL);
+		bufferTime += timer.GetElapsedMicros() / 1000.0;
+		bufferSize = buffer.data.size();
+	}
+	if (ok) {
+		printf("Per-object export %.2f ms, buffer export %.2f ms (x%.1f), buffer %d bytes\n",
+			   objectsTime / iterations, bufferTime / iterations, objectsTime / std::max(bufferTime, 0.001),
+			   (int)bufferSize);
+	}
+	vm->DestroyJavaVM();
+	return ok ? 0 : 1;
+}
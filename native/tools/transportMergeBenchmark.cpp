@@ -0,0 +1,193 @@
+// Compares merge of transport route segments (TransportRouteStopsReader::mergeSegments, segments are found
+// by stop id / missing stop cell index) with previous implementation (every queued segment is compared
+// with first segment) on synthetic route split into shuffled overlapping parts.
+// Usage: transportMergeBenchmark [stops] [iterations]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+
+#include "ElapsedTimer.h"
+#include "transportRouteStopsReader.h"
+#include "transportRoutingObjects.h"
+
+// Previous implementation of TransportRouteStopsReader::tryToMerge
+static bool legacyTryToMerge(PT_STOPS_SEGMENT& firstSegment, PT_STOPS_SEGMENT& segmentToMerge) {
+	if (firstSegment.size() < 2 || segmentToMerge.size() < 2) {
+		return false;
+	}
+	int commonStopFirst = 0;
+	int commonStopSecond = 0;
+	bool found = false;
+	for (; commonStopFirst < firstSegment.size(); commonStopFirst++) {
+		for (commonStopSecond = 0; commonStopSecond < segmentToMerge.size() && !found; commonStopSecond++) {
+			auto lid1 = firstSegment[commonStopFirst]->id;
+			auto lid2 = segmentToMerge[commonStopSecond]->id;
+			if (lid1 > 0 && lid2 == lid1) {
+				found = true;
+				break;
+			}
+		}
+		if (found) {
+			break;
+		}
+	}
+	if (found && commonStopFirst < firstSegment.size()) {
+		int leftPartFirst = firstSegment.size() - commonStopFirst;
+		int leftPartSecond = segmentToMerge.size() - commonStopSecond;
+		if (leftPartFirst < leftPartSecond ||
+			(leftPartFirst == leftPartSecond && firstSegment[firstSegment.size() - 1]->isMissingStop())) {
+			while (firstSegment.size() > commonStopFirst) {
+				firstSegment.erase(firstSegment.end() - 1);
+			}
+			for (int i = commonStopSecond; i < segmentToMerge.size(); i++) {
+				firstSegment.push_back(segmentToMerge[i]);
+			}
+		}
+		if (commonStopFirst < commonStopSecond ||
+			(commonStopFirst == commonStopSecond && firstSegment[0]->isMissingStop())) {
+			for (int i = 0; i <= commonStopFirst; i++) {
+				firstSegment.erase(firstSegment.begin());
+			}
+			for (int i = commonStopSecond; i >= 0; i--) {
+				firstSegment.insert(firstSegment.begin(), segmentToMerge[i]);
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+// Previous implementation of TransportRouteStopsReader::mergeSegments (tryToMergeMissingStops isn't changed)
+static vector<PT_STOPS_SEGMENT> legacyMergeSegments(TransportRouteStopsReader& reader, vector<PT_STOPS_SEGMENT>& segments,
+													bool mergeMissingSegs) {
+	vector<PT_STOPS_SEGMENT> resultSegments;
+	std::deque<PT_STOPS_SEGMENT> segQueue(segments.begin(), segments.end());
+	while (!segQueue.empty()) {
+		auto firstSegment = segQueue.front();
+		segQueue.pop_front();
+		bool merged = true;
+		while (merged) {
+			merged = false;
+			auto it = segQueue.begin();
+			while (it != segQueue.end()) {
+				auto segmentToMerge = *it;
+				if (mergeMissingSegs) {
+					merged = reader.tryToMergeMissingStops(firstSegment, segmentToMerge);
+				} else {
+					merged = legacyTryToMerge(firstSegment, segmentToMerge);
+				}
+				if (merged) {
+					it = segQueue.erase(it);
+					break;
+				} else {
+					it++;
+				}
+			}
+		}
+		resultSegments.push_back(firstSegment);
+	}
+	return resultSegments;
+}
+
+static SHARED_PTR<TransportStop> createStop(int64_t id, double lat, double lon, bool missing) {
+	SHARED_PTR<TransportStop> s = std::make_shared<TransportStop>();
+	s->id = id;
+	s->lat = lat;
+	s->lon = lon;
+	s->name = missing ? MISSING_STOP_NAME : "Stop " + std::to_string(id);
+	return s;
+}
+
+// Route of stops along meridian split into parts: parts of commonStops share one stop with next part,
+// parts of missingStops end / start with missing stops (10 m apart)
+static void createSegments(int stops, std::mt19937& rnd, vector<PT_STOPS_SEGMENT>& commonStops,
+						   vector<PT_STOPS_SEGMENT>& missingStops) {
+	std::uniform_int_distribution<int> partLength(5, 30);
+	int i = 0;
+	while (i < stops - 1) {
+		int end = std::min(stops - 1, i + partLength(rnd));
+		PT_STOPS_SEGMENT common;
+		PT_STOPS_SEGMENT missing;
+		for (int k = i; k <= end; k++) {
+			double lat = 50 + k * 0.0005;
+			common.push_back(createStop(k + 1, lat, 10, false));
+			if (k == i && i > 0) {
+				missing.push_back(createStop(-(2 * k + 1), lat + 0.0001, 10, true));
+			} else if (k == end && end < stops - 1) {
+				missing.push_back(createStop(-(2 * k + 2), lat, 10, true));
+			} else {
+				missing.push_back(createStop(k + 1, lat, 10, false));
+			}
+		}
+		commonStops.push_back(common);
+		missingStops.push_back(missing);
+		i = end;
+	}
+	std::shuffle(commonStops.begin(), commonStops.end(), rnd);
+	std::shuffle(missingStops.begin(), missingStops.end(), rnd);
+}
+
+static bool sameSegments(const vector<PT_STOPS_SEGMENT>& s1, const vector<PT_STOPS_SEGMENT>& s2) {
+	if (s1.size() != s2.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < s1.size(); i++) {
+		if (s1[i].size() != s2[i].size()) {
+			return false;
+		}
+		for (size_t j = 0; j < s1[i].size(); j++) {
+			if (s1[i][j] != s2[i][j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	int stops = argc > 1 ? atoi(argv[1]) : 5000;
+	int iterations = argc > 2 ? atoi(argv[2]) : 3;
+	std::mt19937 rnd(7);
+	vector<PT_STOPS_SEGMENT> commonStops;
+	vector<PT_STOPS_SEGMENT> missingStops;
+	createSegments(stops, rnd, commonStops, missingStops);
+	vector<BinaryMapFile*> files;
+	TransportRouteStopsReader reader(files);
+	printf("%d stops, %d segments\n", stops, (int)commonStops.size());
+
+	bool same = true;
+	for (int missing = 0; missing < 2; missing++) {
+		vector<PT_STOPS_SEGMENT>& segments = missing ? missingStops : commonStops;
+		double legacyTime = 0;
+		double indexedTime = 0;
+		for (int it = 0; it < iterations; it++) {
+			OsmAnd::ElapsedTimer timer;
+			timer.Start();
+			vector<PT_STOPS_SEGMENT> legacy = legacyMergeSegments(reader, segments, missing);
+			legacyTime += timer.GetElapsedMs();
+			timer.Restart();
+			vector<PT_STOPS_SEGMENT> result;
+			reader.mergeSegments(segments, result, missing);
+			indexedTime += timer.GetElapsedMs();
+			if (!sameSegments(legacy, result)) {
+				printf("%s: previous %d segments, indexed %d\n", missing ? "Missing stops" : "Common stops",
+					   (int)legacy.size(), (int)result.size());
+				same = false;
+			}
+			if (it == 0) {
+				printf("%s: %d segments merged into %d\n", missing ? "Missing stops" : "Common stops",
+					   (int)segments.size(), (int)result.size());
+			}
+		}
+		printf("%s: previous %.2f ms, indexed %.2f ms (x%.1f)\n", missing ? "Missing stops" : "Common stops",
+			   legacyTime / iterations, indexedTime / iterations, legacyTime / std::max(indexedTime, 0.001));
+	}
+	if (!same) {
+		printf("Merged segments are different\n");
+		return 1;
+	}
+	return 0;
+}
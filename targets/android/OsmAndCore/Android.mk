@@ -44,6 +44,7 @@ LOCAL_SRC_FILES := \
 	$(OSMAND_CORE_RELATIVE)/src/common.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/commonRendering.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/multipolygons.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/nativeRoutingTile.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/renderRules.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/rendering.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/openingHoursParser.cpp \
@@ -61,22 +62,35 @@ LOCAL_SRC_FILES := \
 	$(OSMAND_CORE_RELATIVE)/src/transportRoutingConfiguration.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/transportRoutingContext.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/transportRoutePlanner.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/transportRaptorPlanner.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/transportNetworkCache.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/transportRouteStopsReader.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routeDataBundle.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routeDataResources.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routePlannerFrontEnd.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routeResultBuffer.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routeResultPreparation.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routeSegmentResult.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/turnType.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/proto/osmand_index.pb.cc \
 	$(OSMAND_CORE_RELATIVE)/src/java_wrap.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/routeCalculationProgress.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routeTilePrefetcher.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routeLandmarks.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routingContextPool.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/elevationProvider.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routeTileCache.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/routeSegmentGrid.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/hhNetworkCostCache.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/hhRouteDataStructure.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/hhRoutePlanner.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/hhSegmentsLoader.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/NetworkDBPointRouteInfo.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/gpxRouteApproximation.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/gpxMultiSegmentsApproximation.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/gpxSimplePointsMatchApproximation.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/gpxChunkedApproximation.cpp \
+	$(OSMAND_CORE_RELATIVE)/src/gpxStreamingApproximation.cpp \
 	$(OSMAND_CORE_RELATIVE)/src/roundaboutTurn.cpp
 
 ifdef OSMAND_PROFILE_NATIVE_OPERATIONS